@@ -7,6 +7,9 @@ uniform mat4 texm;
 uniform bool enable_lighting;
 uniform float lighting[256];
 
+uniform bool enable_constant_color;
+uniform vec4 constant_color;
+
 attribute vec3 a_pos;
 attribute vec4 a_color;
 attribute vec2 a_texcoord;
@@ -17,7 +20,9 @@ varying vec4 v_color;
 varying vec2 v_texcoord;
 
 void main() {
-	if(enable_lighting) {
+	if(enable_constant_color) {
+		v_color = constant_color;
+	} else if(enable_lighting) {
 		v_color = vec4(vec3(lighting[int(a_light.x) + int(a_light.y) * 16]), 1.0);
 	} else {
 		v_color = a_color;
@@ -130,6 +130,40 @@ bool aabb_intersection(struct AABB* a, struct AABB* b) {
 		&& (a->z1 <= b->z2 && b->z1 <= a->z2);
 }
 
+static void aabb_sweep_axis(float a1, float a2, float b1, float b2, float d,
+							float* enter, float* exit) {
+	if(d == 0.0F) {
+		// not moving on this axis, only a static overlap can hit
+		bool overlap = a1 <= b2 && b1 <= a2;
+		*enter = overlap ? -INFINITY : INFINITY;
+		*exit = overlap ? INFINITY : -INFINITY;
+	} else {
+		float t1 = (b1 - a2) / d;
+		float t2 = (b2 - a1) / d;
+		*enter = fminf(t1, t2);
+		*exit = fmaxf(t1, t2);
+	}
+}
+
+bool aabb_intersection_sweep(struct AABB* a, struct AABB* b, float dx,
+							 float dy, float dz, float* t) {
+	assert(a && b && t);
+
+	float enter_x, exit_x, enter_y, exit_y, enter_z, exit_z;
+	aabb_sweep_axis(a->x1, a->x2, b->x1, b->x2, dx, &enter_x, &exit_x);
+	aabb_sweep_axis(a->y1, a->y2, b->y1, b->y2, dy, &enter_y, &exit_y);
+	aabb_sweep_axis(a->z1, a->z2, b->z1, b->z2, dz, &enter_z, &exit_z);
+
+	float enter = fmaxf(fmaxf(enter_x, enter_y), enter_z);
+	float exit = fminf(fminf(exit_x, exit_y), exit_z);
+
+	if(enter > exit || enter > 1.0F || exit < 0.0F)
+		return false;
+
+	*t = fmaxf(enter, 0.0F);
+	return true;
+}
+
 bool aabb_intersection_point(struct AABB* a, float x, float y, float z) {
 	return (x >= a->x1 && x <= a->x2) && (y >= a->y1 && y <= a->y2)
 		&& (z >= a->z1 && z <= a->z2);
@@ -39,6 +39,9 @@ void aabb_setsize_centered(struct AABB* a, float sx, float sy, float sz);
 void aabb_translate(struct AABB* a, float x, float y, float z);
 bool aabb_intersection_ray(struct AABB* a, struct ray* r, enum side* s);
 bool aabb_intersection(struct AABB* a, struct AABB* b);
+// time of impact in [0, 1] of a moving by (dx, dy, dz) against static b
+bool aabb_intersection_sweep(struct AABB* a, struct AABB* b, float dx,
+							 float dy, float dz, float* t);
 bool aabb_intersection_point(struct AABB* a, float x, float y, float z);
 void aabb_setsize_centered_offset(struct AABB* a,
                                   float sx, float sy, float sz,
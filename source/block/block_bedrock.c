@@ -54,6 +54,7 @@ struct block block_bedrock = {
 	.onRandomTick = NULL,
 	.onRightClick = NULL,
 	.transparent = false,
+	.full_cube = true,
 	.renderBlock = render_block_full,
 	.renderBlockAlways = NULL,
 	.luminance = 0,
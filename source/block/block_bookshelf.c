@@ -58,6 +58,7 @@ struct block block_bookshelf = {
 	.onRandomTick = NULL,
 	.onRightClick = NULL,
 	.transparent = false,
+	.full_cube = true,
 	.renderBlock = render_block_full,
 	.renderBlockAlways = NULL,
 	.luminance = 0,
@@ -49,6 +49,7 @@ struct block block_bricks = {
 	.onRandomTick = NULL,
 	.onRightClick = NULL,
 	.transparent = false,
+	.full_cube = true,
 	.renderBlock = render_block_full,
 	.renderBlockAlways = NULL,
 	.luminance = 0,
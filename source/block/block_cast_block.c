@@ -61,6 +61,7 @@ struct block block_iron = {
 	.onRandomTick = NULL,
 	.onRightClick = NULL,
 	.transparent = false,
+	.full_cube = true,
 	.renderBlock = render_block_full,
 	.renderBlockAlways = NULL,
 	.luminance = 0,
@@ -95,6 +96,7 @@ struct block block_gold = {
 	.onRandomTick = NULL,
 	.onRightClick = NULL,
 	.transparent = false,
+	.full_cube = true,
 	.renderBlock = render_block_full,
 	.renderBlockAlways = NULL,
 	.luminance = 0,
@@ -129,6 +131,7 @@ struct block block_diamond = {
 	.onRandomTick = NULL,
 	.onRightClick = NULL,
 	.transparent = false,
+	.full_cube = true,
 	.renderBlock = render_block_full,
 	.renderBlockAlways = NULL,
 	.luminance = 0,
@@ -163,6 +166,7 @@ struct block block_lapis = {
 	.onRandomTick = NULL,
 	.onRightClick = NULL,
 	.transparent = false,
+	.full_cube = true,
 	.renderBlock = render_block_full,
 	.renderBlockAlways = NULL,
 	.luminance = 0,
@@ -92,19 +92,12 @@ static bool onItemPlace(struct server_local* s, struct item_data* it,
 		   (vec3) {s->player.x, s->player.y, s->player.z}, &blk_info))
 		return false;
 
-	for (int i=0; i<MAX_CHESTS; i++) {
-		if (s->chest_pos[i].y < 0) {
-			s->chest_pos[i].x = where->x;
-			s->chest_pos[i].y = where->y;
-			s->chest_pos[i].z = where->z;
-			memset(&s->chest_items[i], 0, 27*sizeof(struct item_data));
-			server_world_set_block(s, where->x, where->y, where->z, blk);
-			return true;
-		}
-	}
+	if(!server_world_add_tile_entity(&s->world, TILE_ENTITY_CHEST, where->x,
+									 where->y, where->z))
+		return false;
 
-	puts("Too many chests");
-	return false;
+	server_world_set_block(s, where->x, where->y, where->z, blk);
+	return true;
 }
 
 static size_t getDroppedItem(struct block_info* this, struct item_data* it,
@@ -114,19 +107,21 @@ static size_t getDroppedItem(struct block_info* this, struct item_data* it,
 		it->durability = this->block->metadata;
 		it->count = 1;
 	} else { //only free chest on first run of getDroppedItem
-		for(int i=0; i<MAX_CHESTS; i++) {
-			if(s->chest_pos[i].x == this->x && s->chest_pos[i].y == this->y && s->chest_pos[i].z == this->z) {
-				for(int j=0; j<MAX_CHEST_SLOTS; j++) {
-					if(s->chest_items[i][j].id) {
-						server_local_spawn_item((vec3) {this->x + 0.5F,
-									this->y + 0.5F,
-									this->z + 0.5F},
-									&s->chest_items[i][j], false, s);
-					}
+		struct tile_entity* te = server_world_tile_entity(
+			&s->world, this->x, this->y, this->z, false);
+
+		if(te) {
+			for(int j = 0; j < MAX_CHEST_SLOTS; j++) {
+				if(te->payload.items[j].id) {
+					server_local_spawn_item((vec3) {this->x + 0.5F,
+													this->y + 0.5F,
+													this->z + 0.5F},
+											&te->payload.items[j], false, s);
 				}
-				s->chest_pos[i].y = -1;
-				break;
 			}
+
+			server_world_remove_tile_entity(&s->world, this->x, this->y,
+											this->z);
 		}
 	}
 
@@ -143,6 +138,7 @@ struct block block_chest = {
 	.onRandomTick = NULL,
 	.onRightClick = onRightClick,
 	.transparent = false,
+	.full_cube = true,
 	.renderBlock = render_block_full,
 	.renderBlockAlways = NULL,
 	.luminance = 0,
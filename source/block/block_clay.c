@@ -60,6 +60,7 @@ struct block block_clay = {
 	.onRandomTick = NULL,
 	.onRightClick = NULL,
 	.transparent = false,
+	.full_cube = true,
 	.renderBlock = render_block_full,
 	.renderBlockAlways = NULL,
 	.luminance = 0,
@@ -72,6 +72,7 @@ struct block block_dirt = {
 	.onRandomTick = NULL,
 	.onRightClick = onRightClick,
 	.transparent = false,
+	.full_cube = true,
 	.renderBlock = render_block_full,
 	.renderBlockAlways = NULL,
 	.luminance = 0,
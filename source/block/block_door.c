@@ -23,6 +23,7 @@
 //todo; fix rendering of the door in various metadata positions
 
 
+#include "../network/redstone.h"
 #include "../network/server_local.h"
 #include "blocks.h"
 
@@ -179,31 +180,7 @@ static void onNeighbourBlockChange(struct server_local* s,
     if (cur.metadata & 0x08) return;
 
     // bepaal of we nu power hebben
-    const int dx[6] = {  1, -1,  0,  0,  0,  0 };
-    const int dy[6] = {  0,  0,  0,  0,  1, -1 };
-    const int dz[6] = {  0,  0,  1, -1,  0,  0 };
-    bool powered = false;
-
-    for (int i = 0; i < 6; i++) {
-        w_coord_t nx = info->x + dx[i];
-        w_coord_t ny = info->y + dy[i];
-        w_coord_t nz = info->z + dz[i];
-
-        struct block_data nb;
-        if (!server_world_get_block(&s->world, nx, ny, nz, &nb))
-            continue;
-
-        uint8_t m = nb.metadata & 0x0F;
-        if ((nb.type == BLOCK_REDSTONE_WIRE && m > 0) ||
-            nb.type == BLOCK_REDSTONE_TORCH_LIT            ||
-           ((nb.type == BLOCK_STONE_PRESSURE_PLATE         ||
-             nb.type == BLOCK_WOOD_PRESSURE_PLATE)         &&
-            (m & 0x01)))
-        {
-            powered = true;
-            break;
-        }
-    }
+    bool powered = redstone_is_powered(&s->world, info->x, info->y, info->z);
 
     // extraheren van de hand-bit (bit 0)
     uint8_t handBit = cur.metadata & 0x01;
@@ -18,8 +18,10 @@
 */
 
 #include "blocks.h"
+#include "../game/game_state.h"
 #include "../network/server_local.h"
 #include "../network/server_world.h"
+#include "../particle.h"
 
 
 static enum block_material getMaterial(struct block_info* this) {
@@ -92,6 +94,13 @@ static void onRandomTick(struct server_local* s, struct block_info* blk) {
 }
 
 
+static void onDisplayTick(struct block_info* this) {
+	if(rand_gen_flt(&gstate.rand_src) < 0.25F) {
+		vec3 center = {this->x + 0.5F, this->y, this->z + 0.5F};
+		particle_generate_smoke(center, 0.5F);
+	}
+}
+
 struct block block_fire = {
 	.name = "Fire",
 	.getSideMask = getSideMask,
@@ -101,6 +110,7 @@ struct block block_fire = {
 	.getDroppedItem = getDroppedItem,
 	.onRandomTick = onRandomTick,
 	.onRightClick = NULL,
+	.onDisplayTick = onDisplayTick,
 	.transparent = true,
 	.renderBlock = render_block_fire,
 	.renderBlockAlways = NULL,
@@ -131,6 +131,7 @@ struct block block_furnaceoff = {
 	.onRandomTick = NULL,
 	.onRightClick = onRightClick,
 	.transparent = false,
+	.full_cube = true,
 	.renderBlock = render_block_furnace,
 	.renderBlockAlways = NULL,
 	.luminance = 0, //depends on metadata
@@ -167,6 +168,7 @@ struct block block_furnaceon = {
 	.onRandomTick = NULL,
 	.onRightClick = onRightClick,
 	.transparent = false,
+	.full_cube = true,
 	.renderBlock = render_block_full,
 	.renderBlockAlways = NULL,
 	.luminance = 13,
@@ -134,6 +134,7 @@ struct block block_grass = {
 	.onRandomTick = onRandomTick,
 	.onRightClick = onRightClick,
 	.transparent = false,
+	.full_cube = true,
 	.renderBlock = render_block_full,
 	.renderBlockAlways = NULL,
 	.luminance = 0,
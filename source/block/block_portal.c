@@ -18,6 +18,8 @@
 */
 
 #include "blocks.h"
+#include "../game/game_state.h"
+#include "../particle.h"
 
 static enum block_material getMaterial(struct block_info* this) {
 	return MATERIAL_STONE;
@@ -42,6 +44,13 @@ static size_t getDroppedItem(struct block_info* this, struct item_data* it,
 	return 0;
 }
 
+static void onDisplayTick(struct block_info* this) {
+	if(rand_gen_flt(&gstate.rand_src) < 0.25F) {
+		vec3 center = {this->x + 0.5F, this->y + 0.5F, this->z + 0.5F};
+		particle_generate_portal(center);
+	}
+}
+
 struct block block_portal = {
 	.name = "Portal",
 	.getSideMask = getSideMask,
@@ -51,6 +60,7 @@ struct block block_portal = {
 	.getDroppedItem = getDroppedItem,
 	.onRandomTick = NULL,
 	.onRightClick = NULL,
+	.onDisplayTick = onDisplayTick,
 	.transparent = true,
 	.renderBlock = render_block_portal,
 	.renderBlockAlways = NULL,
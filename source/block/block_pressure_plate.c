@@ -17,6 +17,9 @@
 	along with CavEX.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <assert.h>
+#include <math.h>
+
 #include "../network/server_local.h"
 #include "blocks.h"
 
@@ -29,6 +32,7 @@ static enum block_material getMaterial2(struct block_info* this) {
 }
 
 #define EYE_HEIGHT 1.62F
+#define PLATE_RELEASE_TICKS 20
 
 static size_t getBoundingBox(struct block_info* this, bool entity,
 							 struct AABB* x) {
@@ -70,29 +74,64 @@ static bool onItemPlace(struct server_local* s, struct item_data* it,
 }
 
 
-static void onWorldTick(struct server_local* s, struct block_info* info) {
-    if (!info->neighbours) return;
-	struct block_data cur = *info->block;
-    float px       = s->player.x;
-    float pz       = s->player.z;
-    float footY    = s->player.y - EYE_HEIGHT;
+static bool player_on_plate(struct server_local* s, w_coord_t x, w_coord_t y,
+							w_coord_t z) {
+	float px = s->player.x;
+	float pz = s->player.z;
+	float foot_y = s->player.y - EYE_HEIGHT;
+
+	return px >= x && px < x + 1.0F && pz >= z && pz < z + 1.0F
+		&& foot_y >= y && foot_y <= y + 0.1F;
+}
 
-    bool insideXZ = (px >= info->x && px < info->x + 1.0f)
-                 && (pz >= info->z && pz < info->z + 1.0f);
+static void set_pressed(struct server_local* s, struct block_info* info,
+						bool pressed) {
+	struct block_data cur = *info->block;
+	cur.metadata = (cur.metadata & ~0x01) | (pressed ? 0x01 : 0x00);
+	// also notifies the neighbours and the redstone attached to the plate
+	server_world_set_block(s, info->x, info->y, info->z, cur);
+}
 
+// checked again while pressed, released once nobody stands on it
+static void onWorldTick(struct server_local* s, struct block_info* info) {
+	if(!(info->block->metadata & 0x01))
+		return;
+
+	if(player_on_plate(s, info->x, info->y, info->z)) {
+		block_tick_schedule(&s->world, info->x, info->y, info->z,
+							PLATE_RELEASE_TICKS);
+	} else {
+		set_pressed(s, info, false);
+	}
+}
 
-    bool onPlate  = insideXZ
-                 && (footY >= info->y && footY <= info->y + 0.1f);
+// the only input that has to poll, looks at the single block at the feet
+void pressure_plate_step(struct server_local* s) {
+	assert(s);
 
-    uint8_t newState = onPlate ? 1 : 0;
+	w_coord_t x = floorf(s->player.x);
+	w_coord_t y = floorf(s->player.y - EYE_HEIGHT);
+	w_coord_t z = floorf(s->player.z);
 
-    if ((cur.metadata & 0x01) != newState) {
-        cur.metadata = (cur.metadata & ~0x01) | newState;
-        server_world_set_block(s,
-                               info->x, info->y, info->z,
-                               cur);
-        notifyNeighbours(s, info->x, info->y, info->z);
-    }
+	struct block_data blk;
+	if(!server_world_get_block(&s->world, x, y, z, &blk)
+	   || (blk.type != BLOCK_STONE_PRESSURE_PLATE
+		   && blk.type != BLOCK_WOOD_PRESSURE_PLATE)
+	   || !player_on_plate(s, x, y, z))
+		return;
+
+	if(!(blk.metadata & 0x01))
+		set_pressed(s,
+					&(struct block_info) {
+						.block = &blk,
+						.neighbours = NULL,
+						.x = x,
+						.y = y,
+						.z = z,
+					},
+					true);
+
+	block_tick_schedule(&s->world, x, y, z, PLATE_RELEASE_TICKS);
 }
 
 struct block block_stone_pressure_plate = {
@@ -51,65 +51,9 @@ static uint8_t getTextureIndex(struct block_info* this, enum side side) {
 	return tex_atlas_lookup(TEXAT_REDSTONE_WIRE_L1 + (lvl - 1));
 }
 
-static void onWorldTick(struct server_local* s, struct block_info* blk) {
-    if (!blk->neighbours) return;
-    struct block_data cur = *blk->block;
-    if (cur.type != BLOCK_REDSTONE_WIRE) return;
-
-    uint8_t strong = 0;
-    for (int side = 0; side < SIDE_MAX; ++side) {
-        if (!blk->neighbours) continue;
-        uint8_t ntype = blk->neighbours[side].type;
-        uint8_t nmeta = blk->neighbours[side].metadata & 0x0F;
-
-        // redstone torch always powers at level 15
-        if (ntype == BLOCK_REDSTONE_TORCH ||
-            ntype == BLOCK_REDSTONE_TORCH_LIT ){
-            strong = 15;
-            break;
-        }
-        // stone or wooden pressure plate, pressed when metadata == 1
-        if ((ntype == BLOCK_STONE_PRESSURE_PLATE ||
-             ntype == BLOCK_WOOD_PRESSURE_PLATE) &&
-             nmeta == 1) {
-            strong = 15;
-            break;
-        }
-    }
-
-    const enum side horiz[4] = {
-            SIDE_RIGHT,  // +X
-            SIDE_LEFT,   // -X
-            SIDE_FRONT,  // +Z
-            SIDE_BACK    // -Z
-    };
-    uint8_t maxWire = 0;
-    for (int i = 0; i < 4; ++i) {
-        if (blk->neighbours
-            && blk->neighbours[horiz[i]].type == 55)
-        {
-            uint8_t p = blk->neighbours[horiz[i]].metadata & 0x0F;
-            if (p > maxWire) maxWire = p;
-        }
-    }
-
-    uint8_t desired = strong
-                     ? 15
-                     : (maxWire ? maxWire - 1 : 0);
-
+static void onDisplayTick(struct block_info* blk) {
     vec3 c = { blk->x + 0.5f, blk->y, blk->z + 0.5f };
-    particle_generate_redstone_wire(c, desired);
-
-    if ((cur.metadata & 0x0F) != desired) {
-        server_world_set_block(s,
-                               blk->x, blk->y, blk->z,
-                               (struct block_data){
-                                   .type     = BLOCK_REDSTONE_WIRE,
-                                   .metadata = desired
-                               });
-        notifyNeighbours(s, blk->x, blk->y, blk->z);
-
-    }
+    particle_generate_redstone_wire(c, blk->block->metadata & 0x0F);
 }
 
 static size_t getDroppedItem(struct block_info* this,
@@ -134,7 +78,8 @@ struct block block_redstone_wire = {
 	.getDroppedItem = getDroppedItem,
 	.onRandomTick = NULL,
 	.onRightClick = NULL,
-	.onWorldTick = onWorldTick,
+	.onWorldTick = NULL,
+	.onDisplayTick = onDisplayTick,
 	.transparent = false,
 	.renderBlock = render_block_redstone_wire,
 	.renderBlockAlways = NULL,
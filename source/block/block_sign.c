@@ -106,19 +106,12 @@ static bool onItemPlace(struct server_local* s, struct item_data* it,
 		   (vec3) {s->player.x, s->player.y, s->player.z}, &blk_info))
 		return false;
 
-	for (int i=0; i<MAX_CHESTS; i++) {
-		if (s->sign_pos[i].y < 0) {
-			s->sign_pos[i].x = where->x;
-			s->sign_pos[i].y = where->y;
-			s->sign_pos[i].z = where->z;
-			memset(&s->sign_texts[i], ' ', SIGN_SIZE * sizeof(char));
-			server_world_set_block(s, where->x, where->y, where->z, blk);
-			return true;
-		}
-	}
+	if(!server_world_add_tile_entity(&s->world, TILE_ENTITY_SIGN, where->x,
+									 where->y, where->z))
+		return false;
 
-	puts("Too many signs");
-	return false;
+	server_world_set_block(s, where->x, where->y, where->z, blk);
+	return true;
 }
 
 static void onRightClick(struct server_local* s, struct item_data* it,
@@ -146,12 +139,7 @@ static size_t getDroppedItem(struct block_info* this, struct item_data* it,
 		it->durability = 0;
 		it->count = 1;
 	} else { //only free sign on first run of getDroppedItem
-		for(int i=0; i<MAX_SIGNS; i++) {
-			if(s->sign_pos[i].x == this->x && s->sign_pos[i].y == this->y && s->sign_pos[i].z == this->z) {
-				s->sign_pos[i].y = -1;
-				break;
-			}
-		}
+		server_world_remove_tile_entity(&s->world, this->x, this->y, this->z);
 	}
 
 	return 1;
@@ -22,6 +22,8 @@
 #include "../graphics/render_item.h"
 #include "../graphics/texture_atlas.h"
 #include "../item/tool.h"
+#include "../network/block_tick.h"
+#include "../network/redstone.h"
 #include "../network/server_local.h"
 #include "../network/server_world.h"
 #include "../particle.h"
@@ -90,35 +92,37 @@ void tnt_explode(struct server_local* s,
 
 }
 
+static void onDisplayTick(struct block_info* info) {
+    // lit fuse
+    if (info->block->metadata > 0) {
+        vec3 center = { info->x + 0.5f, info->y + 0.5f, info->z + 0.5f };
+        particle_generate_smoke(center, 1.0f);
+    }
+}
+
+// the fuse burns down by one every tick and the TNT explodes at the end
+static void tnt_ignite(struct server_local* s, w_coord_t x, w_coord_t y,
+                       w_coord_t z) {
+    server_world_set_block(s, x, y, z,
+        (struct block_data){ .type = BLOCK_TNT, .metadata = TNT_FUSE_TICKS });
+    block_tick_schedule(&s->world, x, y, z, 1);
+}
+
+static void onNeighbourBlockChange(struct server_local* s,
+                                   struct block_info* info) {
+    if (info->block->metadata == 0
+        && redstone_is_powered(&s->world, info->x, info->y, info->z))
+        tnt_ignite(s, info->x, info->y, info->z);
+}
+
 static void onWorldTick(struct server_local* s, struct block_info* info) {
     uint8_t fuse = info->block->metadata;
-    if (fuse == 0) {
-        bool powered = false;
-        for (int side = 0; side < SIDE_MAX; ++side) {
-            if (!info->neighbours) break;
-            struct block_data nb = info->neighbours[side];
-            uint8_t m = nb.metadata & 0x0F;
-            if ((nb.type == BLOCK_REDSTONE_WIRE && m > 0) ||
-                nb.type == BLOCK_REDSTONE_TORCH_LIT ||
-                ((nb.type == BLOCK_STONE_PRESSURE_PLATE ||
-                  nb.type == BLOCK_WOOD_PRESSURE_PLATE) &&
-                 (m & 0x01)))
-            {
-                powered = true;
-                break;
-            }
-        }
-        if (powered) {
-            server_world_set_block(s, info->x, info->y, info->z,
-                (struct block_data){ .type = BLOCK_TNT, .metadata = TNT_FUSE_TICKS });
-        }
+    if (fuse == 0)
         return;
-    }
     if (fuse > 1) {
         info->block->metadata--;
         server_world_set_block(s, info->x, info->y, info->z, *info->block);
-        vec3 center = { info->x + 0.5f, info->y + 0.5f, info->z + 0.5f };
-        particle_generate_smoke(center, 1.0f);
+        block_tick_schedule(&s->world, info->x, info->y, info->z, 1);
     } else {
         server_world_set_block(s, info->x, info->y, info->z,
             (struct block_data){ .type = BLOCK_AIR, .metadata = 0, .sky_light = 0, .torch_light = 15 });
@@ -158,10 +162,8 @@ static uint8_t getTextureIndex(struct block_info* this, enum side side) {
 static void onRightClick(struct server_local* s, struct item_data* it,
 						 struct block_info* where, struct block_info* on,
 						 enum side on_side) {
-	if (on->block->type == BLOCK_TNT && on->block->metadata == 0) {
-		server_world_set_block(s, on->x, on->y, on->z,
-			(struct block_data){ .type = BLOCK_TNT, .metadata = TNT_FUSE_TICKS });
-	}
+	if (on->block->type == BLOCK_TNT && on->block->metadata == 0)
+		tnt_ignite(s, on->x, on->y, on->z);
 }
 
 static bool onItemPlace(struct server_local* s, struct item_data* it,
@@ -194,8 +196,11 @@ struct block block_tnt = {
 	.getDroppedItem = block_drop_default,
 	.onRandomTick = NULL,
 	.onWorldTick = onWorldTick,
+	.onNeighbourBlockChange = onNeighbourBlockChange,
+	.onDisplayTick = onDisplayTick,
 	.onRightClick = onRightClick,
 	.transparent = false,
+	.full_cube = true,
 	.renderBlock = render_block_full,
 	.renderBlockAlways = NULL,
 	.luminance = 0,
@@ -100,7 +100,7 @@ static size_t drop_redstone_torch(struct block_info* this, struct item_data* it,
 	return 1;
 }
 
-static void onWorldTick(struct server_local* s, struct block_info* blk) {
+static void onDisplayTick(struct block_info* blk) {
     if (rand_gen_flt(&gstate.rand_src) > (1.0f/3.0f)) return;
 
     // determine the position of the flame/smoke effect
@@ -138,7 +138,7 @@ static void onWorldTick(struct server_local* s, struct block_info* blk) {
     };
 
     // spawn appropriate effect based on torch type
-    if (blk->block->type == 50) {
+    if (blk->block->type == BLOCK_TORCH) {
     	particle_generate_torch(pos);
     }
     else {
@@ -155,7 +155,7 @@ struct block block_torch = {
 	.getTextureIndex = getTextureIndex1,
 	.getDroppedItem = block_drop_default,
 	.onRandomTick = NULL,
-	.onWorldTick = onWorldTick,
+	.onDisplayTick = onDisplayTick,
 	.onRightClick = NULL,
 	.transparent = false,
 	.renderBlock = render_block_torch,
@@ -189,7 +189,6 @@ struct block block_redstone_torch = {
 	.getMaterial = getMaterial,
 	.getTextureIndex = getTextureIndex2,
 	.getDroppedItem = drop_redstone_torch,
-	.onWorldTick = onWorldTick,
 	.onRandomTick = NULL,
 	.onRightClick = NULL,
 	.transparent = false,
@@ -226,7 +225,7 @@ struct block block_redstone_torch_lit = {
 	.getDroppedItem = drop_redstone_torch,
 	.onRandomTick = NULL,
 	.onRightClick = NULL,
-	.onWorldTick = onWorldTick,
+	.onDisplayTick = onDisplayTick,
 	.transparent = false,
 	.renderBlock = render_block_torch,
 	.renderBlockAlways = NULL,
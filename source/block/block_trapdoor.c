@@ -22,6 +22,7 @@
 // best would be to add something that looks at the neighbour state change
 //todo; fix rendering of the door in various metadata positions
 
+#include "../network/redstone.h"
 #include "../network/server_local.h"
 #include "blocks.h"
 
@@ -115,21 +116,7 @@ static bool onItemPlace(struct server_local* s, struct item_data* it,
 
 static void onNeighbourBlockChange(struct server_local* s, struct block_info* info) {
     struct block_data cur = *info->block;
-    if (!info->neighbours) return;
-
-    bool powered = false;
-    for (int side = 0; side < SIDE_MAX; ++side) {
-        struct block_data nb = info->neighbours[side];
-        uint8_t m = nb.metadata & 0x0F;
-        if ((nb.type == BLOCK_REDSTONE_WIRE && m > 0) ||
-            nb.type == BLOCK_REDSTONE_TORCH_LIT ||
-           ((nb.type == BLOCK_STONE_PRESSURE_PLATE ||
-             nb.type == BLOCK_WOOD_PRESSURE_PLATE) &&
-            (m & 0x01))) {
-            powered = true;
-            break;
-        }
-    }
+    bool powered = redstone_is_powered(&s->world, info->x, info->y, info->z);
 
     uint8_t facing = cur.metadata & 0x03;
     uint8_t newMeta = facing | (powered ? 0x04 : 0x00);
@@ -77,6 +77,7 @@ struct block block_workbench = {
 	.onRandomTick = NULL,
 	.onRightClick = onRightClick,
 	.transparent = false,
+	.full_cube = true,
 	.renderBlock = render_block_full,
 	.renderBlockAlways = NULL,
 	.luminance = 0,
@@ -24,6 +24,9 @@
 #include "blocks.h"
 
 struct block* blocks[256];
+uint8_t block_flags[256];
+uint8_t block_opacity[256];
+uint8_t block_luminance[256];
 
 void blocks_init() {
 	for(int k = 0; k < 256; k++)
@@ -142,6 +145,27 @@ void blocks_init() {
 			assert(blocks[k]->block_item.onItemPlace);
 		}
 	}
+
+	for(int k = 0; k < 256; k++) {
+		struct block* b = blocks[k];
+
+		if(!b) {
+			block_flags[k] = BLOCK_FLAG_SEE_THROUGH | BLOCK_FLAG_LIGHT_THROUGH;
+			block_opacity[k] = 0;
+			block_luminance[k] = 0;
+			continue;
+		}
+
+		block_flags[k] = (b->transparent ? BLOCK_FLAG_TRANSPARENT : 0)
+			| (b->full_cube ? BLOCK_FLAG_FULL_CUBE : 0)
+			| (b->can_see_through ? BLOCK_FLAG_SEE_THROUGH : 0)
+			| ((b->can_see_through && !b->ignore_lighting) ?
+				   BLOCK_FLAG_LIGHT_THROUGH :
+				   0)
+			| (b->renderBlockAlways ? BLOCK_FLAG_RENDER_ALWAYS : 0);
+		block_opacity[k] = b->opacity;
+		block_luminance[k] = b->luminance;
+	}
 }
 
 enum side blocks_side_opposite(enum side s) {
@@ -48,11 +48,14 @@ struct block {
 	void (*onRandomTick)(struct server_local*, struct block_info*);
 	void (*onRightClick)(struct server_local*, struct item_data*,
 						 struct block_info*, struct block_info*, enum side);
+	// called once a tick scheduled with block_tick_schedule is due
     void (*onWorldTick)(struct server_local* s, struct block_info* this);
 	void (*onNeighbourBlockChange)(struct server_local* s, struct block_info* info);
-	void (*onDay)(struct server_local* s, struct block_info* info);
-	void (*onNight)(struct server_local* s, struct block_info* info);
+	// client side, ambient particles of blocks near the camera
+	void (*onDisplayTick)(struct block_info* this);
 	bool transparent;
+	// side mask is face_occlusion_full() for every side and metadata
+	bool full_cube;
 	uint8_t luminance : 4;
 	uint8_t opacity : 4;
 	bool double_sided;
@@ -164,6 +167,25 @@ extern struct block block_sign;
 
 extern struct block* blocks[256];
 
+// flat per-id copies of hot struct block fields, filled by blocks_init()
+enum block_flag {
+	BLOCK_FLAG_TRANSPARENT = 0x01,
+	BLOCK_FLAG_FULL_CUBE = 0x02,
+	// air or can_see_through
+	BLOCK_FLAG_SEE_THROUGH = 0x04,
+	// air or can_see_through without ignore_lighting
+	BLOCK_FLAG_LIGHT_THROUGH = 0x08,
+	BLOCK_FLAG_RENDER_ALWAYS = 0x10,
+};
+
+extern uint8_t block_flags[256];
+extern uint8_t block_opacity[256];
+extern uint8_t block_luminance[256];
+
+#define BLOCK_OPAQUE_CUBE(type)                                                \
+	((block_flags[type] & (BLOCK_FLAG_FULL_CUBE | BLOCK_FLAG_TRANSPARENT))     \
+	 == BLOCK_FLAG_FULL_CUBE)
+
 #include "../graphics/render_block.h"
 #include "../graphics/render_item.h"
 
@@ -180,5 +202,6 @@ size_t block_drop_default(struct block_info* this, struct item_data* it,
 
 
 void notifyNeighbours(struct server_local* s, w_coord_t x, w_coord_t y, w_coord_t z);
+void pressure_plate_step(struct server_local* s);
 
 #endif
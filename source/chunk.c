@@ -50,8 +50,18 @@ void chunk_init(struct chunk* c, struct world* world, w_coord_t x, w_coord_t y,
 	for(int k = 0; k < 13; k++)
 		c->has_displist[k] = false;
 	c->rebuild_displist = false;
+	c->mesh_evicted = false;
+	c->mesh_bytes = 0;
+	c->emitters = NULL;
+	c->emitters_count = 0;
 	c->world = world;
 	c->reference_count = 0;
+	c->occlusion = (struct chunk_occlusion) {
+		.query = 0,
+		.frame = 0,
+		.pending = false,
+		.occluded = false,
+	};
 
 	ilist_chunks_init_field(c);
 	ilist_chunks2_init_field(c);
@@ -67,6 +77,12 @@ static void chunk_destroy(struct chunk* c) {
 			displaylist_destroy(c->mesh + k);
 	}
 
+	c->world->mesh_bytes -= c->mesh_bytes;
+
+	if(c->occlusion.query)
+		gfx_occlusion_destroy(c->occlusion.query);
+
+	free(c->emitters);
 	free(c);
 }
 
@@ -185,12 +201,29 @@ bool chunk_check_built(struct chunk* c) {
 
 	if(c->rebuild_displist && chunk_mesher_send(c)) {
 		c->rebuild_displist = false;
+		c->mesh_evicted = false;
 		return true;
 	}
 
 	return false;
 }
 
+void chunk_evict_mesh(struct chunk* c) {
+	assert(c);
+
+	for(int k = 0; k < 13; k++) {
+		if(c->has_displist[k])
+			displaylist_destroy(c->mesh + k);
+
+		c->has_displist[k] = false;
+	}
+
+	c->world->mesh_bytes -= c->mesh_bytes;
+	c->mesh_bytes = 0;
+	c->mesh_evicted = true;
+	c->rebuild_displist = true;
+}
+
 void chunk_pre_render(struct chunk* c, mat4 view, bool has_fog) {
 	assert(c && view);
 
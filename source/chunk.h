@@ -51,10 +51,22 @@ struct chunk {
 	struct displaylist mesh[13];
 	bool has_displist[13];
 	bool rebuild_displist;
+	// meshes dropped to stay in budget, rebuilt once visible again
+	bool mesh_evicted;
+	size_t mesh_bytes;
+	struct chunk_emitter* emitters;
+	size_t emitters_count;
 	struct world* world;
 	uint8_t reachable[6];
 	size_t reference_count;
 	bool has_fog;
+	// hardware occlusion query, results lag a frame behind
+	struct chunk_occlusion {
+		uint32_t query;
+		uint32_t frame;
+		bool pending;
+		bool occluded;
+	} occlusion;
 	struct chunk_step {
 		bool visited;
 		enum side from;
@@ -79,6 +91,7 @@ struct block_data chunk_lookup_block(struct chunk* c, w_coord_t x, w_coord_t y,
 void chunk_set_block(struct chunk* c, c_coord_t x, c_coord_t y, c_coord_t z,
 					 struct block_data blk);
 bool chunk_check_built(struct chunk* c);
+void chunk_evict_mesh(struct chunk* c);
 void chunk_set_light(struct chunk* c, c_coord_t x, c_coord_t y, c_coord_t z,
 					 uint8_t light);
 void chunk_render(struct chunk* c, bool pass, float x, float y, float z);
@@ -20,9 +20,15 @@
 #include <assert.h>
 #include <stdint.h>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 #include "chunk_mesher.h"
+#include "game/game_state.h"
 #include "platform/displaylist.h"
 #include "platform/thread.h"
+#include "platform/time.h"
 #include "stack.h"
 #include "world.h"
 
@@ -31,6 +37,11 @@
 #define BLK_INDEX2(x, y, z) ((x) + ((z) + (y) * CHUNK_SIZE) * CHUNK_SIZE)
 #define BLK_DATA(b, x, y, z) ((b)[BLK_INDEX((x) + 1, (y) + 1, (z) + 1)])
 
+#define LIGHT_ROW (CHUNK_SIZE + 2)
+#define LIGHT_VOLUME (LIGHT_ROW * LIGHT_ROW * LIGHT_ROW)
+#define LIGHT_DATA(l, axis, x, y, z)                                           \
+	((l)[(axis)*LIGHT_VOLUME + BLK_INDEX(x, y, z)])
+
 #ifndef MAX
 #define MAX(a, b) ((a) > (b) ? (a) : (b))
 #endif
@@ -46,6 +57,8 @@ struct chunk_mesher_rpc {
 		struct displaylist mesh[13];
 		bool has_displist[13];
 		uint8_t reachable[6];
+		struct chunk_emitter* emitters;
+		size_t emitters_count;
 	} result;
 };
 
@@ -53,6 +66,14 @@ static struct chunk_mesher_rpc rpc_msg[CHUNK_MESHER_QLENGTH];
 static struct thread_channel mesher_requests;
 static struct thread_channel mesher_results;
 static struct thread_channel mesher_empty_msg;
+// reused by every build, finished meshes are exact-size copies
+static struct displaylist mesher_scratch[13];
+
+// finished meshes waiting for their gpu upload, oldest first
+static struct chunk_mesher_rpc* upload_queue[CHUNK_MESHER_QLENGTH];
+static size_t upload_queue_length;
+static size_t upload_budget_bytes;
+static float upload_budget_s;
 
 static int chunk_test_side(enum side* on_sides, c_coord_t x, c_coord_t y,
 						   c_coord_t z) {
@@ -87,8 +108,7 @@ static void chunk_test(struct block_data* bd, struct stack* queue,
 	assert(bd && queue && visited && reachable);
 
 	if(visited[BLK_INDEX2(x, y, z)]
-	   || (blocks[BLK_DATA(bd, x, y, z).type]
-		   && !blocks[BLK_DATA(bd, x, y, z).type]->can_see_through))
+	   || !(block_flags[BLK_DATA(bd, x, y, z).type] & BLOCK_FLAG_SEE_THROUGH))
 		return;
 
 	stack_clear(queue);
@@ -119,8 +139,8 @@ static void chunk_test(struct block_data* bd, struct stack* queue,
 			if(nx >= 0 && ny >= 0 && nz >= 0 && nx < CHUNK_SIZE
 			   && ny < CHUNK_SIZE && nz < CHUNK_SIZE
 			   && !visited[BLK_INDEX2(nx, ny, nz)]
-			   && (!blocks[BLK_DATA(bd, nx, ny, nz).type]
-				   || blocks[BLK_DATA(bd, nx, ny, nz).type]->can_see_through)) {
+			   && (block_flags[BLK_DATA(bd, nx, ny, nz).type]
+				   & BLOCK_FLAG_SEE_THROUGH)) {
 				stack_push(queue, (uint8_t[]) {nx, ny, nz});
 				visited[BLK_INDEX2(nx, ny, nz)] = true;
 			}
@@ -162,105 +182,132 @@ static void chunk_test_init(struct block_data* bd, uint8_t* reachable) {
 	free(visited);
 }
 
-static void chunk_mesher_vertex_light(struct block_data* bd,
-									  uint8_t* light_data) {
-	assert(bd && light_data);
+// corner light from the sum and number of samples that let light through
+static uint8_t light_corner[5][15 * 4 + 1];
 
+static void chunk_mesher_light_init() {
 	const int shade_table[5] = {0, 5, 3, 1, 0};
 
-	for(c_coord_t y = 0; y < CHUNK_SIZE + 2; y++) {
-		for(c_coord_t z = 0; z < CHUNK_SIZE + 2; z++) {
-			for(c_coord_t x = 0; x < CHUNK_SIZE + 2; x++) {
-				// TODO: clean up horrible code
-
-				if(x != CHUNK_SIZE + 1 && z != CHUNK_SIZE + 1) {
-					struct block_data b1[4] = {
-						BLK_DATA(bd, x + 0, y - 1, z + 0),
-						BLK_DATA(bd, x - 1, y - 1, z + 0),
-						BLK_DATA(bd, x + 0, y - 1, z - 1),
-						BLK_DATA(bd, x - 1, y - 1, z - 1),
-					};
+	for(int count = 0; count < 5; count++) {
+		for(int sum = 0; sum <= 15 * 4; sum++) {
+			int avg = count > 0 ? (sum + count - 1) / count : 0;
+			light_corner[count][sum] = MAX(avg - shade_table[count], 0);
+		}
+	}
+}
 
-					int sum_sky = 0, sum_torch = 0, count = 0;
-					for(int k = 0; k < 4; k++) {
-						if(!blocks[b1[k].type]
-						   || (blocks[b1[k].type]->can_see_through
-							   && !blocks[b1[k].type]->ignore_lighting)) {
-							sum_sky += b1[k].sky_light;
-							sum_torch += b1[k].torch_light;
-							count++;
-						}
-					}
+#ifdef __SSE2__
+static inline __m128i light_sum4(const uint8_t* p, size_t a, size_t b) {
+	return _mm_add_epi8(
+		_mm_add_epi8(_mm_loadu_si128((const __m128i*)p),
+					 _mm_loadu_si128((const __m128i*)(p + a))),
+		_mm_add_epi8(_mm_loadu_si128((const __m128i*)(p + b)),
+					 _mm_loadu_si128((const __m128i*)(p + a + b))));
+}
 
-					sum_torch = count > 0 ? (sum_torch + count - 1) / count : 0;
-					sum_sky = count > 0 ? (sum_sky + count - 1) / count : 0;
-					sum_torch = MAX(sum_torch - shade_table[count], 0);
-					sum_sky = MAX(sum_sky - shade_table[count], 0);
+// same as light_corner[count][sum], 16 lanes at once
+static inline __m128i light_corner_sse2(__m128i sum, __m128i count) {
+	const __m128i zero = _mm_setzero_si128();
+
+	__m128i half = _mm_avg_epu8(sum, zero);
+	__m128i quarter = _mm_avg_epu8(half, zero);
+
+	// (sum + 2) / 3 by multiplying with 2^16 / 3
+	__m128i sum2 = _mm_add_epi8(sum, _mm_set1_epi8(2));
+	__m128i third = _mm_packus_epi16(
+		_mm_mulhi_epu16(_mm_unpacklo_epi8(sum2, zero), _mm_set1_epi16(0x5556)),
+		_mm_mulhi_epu16(_mm_unpackhi_epi8(sum2, zero), _mm_set1_epi16(0x5556)));
+
+	__m128i r = _mm_and_si128(_mm_cmpeq_epi8(count, _mm_set1_epi8(1)),
+							  _mm_subs_epu8(sum, _mm_set1_epi8(5)));
+	r = _mm_or_si128(r,
+					 _mm_and_si128(_mm_cmpeq_epi8(count, _mm_set1_epi8(2)),
+								   _mm_subs_epu8(half, _mm_set1_epi8(3))));
+	r = _mm_or_si128(r,
+					 _mm_and_si128(_mm_cmpeq_epi8(count, _mm_set1_epi8(3)),
+								   _mm_subs_epu8(third, _mm_set1_epi8(1))));
+	return _mm_or_si128(
+		r, _mm_and_si128(_mm_cmpeq_epi8(count, _mm_set1_epi8(4)), quarter));
+}
+#endif
 
-					light_data[BLK_INDEX(x, y, z) * 3 + 0]
-						= (sum_torch << 4) | sum_sky;
-				}
+/* Computes length corners along x. Each corner averages the four samples at
+ * offsets 0, a, b and a + b from it. */
+static void chunk_mesher_light_span(const uint8_t* sky, const uint8_t* torch,
+									const uint8_t* count, size_t a, size_t b,
+									uint8_t* out, size_t length) {
+	size_t k = 0;
+
+#ifdef __SSE2__
+	for(; k + 16 <= length; k += 16) {
+		__m128i n = light_sum4(count + k, a, b);
+		__m128i s = light_corner_sse2(light_sum4(sky + k, a, b), n);
+		__m128i t = light_corner_sse2(light_sum4(torch + k, a, b), n);
+
+		// both are at most 15, so no bits cross into the next lane
+		_mm_storeu_si128((__m128i*)(out + k),
+						 _mm_or_si128(_mm_slli_epi16(t, 4), s));
+	}
+#endif
 
-				if(y != CHUNK_SIZE + 1 && z != CHUNK_SIZE + 1) {
-					struct block_data b2[4] = {
-						BLK_DATA(bd, x - 1, y + 0, z + 0),
-						BLK_DATA(bd, x - 1, y - 1, z + 0),
-						BLK_DATA(bd, x - 1, y + 0, z - 1),
-						BLK_DATA(bd, x - 1, y - 1, z - 1),
-					};
+	for(; k < length; k++) {
+		int n = count[k] + count[k + a] + count[k + b] + count[k + a + b];
+		int s = sky[k] + sky[k + a] + sky[k + b] + sky[k + a + b];
+		int t = torch[k] + torch[k + a] + torch[k + b] + torch[k + a + b];
+		out[k] = (light_corner[n][t] << 4) | light_corner[n][s];
+	}
+}
 
-					int sum_sky = 0, sum_torch = 0, count = 0;
-					for(int k = 0; k < 4; k++) {
-						if(!blocks[b2[k].type]
-						   || (blocks[b2[k].type]->can_see_through
-							   && !blocks[b2[k].type]->ignore_lighting)) {
-							sum_sky += b2[k].sky_light;
-							sum_torch += b2[k].torch_light;
-							count++;
-						}
-					}
+/* light_data holds LIGHT_VOLUME * 6 bytes: three output planes (one per
+ * axis), followed by scratch space for the sky, torch and count planes */
+static void chunk_mesher_vertex_light(struct block_data* bd,
+									  uint8_t* light_data) {
+	assert(bd && light_data);
 
-					sum_torch = count > 0 ? (sum_torch + count - 1) / count : 0;
-					sum_sky = count > 0 ? (sum_sky + count - 1) / count : 0;
-					sum_torch = MAX(sum_torch - shade_table[count], 0);
-					sum_sky = MAX(sum_sky - shade_table[count], 0);
+	uint8_t* sky = light_data + LIGHT_VOLUME * 3;
+	uint8_t* torch = sky + LIGHT_VOLUME;
+	uint8_t* count = torch + LIGHT_VOLUME;
 
-					light_data[BLK_INDEX(x, y, z) * 3 + 1]
-						= (sum_torch << 4) | sum_sky;
-				}
+	for(size_t k = 0; k < LIGHT_VOLUME; k++) {
+		bool pass = block_flags[bd[k].type] & BLOCK_FLAG_LIGHT_THROUGH;
+		sky[k] = pass ? bd[k].sky_light : 0;
+		torch[k] = pass ? bd[k].torch_light : 0;
+		count[k] = pass;
+	}
 
-				if(x != CHUNK_SIZE + 1 && y != CHUNK_SIZE + 1) {
-					struct block_data b3[4] = {
-						BLK_DATA(bd, x + 0, y + 0, z - 1),
-						BLK_DATA(bd, x - 1, y + 0, z - 1),
-						BLK_DATA(bd, x + 0, y - 1, z - 1),
-						BLK_DATA(bd, x - 1, y - 1, z - 1),
-					};
+	const size_t row = LIGHT_ROW, layer = LIGHT_ROW * LIGHT_ROW;
 
-					int sum_sky = 0, sum_torch = 0, count = 0;
-					for(int k = 0; k < 4; k++) {
-						if(!blocks[b3[k].type]
-						   || (blocks[b3[k].type]->can_see_through
-							   && !blocks[b3[k].type]->ignore_lighting)) {
-							sum_sky += b3[k].sky_light;
-							sum_torch += b3[k].torch_light;
-							count++;
-						}
-					}
+	for(c_coord_t y = 0; y < LIGHT_ROW; y++) {
+		for(c_coord_t z = 0; z < LIGHT_ROW; z++) {
+			size_t i = BLK_INDEX(0, y, z);
 
-					sum_torch = count > 0 ? (sum_torch + count - 1) / count : 0;
-					sum_sky = count > 0 ? (sum_sky + count - 1) / count : 0;
-					sum_torch = MAX(sum_torch - shade_table[count], 0);
-					sum_sky = MAX(sum_sky - shade_table[count], 0);
+			if(z != LIGHT_ROW - 1)
+				chunk_mesher_light_span(sky + i, torch + i, count + i, 1, row,
+										light_data + i, LIGHT_ROW - 1);
 
-					light_data[BLK_INDEX(x, y, z) * 3 + 2]
-						= (sum_torch << 4) | sum_sky;
-				}
-			}
+			if(y != LIGHT_ROW - 1 && z != LIGHT_ROW - 1)
+				chunk_mesher_light_span(sky + i, torch + i, count + i, row,
+										layer, light_data + LIGHT_VOLUME + i,
+										LIGHT_ROW);
+
+			if(y != LIGHT_ROW - 1)
+				chunk_mesher_light_span(sky + i, torch + i, count + i, 1, layer,
+										light_data + LIGHT_VOLUME * 2 + i,
+										LIGHT_ROW - 1);
 		}
 	}
 }
 
+// axis and corner offset of each entry in vertex_light
+static const uint8_t vertex_light_corner[24][4] = {
+	{0, 0, 0, 0}, {0, 1, 0, 0}, {0, 1, 0, 1}, {0, 0, 0, 1},
+	{0, 0, 2, 0}, {0, 1, 2, 0}, {0, 1, 2, 1}, {0, 0, 2, 1},
+	{1, 0, 0, 0}, {1, 0, 1, 0}, {1, 0, 1, 1}, {1, 0, 0, 1},
+	{1, 2, 0, 0}, {1, 2, 1, 0}, {1, 2, 1, 1}, {1, 2, 0, 1},
+	{2, 0, 0, 0}, {2, 1, 0, 0}, {2, 1, 1, 0}, {2, 0, 1, 0},
+	{2, 0, 0, 2}, {2, 1, 0, 2}, {2, 1, 1, 2}, {2, 0, 1, 2},
+};
+
 static void chunk_mesher_rebuild(struct block_data* bd, w_coord_t cx,
 								 w_coord_t cy, w_coord_t cz,
 								 struct displaylist* d, bool count_only,
@@ -272,29 +319,54 @@ static void chunk_mesher_rebuild(struct block_data* bd, w_coord_t cx,
 	for(int k = 0; k < 13; k++)
 		vertices[k] = 0;
 
+	int offset[SIDE_MAX][3];
+	for(int k = 0; k < SIDE_MAX; k++)
+		blocks_side_offset((enum side)k, offset[k] + 0, offset[k] + 1,
+						   offset[k] + 2);
+
 	for(c_coord_t y = 0; y < CHUNK_SIZE; y++) {
 		for(c_coord_t z = 0; z < CHUNK_SIZE; z++) {
 			for(c_coord_t x = 0; x < CHUNK_SIZE; x++) {
 				struct block_data local = BLK_DATA(bd, x, y, z);
 
 				if(blocks[local.type]) {
+					uint8_t local_flags = block_flags[local.type];
 					struct block_data neighbours[6];
-					struct block_info neighbours_info[6];
+					// faces known to be visible, and faces that still need
+					// their side masks compared
+					uint8_t visible = 0, shaped = 0;
 
 					for(int k = 0; k < SIDE_MAX; k++) {
-						enum side s = (enum side)k;
+						neighbours[k] = BLK_DATA(bd, x + offset[k][0],
+												 y + offset[k][1],
+												 z + offset[k][2]);
+
+						uint8_t flags = block_flags[neighbours[k].type];
+
+						if(!blocks[neighbours[k].type]
+						   || (!(local_flags & BLOCK_FLAG_TRANSPARENT)
+							   && (flags & BLOCK_FLAG_TRANSPARENT))) {
+							visible |= 1 << k;
+						} else if(!BLOCK_OPAQUE_CUBE(local.type)
+								  || !BLOCK_OPAQUE_CUBE(neighbours[k].type)) {
+							shaped |= 1 << k;
+						}
+					}
 
-						int ox, oy, oz;
-						blocks_side_offset(s, &ox, &oy, &oz);
+					// e.g. stone buried in stone
+					if(!visible && !shaped
+					   && !(local_flags & BLOCK_FLAG_RENDER_ALWAYS))
+						continue;
 
-						neighbours[k] = BLK_DATA(bd, x + ox, y + oy, z + oz);
+					struct block_info neighbours_info[6];
 
+					for(int k = 0; k < SIDE_MAX; k++) {
 						neighbours_info[k] = (struct block_info) {
 							.block = neighbours + k,
 							.neighbours = NULL,
-							.x = cx + x + ox,
-							.y = cy + y + oy,
-							.z = cz + z + oz,
+							.x = cx + x + offset[k][0],
+							.y = cy + y + offset[k][1],
+							.z = cz + z + offset[k][2],
 						};
 					}
 
@@ -312,12 +384,9 @@ static void chunk_mesher_rebuild(struct block_data* bd, w_coord_t cx,
 					for(int k = 0; k < SIDE_MAX; k++) {
 						enum side s = (enum side)k;
 
-						bool face_visible = true;
+						bool face_visible = visible & (1 << k);
 
-						if(blocks[neighbours[k].type]
-						   && ((!blocks[local.type]->transparent
-								&& !blocks[neighbours[k].type]->transparent)
-							   || blocks[local.type]->transparent)) {
+						if(shaped & (1 << k)) {
 							struct face_occlusion* a
 								= blocks[local.type]->getSideMask(
 									&local_info, s, neighbours_info + k);
@@ -331,122 +400,28 @@ static void chunk_mesher_rebuild(struct block_data* bd, w_coord_t cx,
 
 						int dp_index = k;
 
-						if(blocks[local.type]->transparent)
+						if(local_flags & BLOCK_FLAG_TRANSPARENT)
 							dp_index += 6;
 
 						if(blocks[local.type]->double_sided)
 							dp_index = 12;
 
 						if(face_visible
-						   || blocks[local.type]->renderBlockAlways) {
+						   || (local_flags & BLOCK_FLAG_RENDER_ALWAYS)) {
 							if(!light_data) {
-								light_data
-									= malloc((CHUNK_SIZE + 2) * (CHUNK_SIZE + 2)
-											 * (CHUNK_SIZE + 2) * 3);
+								light_data = malloc(LIGHT_VOLUME * 6);
 								assert(light_data);
 								chunk_mesher_vertex_light(bd, light_data);
 							}
 
 							if(!light_loaded) {
 								light_loaded = true;
-								vertex_light[0]
-									= light_data[BLK_INDEX(x + 0, y + 0, z + 0)
-													 * 3
-												 + 0];
-								vertex_light[1]
-									= light_data[BLK_INDEX(x + 1, y + 0, z + 0)
-													 * 3
-												 + 0];
-								vertex_light[2]
-									= light_data[BLK_INDEX(x + 1, y + 0, z + 1)
-													 * 3
-												 + 0];
-								vertex_light[3]
-									= light_data[BLK_INDEX(x + 0, y + 0, z + 1)
-													 * 3
-												 + 0];
-								vertex_light[4]
-									= light_data[BLK_INDEX(x + 0, y + 2, z + 0)
-													 * 3
-												 + 0];
-								vertex_light[5]
-									= light_data[BLK_INDEX(x + 1, y + 2, z + 0)
-													 * 3
-												 + 0];
-								vertex_light[6]
-									= light_data[BLK_INDEX(x + 1, y + 2, z + 1)
-													 * 3
-												 + 0];
-								vertex_light[7]
-									= light_data[BLK_INDEX(x + 0, y + 2, z + 1)
-													 * 3
-												 + 0];
-
-								vertex_light[8]
-									= light_data[BLK_INDEX(x + 0, y + 0, z + 0)
-													 * 3
-												 + 1];
-								vertex_light[9]
-									= light_data[BLK_INDEX(x + 0, y + 1, z + 0)
-													 * 3
-												 + 1];
-								vertex_light[10]
-									= light_data[BLK_INDEX(x + 0, y + 1, z + 1)
-													 * 3
-												 + 1];
-								vertex_light[11]
-									= light_data[BLK_INDEX(x + 0, y + 0, z + 1)
-													 * 3
-												 + 1];
-								vertex_light[12]
-									= light_data[BLK_INDEX(x + 2, y + 0, z + 0)
-													 * 3
-												 + 1];
-								vertex_light[13]
-									= light_data[BLK_INDEX(x + 2, y + 1, z + 0)
-													 * 3
-												 + 1];
-								vertex_light[14]
-									= light_data[BLK_INDEX(x + 2, y + 1, z + 1)
-													 * 3
-												 + 1];
-								vertex_light[15]
-									= light_data[BLK_INDEX(x + 2, y + 0, z + 1)
-													 * 3
-												 + 1];
-
-								vertex_light[16]
-									= light_data[BLK_INDEX(x + 0, y + 0, z + 0)
-													 * 3
-												 + 2];
-								vertex_light[17]
-									= light_data[BLK_INDEX(x + 1, y + 0, z + 0)
-													 * 3
-												 + 2];
-								vertex_light[18]
-									= light_data[BLK_INDEX(x + 1, y + 1, z + 0)
-													 * 3
-												 + 2];
-								vertex_light[19]
-									= light_data[BLK_INDEX(x + 0, y + 1, z + 0)
-													 * 3
-												 + 2];
-								vertex_light[20]
-									= light_data[BLK_INDEX(x + 0, y + 0, z + 2)
-													 * 3
-												 + 2];
-								vertex_light[21]
-									= light_data[BLK_INDEX(x + 1, y + 0, z + 2)
-													 * 3
-												 + 2];
-								vertex_light[22]
-									= light_data[BLK_INDEX(x + 1, y + 1, z + 2)
-													 * 3
-												 + 2];
-								vertex_light[23]
-									= light_data[BLK_INDEX(x + 0, y + 1, z + 2)
-													 * 3
-												 + 2];
+								for(int j = 0; j < 24; j++) {
+									const uint8_t* c = vertex_light_corner[j];
+									vertex_light[j] = LIGHT_DATA(
+										light_data, c[0], x + c[1], y + c[2],
+										z + c[3]);
+								}
 							}
 						}
 
@@ -475,26 +450,67 @@ static void chunk_mesher_rebuild(struct block_data* bd, w_coord_t cx,
 		free(light_data);
 }
 
+static void chunk_mesher_emitters(struct block_data* bd,
+								  struct chunk_emitter** emitters,
+								  size_t* count) {
+	assert(bd && emitters && count);
+
+	*emitters = NULL;
+	*count = 0;
+
+	size_t capacity = 0;
+
+	for(c_coord_t y = 0; y < CHUNK_SIZE; y++) {
+		for(c_coord_t z = 0; z < CHUNK_SIZE; z++) {
+			for(c_coord_t x = 0; x < CHUNK_SIZE; x++) {
+				struct block_data local = BLK_DATA(bd, x, y, z);
+
+				if(!blocks[local.type] || !blocks[local.type]->onDisplayTick)
+					continue;
+
+				if(*count >= capacity) {
+					capacity = capacity ? capacity * 2 : 16;
+					struct chunk_emitter* tmp = realloc(
+						*emitters, capacity * sizeof(struct chunk_emitter));
+
+					if(!tmp)
+						return;
+
+					*emitters = tmp;
+				}
+
+				(*emitters)[(*count)++] = (struct chunk_emitter) {
+					.block = local,
+					.x = x,
+					.y = y,
+					.z = z,
+				};
+			}
+		}
+	}
+}
+
 static void chunk_mesher_build(struct chunk_mesher_rpc* req) {
 	for(int k = 0; k < 13; k++) {
 		req->result.has_displist[k] = false;
-		displaylist_init(req->result.mesh + k, 64, 3 * 2 + 2 * 1 + 1);
+		displaylist_reset(mesher_scratch + k);
 	}
 
 	size_t vertices[13];
 	chunk_mesher_rebuild(req->request.blocks, req->chunk->x, req->chunk->y,
-						 req->chunk->z, req->result.mesh, false, vertices);
+						 req->chunk->z, mesher_scratch, false, vertices);
 
 	for(int k = 0; k < 13; k++) {
 		if(vertices[k] > 0 && vertices[k] <= 0xFFFF * 4) {
-			displaylist_finalize(req->result.mesh + k, vertices[k]);
+			displaylist_finalize_from(req->result.mesh + k, mesher_scratch + k,
+									  vertices[k]);
 			req->result.has_displist[k] = true;
-		} else {
-			displaylist_destroy(req->result.mesh + k);
 		}
 	}
 
 	chunk_test_init(req->request.blocks, req->result.reachable);
+	chunk_mesher_emitters(req->request.blocks, &req->result.emitters,
+						  &req->result.emitters_count);
 
 	free(req->request.blocks);
 }
@@ -511,6 +527,19 @@ static void* chunk_mesher_local_thread(void* user) {
 }
 
 void chunk_mesher_init() {
+	chunk_mesher_light_init();
+
+	upload_queue_length = 0;
+	upload_budget_bytes = config_read_int(&gstate.config_user,
+										  "mesher.upload_budget_kb", 1024)
+		* 1024;
+	upload_budget_s
+		= config_read_int(&gstate.config_user, "mesher.upload_budget_ms", 2)
+		/ 1000.0F;
+
+	for(int k = 0; k < 13; k++)
+		displaylist_init(mesher_scratch + k, 64, 3 * 2 + 2 * 1 + 1);
+
 	tchannel_init(&mesher_requests, CHUNK_MESHER_QLENGTH);
 	tchannel_init(&mesher_results, CHUNK_MESHER_QLENGTH);
 	tchannel_init(&mesher_empty_msg, CHUNK_MESHER_QLENGTH);
@@ -522,25 +551,67 @@ void chunk_mesher_init() {
 	thread_create(&t, chunk_mesher_local_thread, NULL, 4);
 }
 
-void chunk_mesher_receive() {
+static void chunk_mesher_apply(struct chunk_mesher_rpc* result) {
+	size_t bytes = 0;
+
+	for(int k = 0; k < 13; k++) {
+		if(result->chunk->has_displist[k])
+			displaylist_destroy(result->chunk->mesh + k);
+
+		result->chunk->mesh[k] = result->result.mesh[k];
+		result->chunk->has_displist[k] = result->result.has_displist[k];
+
+		if(result->chunk->has_displist[k])
+			bytes += displaylist_size(result->chunk->mesh + k);
+	}
+
+	result->chunk->world->mesh_bytes += bytes - result->chunk->mesh_bytes;
+	result->chunk->mesh_bytes = bytes;
+
+	for(int k = 0; k < 6; k++)
+		result->chunk->reachable[k] = result->result.reachable[k];
+
+	free(result->chunk->emitters);
+	result->chunk->emitters = result->result.emitters;
+	result->chunk->emitters_count = result->result.emitters_count;
+
+	chunk_unref(result->chunk);
+
+	tchannel_send(&mesher_empty_msg, result, true);
+}
+
+size_t chunk_mesher_receive() {
 	struct chunk_mesher_rpc* result;
 
-	while(tchannel_receive(&mesher_results, (void**)&result, false)) {
-		for(int k = 0; k < 13; k++) {
-			if(result->chunk->has_displist[k])
-				displaylist_destroy(result->chunk->mesh + k);
+	while(upload_queue_length < CHUNK_MESHER_QLENGTH
+		  && tchannel_receive(&mesher_results, (void**)&result, false))
+		upload_queue[upload_queue_length++] = result;
 
-			result->chunk->mesh[k] = result->result.mesh[k];
-			result->chunk->has_displist[k] = result->result.has_displist[k];
-		}
+	ptime_t start = time_get();
+	size_t uploaded = 0;
+	size_t done = 0;
 
-		for(int k = 0; k < 6; k++)
-			result->chunk->reachable[k] = result->result.reachable[k];
+	/* whole chunks only, so that a chunk never shows a mix of old and new
+	 * meshes; it keeps drawing its previous mesh until then */
+	while(done < upload_queue_length
+		  && (done == 0
+			  || (uploaded < upload_budget_bytes
+				  && time_diff_s(start, time_get()) < upload_budget_s))) {
+		result = upload_queue[done++];
 
-		chunk_unref(result->chunk);
+		for(int k = 0; k < 13; k++) {
+			if(result->result.has_displist[k])
+				uploaded += displaylist_upload(result->result.mesh + k);
+		}
 
-		tchannel_send(&mesher_empty_msg, result, true);
+		chunk_mesher_apply(result);
 	}
+
+	upload_queue_length -= done;
+	memmove(upload_queue, upload_queue + done,
+			upload_queue_length * sizeof(*upload_queue));
+
+	return uploaded;
 }
 
 bool chunk_mesher_send(struct chunk* c) {
@@ -21,13 +21,23 @@
 #define CHUNK_MESHER_H
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "block/blocks_data.h"
 
 #define CHUNK_MESHER_QLENGTH 8
 
 struct chunk;
 
+// block with an onDisplayTick handler, in chunk coordinates
+struct chunk_emitter {
+	struct block_data block;
+	uint8_t x, y, z;
+};
+
 void chunk_mesher_init(void);
-void chunk_mesher_receive(void);
+size_t chunk_mesher_receive(void);
 bool chunk_mesher_send(struct chunk* c);
 
 #endif
@@ -25,6 +25,17 @@ const char* config_read_string(struct config* c, const char* key,
 	return res ? res : fallback;
 }
 
+int config_read_int(struct config* c, const char* key, int fallback) {
+	assert(c && key);
+
+	JSON_Object* obj = json_object(c->root);
+
+	if(!json_object_dothas_value_of_type(obj, key, JSONNumber))
+		return fallback;
+
+	return json_object_dotget_number(obj, key);
+}
+
 bool config_read_int_array(struct config* c, const char* key, int* dest,
 						   size_t* length) {
 	assert(c && key && dest);
@@ -12,6 +12,7 @@ struct config {
 bool config_create(struct config* c, const char* filename);
 const char* config_read_string(struct config* c, const char* key,
 							   const char* fallback);
+int config_read_int(struct config* c, const char* key, int fallback);
 bool config_read_int_array(struct config* c, const char* key, int* dest,
 						   size_t* length);
 void config_destroy(struct config* c);
@@ -206,50 +206,87 @@ bool entity_aabb_intersection(struct entity* e, struct AABB* a) {
 	return entity_intersection(e, a, entity_block_aabb_test);
 }
 
+// distance kept between an entity and the block it collided with
+#define ENTITY_SWEEP_SKIN 0.005F
+
 bool entity_intersection_threshold(struct entity* e, struct AABB* aabb,
 								   vec3 old_pos, vec3 new_pos,
 								   float* threshold) {
 	assert(e && aabb && old_pos && new_pos && threshold);
 
-	struct AABB tmp = *aabb;
-	aabb_translate(&tmp, old_pos[0], old_pos[1], old_pos[2]);
-	bool a = entity_aabb_intersection(e, &tmp);
+	vec3 delta;
+	glm_vec3_sub(new_pos, old_pos, delta);
+
+	struct AABB start = *aabb;
+	aabb_translate(&start, old_pos[0], old_pos[1], old_pos[2]);
+
+	// broad phase: every block touched anywhere along the movement
+	struct AABB sweep = start;
+	sweep.x1 += fminf(delta[0], 0.0F);
+	sweep.y1 += fminf(delta[1], 0.0F);
+	sweep.z1 += fminf(delta[2], 0.0F);
+	sweep.x2 += fmaxf(delta[0], 0.0F);
+	sweep.y2 += fmaxf(delta[1], 0.0F);
+	sweep.z2 += fmaxf(delta[2], 0.0F);
+
+	w_coord_t min_x = floorf(sweep.x1);
+	// need to look one further, otherwise fence block breaks
+	w_coord_t min_y = max((w_coord_t)(floorf(sweep.y1) - 1), 0);
+	w_coord_t min_z = floorf(sweep.z1);
+
+	w_coord_t max_x = ceilf(sweep.x2) + 1;
+	w_coord_t max_y = min((w_coord_t)(ceilf(sweep.y2) + 1), WORLD_HEIGHT - 1);
+	w_coord_t max_z = ceilf(sweep.z2) + 1;
+
+	bool moving = glm_vec3_norm2(delta) > 0.0F;
+	float impact = INFINITY;
+
+	for(w_coord_t x = min_x; x < max_x; x++) {
+		for(w_coord_t z = min_z; z < max_z; z++) {
+			for(w_coord_t y = min_y; y < max_y; y++) {
+				struct block_data blk;
 
-	tmp = *aabb;
-	aabb_translate(&tmp, new_pos[0], new_pos[1], new_pos[2]);
-	bool b = entity_aabb_intersection(e, &tmp);
+				if(!entity_get_block(e, x, y, z, &blk) || !blocks[blk.type])
+					continue;
 
-	if(!a && b) {
-		float range_min = 0.0F;
-		float range_max = 1.0F;
+				struct block_info blk_info = (struct block_info) {
+					.block = &blk,
+					.neighbours = NULL,
+					.x = x,
+					.y = y,
+					.z = z,
+				};
 
-		while(1) {
-			vec3 pos_min, pos_max;
-			glm_vec3_lerp(old_pos, new_pos, range_min, pos_min);
-			glm_vec3_lerp(old_pos, new_pos, range_max, pos_max);
+				struct block* b = blocks[blk.type];
+				size_t count = b->getBoundingBox(&blk_info, true, NULL);
 
-			if(glm_vec3_distance2(pos_min, pos_max) < glm_pow2(0.01F))
-				break;
+				if(count == 0)
+					continue;
 
-			float mid = (range_max + range_min) / 2.0F;
+				struct AABB bbox[count];
+				b->getBoundingBox(&blk_info, true, bbox);
 
-			vec3 pos_mid;
-			glm_vec3_lerp(old_pos, new_pos, mid, pos_mid);
+				for(size_t k = 0; k < count; k++) {
+					aabb_translate(bbox + k, x, y, z);
 
-			struct AABB dest = *aabb;
-			aabb_translate(&dest, pos_mid[0], pos_mid[1], pos_mid[2]);
+					if(aabb_intersection(&start, bbox + k)) {
+						*threshold = 0.0F;
+						return true;
+					}
 
-			if(entity_aabb_intersection(e, &dest)) {
-				range_max = mid;
-			} else {
-				range_min = mid;
+					float t;
+					if(moving
+					   && aabb_intersection_sweep(&start, bbox + k, delta[0],
+												  delta[1], delta[2], &t))
+						impact = fminf(impact, t);
+				}
 			}
 		}
+	}
 
-		*threshold = range_min;
-		return true;
-	} else if(a) {
-		*threshold = 0.0F;
+	if(impact <= 1.0F) {
+		*threshold
+			= fmaxf(impact - ENTITY_SWEEP_SKIN / glm_vec3_norm(delta), 0.0F);
 		return true;
 	} else {
 		*threshold = 1.0F;
@@ -0,0 +1,481 @@
+/*
+	Copyright (c) 2023 ByteBit/xtreme8000
+
+	This file is part of CavEX.
+
+	CavEX is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	CavEX is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with CavEX.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <m-lib/m-dict.h>
+
+#include "block/blocks.h"
+#include "chunk.h"
+#include "far_terrain.h"
+#include "platform/displaylist.h"
+#include "platform/gfx.h"
+#include "platform/texture.h"
+#include "platform/thread.h"
+
+// sections per tile side, blocks per cell side
+#define TILE_SECTIONS 4
+#define TILE_SIZE (TILE_SECTIONS * CHUNK_SIZE)
+#define CELL_SIZE 4
+#define TILE_CELLS (TILE_SIZE / CELL_SIZE)
+#define SECTION_CELLS (CHUNK_SIZE / CELL_SIZE)
+#define CELL_INDEX(x, z) ((x) + (z)*TILE_CELLS)
+
+// mesh origin, keeps heights in range of int16_t at 1/256 block
+#define TILE_BASE_Y (WORLD_HEIGHT / 2)
+#define SKIRT_DEPTH 16
+// matches FOG_DIST_NO_RENDER of chunks
+#define FOG_DIST_SCALE 1.13F
+
+#define SECTION_TILE(x)                                                        \
+	((x) < 0 ? (((x) + 1) / TILE_SECTIONS - 1) : (x) / TILE_SECTIONS)
+
+struct far_tile {
+	w_coord_t x, z;
+	// 0 for cells never seen
+	uint8_t height[TILE_CELLS * TILE_CELLS];
+	uint8_t texture[TILE_CELLS * TILE_CELLS];
+	// sections currently drawn by real chunks, one bit each
+	uint16_t loaded;
+	uint32_t version;
+	uint32_t mesh_version;
+	bool meshing;
+	bool has_mesh;
+	struct displaylist mesh;
+};
+
+DICT_DEF2(dict_far_tile, int64_t, M_BASIC_OPLIST, struct far_tile*,
+		  M_POD_OPLIST)
+
+struct far_mesher_rpc {
+	int64_t id;
+	uint32_t version;
+	// ingoing
+	uint8_t height[TILE_CELLS * TILE_CELLS];
+	uint8_t texture[TILE_CELLS * TILE_CELLS];
+	uint16_t loaded;
+	// outgoing
+	bool has_mesh;
+	struct displaylist mesh;
+};
+
+static dict_far_tile_t tiles;
+static float far_distance;
+// global, so that a recreated tile never matches an old mesh
+static uint32_t far_version;
+
+static struct far_mesher_rpc rpc_msg[FAR_TERRAIN_QLENGTH];
+static struct thread_channel far_requests;
+static struct thread_channel far_results;
+static struct thread_channel far_empty_msg;
+static struct displaylist far_scratch;
+
+static bool far_cell_loaded(struct far_mesher_rpc* req, int x, int z) {
+	return req->loaded
+		& (1 << (x / SECTION_CELLS + z / SECTION_CELLS * TILE_SECTIONS));
+}
+
+static bool far_cell_visible(struct far_mesher_rpc* req, int x, int z) {
+	return req->height[CELL_INDEX(x, z)] > 0 && !far_cell_loaded(req, x, z);
+}
+
+static void far_vertex(struct displaylist* d, int x, int y, int z,
+					   uint8_t light, uint8_t tex) {
+	displaylist_pos(d, x * 256, (y - TILE_BASE_Y) * 256, z * 256);
+	displaylist_color(d, light);
+	// a single texel, gives the average look of the block from far away
+	displaylist_texcoord(d, TEX_OFFSET(TEXTURE_X(tex)) + 8,
+						 TEX_OFFSET(TEXTURE_Y(tex)) + 8);
+}
+
+// lowest point of the side facing the neighbour cell at x, z
+static int far_side_bottom(struct far_mesher_rpc* req, int x, int z, int h) {
+	if(x < 0 || z < 0 || x >= TILE_CELLS || z >= TILE_CELLS)
+		return h > SKIRT_DEPTH ? h - SKIRT_DEPTH : 0;
+
+	if(far_cell_visible(req, x, z))
+		return req->height[CELL_INDEX(x, z)];
+
+	// real chunks close the gap
+	if(far_cell_loaded(req, x, z))
+		return h;
+
+	return h > SKIRT_DEPTH ? h - SKIRT_DEPTH : 0;
+}
+
+static size_t far_mesher_sides(struct far_mesher_rpc* req,
+							   struct displaylist* d, int x, int z) {
+	int h = req->height[CELL_INDEX(x, z)];
+	uint8_t tex = req->texture[CELL_INDEX(x, z)];
+	int x0 = x * CELL_SIZE, x1 = x0 + CELL_SIZE;
+	int z0 = z * CELL_SIZE, z1 = z0 + CELL_SIZE;
+	size_t quads = 0;
+	int b;
+
+	if((b = far_side_bottom(req, x - 1, z, h)) < h) {
+		far_vertex(d, x0, b, z0, 0x0D, tex);
+		far_vertex(d, x0, h, z0, 0x0D, tex);
+		far_vertex(d, x0, h, z1, 0x0D, tex);
+		far_vertex(d, x0, b, z1, 0x0D, tex);
+		quads++;
+	}
+
+	if((b = far_side_bottom(req, x + 1, z, h)) < h) {
+		far_vertex(d, x1, b, z0, 0x0D, tex);
+		far_vertex(d, x1, b, z1, 0x0D, tex);
+		far_vertex(d, x1, h, z1, 0x0D, tex);
+		far_vertex(d, x1, h, z0, 0x0D, tex);
+		quads++;
+	}
+
+	if((b = far_side_bottom(req, x, z - 1, h)) < h) {
+		far_vertex(d, x0, b, z0, 0x0C, tex);
+		far_vertex(d, x1, b, z0, 0x0C, tex);
+		far_vertex(d, x1, h, z0, 0x0C, tex);
+		far_vertex(d, x0, h, z0, 0x0C, tex);
+		quads++;
+	}
+
+	if((b = far_side_bottom(req, x, z + 1, h)) < h) {
+		far_vertex(d, x0, b, z1, 0x0C, tex);
+		far_vertex(d, x0, h, z1, 0x0C, tex);
+		far_vertex(d, x1, h, z1, 0x0C, tex);
+		far_vertex(d, x1, b, z1, 0x0C, tex);
+		quads++;
+	}
+
+	return quads;
+}
+
+static void far_mesher_build(struct far_mesher_rpc* req) {
+	displaylist_reset(&far_scratch);
+	size_t quads = 0;
+
+	for(int z = 0; z < TILE_CELLS; z++) {
+		int x = 0;
+
+		while(x < TILE_CELLS) {
+			if(!far_cell_visible(req, x, z)) {
+				x++;
+				continue;
+			}
+
+			int h = req->height[CELL_INDEX(x, z)];
+			uint8_t tex = req->texture[CELL_INDEX(x, z)];
+			int start = x;
+
+			// merge runs of equal top faces into one quad
+			while(x < TILE_CELLS && far_cell_visible(req, x, z)
+				  && req->height[CELL_INDEX(x, z)] == h
+				  && req->texture[CELL_INDEX(x, z)] == tex) {
+				quads += far_mesher_sides(req, &far_scratch, x, z);
+				x++;
+			}
+
+			far_vertex(&far_scratch, start * CELL_SIZE, h, z * CELL_SIZE, 0x0F,
+					   tex);
+			far_vertex(&far_scratch, x * CELL_SIZE, h, z * CELL_SIZE, 0x0F,
+					   tex);
+			far_vertex(&far_scratch, x * CELL_SIZE, h, (z + 1) * CELL_SIZE,
+					   0x0F, tex);
+			far_vertex(&far_scratch, start * CELL_SIZE, h, (z + 1) * CELL_SIZE,
+					   0x0F, tex);
+			quads++;
+		}
+	}
+
+	req->has_mesh = quads > 0;
+
+	if(req->has_mesh)
+		displaylist_finalize_from(&req->mesh, &far_scratch, quads * 4);
+}
+
+static void* far_mesher_thread(void* user) {
+	while(1) {
+		struct far_mesher_rpc* request;
+		tchannel_receive(&far_requests, (void**)&request, true);
+		far_mesher_build(request);
+		tchannel_send(&far_results, request, true);
+	}
+
+	return NULL;
+}
+
+void far_terrain_init(float distance) {
+	far_distance = distance;
+	far_version = 0;
+	dict_far_tile_init(tiles);
+
+	if(far_distance <= 0)
+		return;
+
+	displaylist_init(&far_scratch, 256, 3 * 2 + 2 * 1 + 1);
+
+	tchannel_init(&far_requests, FAR_TERRAIN_QLENGTH);
+	tchannel_init(&far_results, FAR_TERRAIN_QLENGTH);
+	tchannel_init(&far_empty_msg, FAR_TERRAIN_QLENGTH);
+
+	for(int k = 0; k < FAR_TERRAIN_QLENGTH; k++)
+		tchannel_send(&far_empty_msg, rpc_msg + k, true);
+
+	struct thread t;
+	thread_create(&t, far_mesher_thread, NULL, 2);
+}
+
+static void far_tile_destroy(struct far_tile* t) {
+	assert(t);
+
+	if(t->has_mesh)
+		displaylist_destroy(&t->mesh);
+
+	free(t);
+}
+
+void far_terrain_reset() {
+	dict_far_tile_it_t it;
+	dict_far_tile_it(it, tiles);
+
+	while(!dict_far_tile_end_p(it)) {
+		far_tile_destroy(dict_far_tile_ref(it)->value);
+		dict_far_tile_next(it);
+	}
+
+	dict_far_tile_reset(tiles);
+}
+
+static struct far_tile* far_tile_get(w_coord_t tx, w_coord_t tz) {
+	struct far_tile** t = dict_far_tile_get(tiles, SECTION_TO_ID(tx, tz));
+
+	if(t)
+		return *t;
+
+	struct far_tile* tile = malloc(sizeof(struct far_tile));
+
+	if(!tile)
+		return NULL;
+
+	tile->x = tx;
+	tile->z = tz;
+	memset(tile->height, 0, sizeof(tile->height));
+	tile->loaded = 0;
+	tile->version = ++far_version;
+	tile->mesh_version = 0;
+	tile->meshing = false;
+	tile->has_mesh = false;
+
+	dict_far_tile_set_at(tiles, SECTION_TO_ID(tx, tz), tile);
+	return tile;
+}
+
+// keeps a coarse copy of a section that is about to be unloaded
+void far_terrain_record(struct world* w, w_coord_t x, w_coord_t z) {
+	assert(w);
+
+	if(far_distance <= 0)
+		return;
+
+	struct world_section* s
+		= dict_wsection_get(w->sections, SECTION_TO_ID(x, z));
+	struct far_tile* t = far_tile_get(SECTION_TILE(x), SECTION_TILE(z));
+
+	if(!s || !t)
+		return;
+
+	int ox = (x - t->x * TILE_SECTIONS) * SECTION_CELLS;
+	int oz = (z - t->z * TILE_SECTIONS) * SECTION_CELLS;
+
+	for(int cz = 0; cz < SECTION_CELLS; cz++) {
+		for(int cx = 0; cx < SECTION_CELLS; cx++) {
+			int h = 0, hx = 0, hz = 0;
+
+			// highest column of the cell stands in for it
+			for(int bz = cz * CELL_SIZE; bz < (cz + 1) * CELL_SIZE; bz++) {
+				for(int bx = cx * CELL_SIZE; bx < (cx + 1) * CELL_SIZE; bx++) {
+					if(s->heightmap[bx + bz * CHUNK_SIZE] > h) {
+						h = s->heightmap[bx + bz * CHUNK_SIZE];
+						hx = bx;
+						hz = bz;
+					}
+				}
+			}
+
+			size_t idx = CELL_INDEX(ox + cx, oz + cz);
+			t->height[idx] = 0;
+
+			if(h == 0)
+				continue;
+
+			w_coord_t wx = x * CHUNK_SIZE + hx;
+			w_coord_t wz = z * CHUNK_SIZE + hz;
+			struct block_data blk = world_get_block(w, wx, h - 1, wz);
+
+			if(!blocks[blk.type])
+				continue;
+
+			struct block_data neighbours[6];
+			for(int k = 0; k < SIDE_MAX; k++) {
+				int nx, ny, nz;
+				blocks_side_offset((enum side)k, &nx, &ny, &nz);
+				neighbours[k]
+					= world_get_block(w, wx + nx, h - 1 + ny, wz + nz);
+			}
+
+			t->height[idx] = h;
+			t->texture[idx]
+				= blocks[blk.type]->getTextureIndex(&(struct block_info) {
+					.block = &blk,
+					.neighbours = neighbours,
+					.x = wx,
+					.y = h - 1,
+					.z = wz,
+				}, SIDE_TOP);
+		}
+	}
+
+	t->version = ++far_version;
+}
+
+void far_terrain_section(w_coord_t x, w_coord_t z, bool loaded) {
+	if(far_distance <= 0)
+		return;
+
+	struct far_tile* t = far_tile_get(SECTION_TILE(x), SECTION_TILE(z));
+
+	if(!t)
+		return;
+
+	uint16_t bit = 1 << ((x - t->x * TILE_SECTIONS)
+						 + (z - t->z * TILE_SECTIONS) * TILE_SECTIONS);
+	uint16_t prev = t->loaded;
+	t->loaded = loaded ? (t->loaded | bit) : (t->loaded & ~bit);
+
+	if(t->loaded != prev)
+		t->version = ++far_version;
+}
+
+static float far_tile_distance2(struct far_tile* t, float x, float z) {
+	return glm_vec2_distance2((vec2) {t->x * TILE_SIZE + TILE_SIZE / 2,
+									  t->z * TILE_SIZE + TILE_SIZE / 2},
+							  (vec2) {x, z});
+}
+
+void far_terrain_update(float x, float z) {
+	if(far_distance <= 0)
+		return;
+
+	struct far_mesher_rpc* result;
+	while(tchannel_receive(&far_results, (void**)&result, false)) {
+		struct far_tile** t = dict_far_tile_get(tiles, result->id);
+
+		if(t && (*t)->version == result->version) {
+			if((*t)->has_mesh)
+				displaylist_destroy(&(*t)->mesh);
+
+			(*t)->mesh = result->mesh;
+			(*t)->has_mesh = result->has_mesh;
+			(*t)->mesh_version = result->version;
+		} else if(result->has_mesh) {
+			displaylist_destroy(&result->mesh);
+		}
+
+		if(t)
+			(*t)->meshing = false;
+
+		tchannel_send(&far_empty_msg, result, true);
+	}
+
+	bool has_stale = false;
+	int64_t stale_id;
+
+	dict_far_tile_it_t it;
+	dict_far_tile_it(it, tiles);
+
+	while(!dict_far_tile_end_p(it)) {
+		struct far_tile* t = dict_far_tile_ref(it)->value;
+		float d = far_tile_distance2(t, x, z);
+
+		if(d > glm_pow2(far_distance * 2) && !t->meshing && !t->loaded) {
+			has_stale = true;
+			stale_id = dict_far_tile_ref(it)->key;
+		} else if(d <= glm_pow2(far_distance + TILE_SIZE)
+				  && t->version != t->mesh_version && !t->meshing) {
+			struct far_mesher_rpc* request;
+			if(tchannel_receive(&far_empty_msg, (void**)&request, false)) {
+				request->id = dict_far_tile_ref(it)->key;
+				request->version = t->version;
+				request->loaded = t->loaded;
+				memcpy(request->height, t->height, sizeof(t->height));
+				memcpy(request->texture, t->texture, sizeof(t->texture));
+				t->meshing = true;
+				tchannel_send(&far_requests, request, true);
+			}
+		}
+
+		dict_far_tile_next(it);
+	}
+
+	// forget one tile far behind per frame
+	if(has_stale) {
+		far_tile_destroy(*dict_far_tile_get(tiles, stale_id));
+		dict_far_tile_erase(tiles, stale_id);
+	}
+}
+
+// draws behind the chunks, at the end of the opaque pass of world_render()
+size_t far_terrain_render(struct camera* c) {
+	assert(c);
+
+	if(far_distance <= 0)
+		return 0;
+
+	size_t count = 0;
+
+	gfx_bind_texture(&texture_terrain);
+	gfx_fog(true);
+
+	dict_far_tile_it_t it;
+	dict_far_tile_it(it, tiles);
+
+	while(!dict_far_tile_end_p(it)) {
+		struct far_tile* t = dict_far_tile_ref(it)->value;
+		w_coord_t tx = t->x * TILE_SIZE, tz = t->z * TILE_SIZE;
+
+		if(t->has_mesh
+		   && far_tile_distance2(t, c->x, c->z)
+			   <= glm_pow2(far_distance + TILE_SIZE)
+		   && glm_aabb_frustum(
+			   (vec3[2]) {{tx, 0, tz},
+						  {tx + TILE_SIZE, WORLD_HEIGHT, tz + TILE_SIZE}},
+			   c->frustum_planes)) {
+			mat4 model_view;
+			glm_translate_to(c->view, (vec3) {tx, TILE_BASE_Y, tz},
+							 model_view);
+			gfx_matrix_modelview(model_view);
+			gfx_fog_pos(tx - c->x, tz - c->z, far_distance / FOG_DIST_SCALE);
+			displaylist_render(&t->mesh);
+			count++;
+		}
+
+		dict_far_tile_next(it);
+	}
+
+	return count;
+}
@@ -0,0 +1,45 @@
+/*
+	Copyright (c) 2023 ByteBit/xtreme8000
+
+	This file is part of CavEX.
+
+	CavEX is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	CavEX is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with CavEX.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef FAR_TERRAIN_H
+#define FAR_TERRAIN_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "game/camera.h"
+#include "world.h"
+
+// default for "far_terrain.distance" in blocks, 0 turns it off
+#ifdef PLATFORM_WII
+#define FAR_TERRAIN_DISTANCE 256
+#else
+#define FAR_TERRAIN_DISTANCE 512
+#endif
+
+#define FAR_TERRAIN_QLENGTH 4
+
+void far_terrain_init(float distance);
+void far_terrain_reset(void);
+void far_terrain_record(struct world* w, w_coord_t x, w_coord_t z);
+void far_terrain_section(w_coord_t x, w_coord_t z, bool loaded);
+void far_terrain_update(float x, float z);
+size_t far_terrain_render(struct camera* c);
+
+#endif
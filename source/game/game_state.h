@@ -46,11 +46,18 @@ struct game_state {
 		float dt, fps;
 		float dt_gpu, dt_vsync;
 		size_t chunks_rendered;
+		size_t chunks_occluded;
+		size_t upload_bytes;
+		size_t mesh_bytes;
+		float startup, startup_gfx;
 	} stats;
 	struct {
 		float fov;
 		float render_distance;
 		float fog_distance;
+		float far_distance;
+		size_t mesh_budget;
+		bool occlusion_culling;
 	} config;
 	struct screen* current_screen;
 	struct camera camera;
@@ -413,7 +413,7 @@ static void screen_ingame_update(struct screen* s, float dt) {
 }
 
 static void screen_ingame_render2D(struct screen* s, int width, int height) {
-	char str[64];
+	char str[96];
 #ifndef NDEBUG
 
 	sprintf(str, GAME_NAME " Alpha %i.%i.%i_f%i (impl. B1.7.3)", VERSION_MAJOR,
@@ -421,12 +421,17 @@ static void screen_ingame_render2D(struct screen* s, int width, int height) {
 	gutil_text(4, 4 + (GFX_GUI_SCALE * 8 + 1) * 0, str, GFX_GUI_SCALE * 8, true);
 
 
-	sprintf(str, "%0.1f fps, wait: gpu %0.1fms, vsync %0.1fms",
+	sprintf(str,
+			"%0.1f fps, wait: gpu %0.1fms, vsync %0.1fms, startup %0.0fms "
+			"(gfx %0.0fms)",
 			gstate.stats.fps, gstate.stats.dt_gpu * 1000.0F,
-			gstate.stats.dt_vsync * 1000.0F);
+			gstate.stats.dt_vsync * 1000.0F, gstate.stats.startup * 1000.0F,
+			gstate.stats.startup_gfx * 1000.0F);
 	gutil_text(4, 4 + (GFX_GUI_SCALE * 8 + 1) * 1, str, GFX_GUI_SCALE * 8, true);
 
-	sprintf(str, "%zu chunks", gstate.stats.chunks_rendered);
+	sprintf(str, "%zu chunks (%zu occluded), meshes %zu KiB, upload %zu KiB",
+			gstate.stats.chunks_rendered, gstate.stats.chunks_occluded,
+			gstate.stats.mesh_bytes / 1024, gstate.stats.upload_bytes / 1024);
 	gutil_text(4, 4 + (GFX_GUI_SCALE * 8 + 1) * 2, str, GFX_GUI_SCALE * 8, true);
 
 	sprintf(str, "(%0.1f, %0.1f, %0.1f) (%0.1f, %0.1f)", gstate.camera.x,
@@ -521,15 +526,18 @@ sprintf(str, "time: %.0f (%.0f)  angle: %.3f", time, day_ticks, angle);
 	icon_offset += gutil_control_icon(icon_offset, IB_HOME, "Pause");
 
 	// draw hotbar
-	gfx_bind_texture(&texture_gui2);
+	gutil_layer(GUTIL_LAYER_PANEL);
+	gutil_bind_texture(&texture_gui2);
 	gutil_texquad((width - 182 * GFX_GUI_SCALE) / 2, height - (GFX_GUI_SCALE * 16) * 8 / 5 - 22 * GFX_GUI_SCALE, 0, 0,
 				  182, 22, 182 * GFX_GUI_SCALE, 22 * GFX_GUI_SCALE);
 
-	gfx_blending(MODE_INVERT);
+	gutil_blending(MODE_INVERT);
 	gutil_texquad((width - 16 * GFX_GUI_SCALE) / 2, (height - 16 * GFX_GUI_SCALE) / 2, 0, 229, GFX_GUI_SCALE, GFX_GUI_SCALE,
 				  16 * GFX_GUI_SCALE, 16 * GFX_GUI_SCALE);
 
-	gfx_blending(MODE_OFF);
+	gutil_blending(MODE_OFF);
+
+	gutil_layer(GUTIL_LAYER_ITEMS);
 
 	for(int k = 0; k < INVENTORY_SIZE_HOTBAR; k++) {
 		struct item_data item;
@@ -540,8 +548,9 @@ sprintf(str, "time: %.0f (%.0f)  angle: %.3f", time, day_ticks, angle);
 							height - (GFX_GUI_SCALE * 16) * 8 / 5 - 19 * GFX_GUI_SCALE, 0);
 	}
 
-	gfx_blending(MODE_BLEND);
-	gfx_bind_texture(&texture_gui2);
+	gutil_layer(GUTIL_LAYER_OVERLAY);
+	gutil_blending(MODE_BLEND);
+	gutil_bind_texture(&texture_gui2);
 
 	// draw hotbar selection
 	gutil_texquad((width - 182 * GFX_GUI_SCALE) / 2 - 2
@@ -212,15 +212,17 @@ static void screen_inventory_render2D(struct screen* s, int width, int height) {
 		= windowc_get_latest(gstate.windows[WINDOWC_INVENTORY]);
 
 	// darken background
-	gfx_texture(false);
+	gutil_layer(GUTIL_LAYER_BACKGROUND);
+	gutil_texture(false);
 	gutil_texquad_col(0, 0, 0, 0, 0, 0, width, height, 0, 0, 0, 180);
-	gfx_texture(true);
+	gutil_texture(true);
 
 	int off_x = (width - GUI_WIDTH * GFX_GUI_SCALE) / 2;
 	int off_y = (height - GUI_HEIGHT * GFX_GUI_SCALE) / 2;
 
 	// draw inventory
-	gfx_bind_texture(&texture_gui_inventory);
+	gutil_layer(GUTIL_LAYER_PANEL);
+	gutil_bind_texture(&texture_gui_inventory);
 	gutil_texquad(off_x, off_y, 0, 0, GUI_WIDTH, GUI_HEIGHT, GUI_WIDTH * GFX_GUI_SCALE,
 				  GUI_HEIGHT * GFX_GUI_SCALE);
 	gutil_text(off_x + 86 * GFX_GUI_SCALE, off_y + 16 * GFX_GUI_SCALE, "\2478Crafting", 8 * GFX_GUI_SCALE, false);
@@ -246,6 +248,8 @@ static void screen_inventory_render2D(struct screen* s, int width, int height) {
 		glm_rotate_y(view, angle_x * 0.5F, view);
 		glm_translate(view, (vec3) {0.0F, 10.0F, 0.0F});
 
+		// model is drawn immediately, on top of the panel
+		gutil_batch_flush();
 		gfx_write_buffers(true, true, true);
 		struct item_data held_item, helmet, chestplate, leggings, boots;
 		render_model_player(
@@ -266,6 +270,7 @@ static void screen_inventory_render2D(struct screen* s, int width, int height) {
 	#endif
 
 	// draw items
+	gutil_layer(GUTIL_LAYER_ITEMS);
 	for(size_t k = 0; k < slots_index; k++) {
 		struct item_data item;
 		if((selected_slot != k || !inventory_get_picked_item(inv, NULL)
@@ -274,7 +279,8 @@ static void screen_inventory_render2D(struct screen* s, int width, int height) {
 			gutil_draw_item(&item, off_x + slots[k].x, off_y + slots[k].y, 1);
 	}
 
-	gfx_bind_texture(&texture_gui2);
+	gutil_layer(GUTIL_LAYER_OVERLAY);
+	gutil_bind_texture(&texture_gui2);
 
 	gutil_texquad(off_x + selection->x - (4 * GFX_GUI_SCALE), off_y + selection->y - (4 * GFX_GUI_SCALE), 208, 0,
 				  24, 24, 24 * GFX_GUI_SCALE, 24 * GFX_GUI_SCALE);
@@ -297,6 +303,8 @@ static void screen_inventory_render2D(struct screen* s, int width, int height) {
 
 	struct item_data item;
 	if(inventory_get_picked_item(inv, &item)) {
+		gutil_layer(GUTIL_LAYER_HELD_ITEM);
+
 		if(pointer_available && pointer_has_item) {
 			gutil_draw_item(&item, pointer_x - 8 * GFX_GUI_SCALE, pointer_y - 8 * GFX_GUI_SCALE, 0);
 		} else {
@@ -305,21 +313,23 @@ static void screen_inventory_render2D(struct screen* s, int width, int height) {
 		}
 	} else if(inventory_get_slot(inv, selection->slot, &item)) {
 		char* tmp = item_get(&item) ? item_get(&item)->name : "Unknown";
-		gfx_blending(MODE_BLEND);
-		gfx_texture(false);
+		gutil_layer(GUTIL_LAYER_TOOLTIP);
+		gutil_blending(MODE_BLEND);
+		gutil_texture(false);
 		gutil_texquad_col(off_x + selection->x - 2 * GFX_GUI_SCALE + 8 * GFX_GUI_SCALE 
 							  - gutil_font_width(tmp, 8 * GFX_GUI_SCALE) / 2,
 						  off_y + selection->y - 2 * GFX_GUI_SCALE + 23 * GFX_GUI_SCALE, 0, 0, 0, 0,
 						  gutil_font_width(tmp, 8 * GFX_GUI_SCALE) + 7, 12 * GFX_GUI_SCALE, 0, 0, 0, 180);
-		gfx_texture(true);
-		gfx_blending(MODE_OFF);
+		gutil_texture(true);
+		gutil_blending(MODE_OFF);
 
 		gutil_text(off_x + selection->x + 8 * GFX_GUI_SCALE - gutil_font_width(tmp, 8 * GFX_GUI_SCALE) / 2,
 				   off_y + selection->y + 23 * GFX_GUI_SCALE, tmp, 8 * GFX_GUI_SCALE, false);
 	}
 
 	if(pointer_available) {
-		gfx_bind_texture(&texture_pointer);
+		gutil_layer(GUTIL_LAYER_POINTER);
+		gutil_bind_texture(&texture_pointer);
 		gutil_texquad_rt_any(pointer_x, pointer_y, glm_rad(pointer_angle), 0, 0,
 							 256, 256, 48 * GFX_GUI_SCALE, 48 * GFX_GUI_SCALE);
 	}
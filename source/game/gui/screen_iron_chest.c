@@ -226,15 +226,17 @@ static void screen_iron_chest_render2D(struct screen* s, int width, int height)
 		= windowc_get_latest(gstate.windows[iron_chest_container]);
 
 	// darken background
-	gfx_texture(false);
+	gutil_layer(GUTIL_LAYER_BACKGROUND);
+	gutil_texture(false);
 	gutil_texquad_col(0, 0, 0, 0, 0, 0, width, height, 0, 0, 0, 180);
-	gfx_texture(true);
+	gutil_texture(true);
 
 	int off_x = (width - GUI_WIDTH * GFX_GUI_SCALE) / 2;
 	int off_y = (height - GUI_HEIGHT * GFX_GUI_SCALE) / 2;
 
 	// draw inventory
-	gfx_bind_texture(&texture_gui_iron_chest);
+	gutil_layer(GUTIL_LAYER_PANEL);
+	gutil_bind_texture(&texture_gui_iron_chest);
 	gutil_texquad(off_x, off_y, 0, 0, GUI_WIDTH, GUI_HEIGHT, GUI_WIDTH * GFX_GUI_SCALE,
 				  GUI_HEIGHT * GFX_GUI_SCALE);
 	gutil_text(off_x + 28 * GFX_GUI_SCALE, off_y + 6 * GFX_GUI_SCALE, "\2478Iron Chest", 8 * GFX_GUI_SCALE, false);
@@ -242,6 +244,7 @@ static void screen_iron_chest_render2D(struct screen* s, int width, int height)
 	struct inv_slot* selection = slots + selected_slot;
 
 	// draw items
+	gutil_layer(GUTIL_LAYER_ITEMS);
 	for(size_t k = 0; k < slots_index; k++) {
 		struct item_data item;
 		if((selected_slot != k || !inventory_get_picked_item(inv, NULL)
@@ -250,7 +253,8 @@ static void screen_iron_chest_render2D(struct screen* s, int width, int height)
 			gutil_draw_item(&item, off_x + slots[k].x, off_y + slots[k].y, 1);
 	}
 
-	gfx_bind_texture(&texture_gui2);
+	gutil_layer(GUTIL_LAYER_OVERLAY);
+	gutil_bind_texture(&texture_gui2);
 
 	gutil_texquad(off_x + selection->x - 4 * GFX_GUI_SCALE, off_y + selection->y - 4 * GFX_GUI_SCALE, 208, 0,
 				  24, 24, 24 * GFX_GUI_SCALE, 24 * GFX_GUI_SCALE);
@@ -271,6 +275,8 @@ static void screen_iron_chest_render2D(struct screen* s, int width, int height)
 
 	struct item_data item;
 	if(inventory_get_picked_item(inv, &item)) {
+		gutil_layer(GUTIL_LAYER_HELD_ITEM);
+
 		if(pointer_available && pointer_has_item) {
 			gutil_draw_item(&item, pointer_x - 8 * GFX_GUI_SCALE, pointer_y - 8 * GFX_GUI_SCALE, 0);
 		} else {
@@ -279,21 +285,23 @@ static void screen_iron_chest_render2D(struct screen* s, int width, int height)
 		}
 	} else if(inventory_get_slot(inv, selection->slot, &item)) {
 		char* tmp = item_get(&item) ? item_get(&item)->name : "Unknown";
-		gfx_blending(MODE_BLEND);
-		gfx_texture(false);
+		gutil_layer(GUTIL_LAYER_TOOLTIP);
+		gutil_blending(MODE_BLEND);
+		gutil_texture(false);
 		gutil_texquad_col(off_x + selection->x - 2 * GFX_GUI_SCALE + 8 * GFX_GUI_SCALE
 							  - gutil_font_width(tmp, 8 * GFX_GUI_SCALE) / 2,
 						  off_y + selection->y - 2 * GFX_GUI_SCALE + 23 * GFX_GUI_SCALE, 0, 0, 0, 0,
 						  gutil_font_width(tmp, 8 * GFX_GUI_SCALE) + 7, 12 * GFX_GUI_SCALE, 0, 0, 0, 180);
-		gfx_texture(true);
-		gfx_blending(MODE_OFF);
+		gutil_texture(true);
+		gutil_blending(MODE_OFF);
 
 		gutil_text(off_x + selection->x + 8 * GFX_GUI_SCALE - gutil_font_width(tmp, 8 * GFX_GUI_SCALE) / 2,
 				   off_y + selection->y + 23 * GFX_GUI_SCALE, tmp, 8 * GFX_GUI_SCALE, false);
 	}
 
 	if(pointer_available) {
-		gfx_bind_texture(&texture_pointer);
+		gutil_layer(GUTIL_LAYER_POINTER);
+		gutil_bind_texture(&texture_pointer);
 		gutil_texquad_rt_any(pointer_x, pointer_y, glm_rad(pointer_angle), 0, 0,
 							 256, 256, 48 * GFX_GUI_SCALE, 48 * GFX_GUI_SCALE);
 	}
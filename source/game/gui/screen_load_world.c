@@ -53,12 +53,12 @@ static void screen_lworld_render2D(struct screen* s, int width, int height) {
 	float progress
 		= fminf((float)world_loaded_chunks(&gstate.world) / MAX_CHUNKS, 1.0F);
 
-	gfx_texture(false);
+	gutil_texture(false);
 	gutil_texquad_col((width - 100 * GFX_GUI_SCALE) / 2, height / 2 + 16 * GFX_GUI_SCALE, 0, 0, 0, 0, 100 * GFX_GUI_SCALE, 2 * GFX_GUI_SCALE,
 					  128, 128, 128, 255);
 	gutil_texquad_col((width - 100 * GFX_GUI_SCALE) / 2, height / 2 + 16 * GFX_GUI_SCALE, 0, 0, 0, 0,
 					  100 * GFX_GUI_SCALE * progress, 2 * GFX_GUI_SCALE, 128, 255, 128, 255);
-	gfx_texture(true);
+	gutil_texture(true);
 }
 
 struct screen screen_load_world = {
@@ -67,9 +67,9 @@ static void screen_pause_update(struct screen* s, float dt) {
 
 static void screen_pause_render2D(struct screen* s, int width, int height) {
 	// darken background
-	gfx_texture(false);
+	gutil_texture(false);
 	gutil_texquad_col(0, 0, 0, 0, 0, 0, width, height, 0, 0, 0, 180);
-	gfx_texture(true);
+	gutil_texture(true);
 
 	gutil_text(4, 4 + (GFX_GUI_SCALE * 8 + 1) * 0, "PAUSED", GFX_GUI_SCALE * 8, true);
 
@@ -23,6 +23,7 @@
 #include "../../network/server_interface.h"
 #include "../../platform/gfx.h"
 #include "../../platform/input.h"
+#include "../../platform/thread.h"
 #include "../../stack.h"
 #include "../../util.h"
 #include "../game_state.h"
@@ -53,19 +54,104 @@ struct world_option {
 	int64_t byte_size;
 };
 
+// one per save found, the last one has done set and no option
+struct world_scan_msg {
+	bool done;
+	struct world_option opt;
+};
+
+static struct thread_channel scan_results;
+static struct thread scan_thread;
+static bool scan_init = false;
+static bool scanning = false;
+
+static void world_option_clear(struct world_option* opt) {
+	string_clear(opt->name);
+	string_clear(opt->directory);
+	string_clear(opt->path);
+}
+
+static void* screen_sworld_scan(void* user) {
+	char* saves_path = user;
+	DIR* d = opendir(saves_path);
+
+	if(d) {
+		struct dirent* dir;
+		while((dir = readdir(d))) {
+			if(dir->d_type & DT_DIR && *dir->d_name != '.') {
+				struct world_scan_msg* msg
+					= malloc(sizeof(struct world_scan_msg));
+
+				if(!msg)
+					break;
+
+				struct level_summary summary;
+				string_init_printf(msg->opt.path, "%s/%s", saves_path,
+								   dir->d_name);
+
+				if(level_archive_summary(msg->opt.path, &summary)) {
+					msg->done = false;
+					string_init_set_str(msg->opt.name, summary.name);
+					string_init_set_str(msg->opt.directory, dir->d_name);
+					msg->opt.byte_size = summary.disk_size;
+					msg->opt.last_access = summary.last_played / 1000;
+					tchannel_send(&scan_results, msg, true);
+				} else {
+					string_clear(msg->opt.path);
+					free(msg);
+				}
+			}
+		}
+
+		closedir(d);
+	}
+
+	struct world_scan_msg* msg = malloc(sizeof(struct world_scan_msg));
+	assert(msg);
+	msg->done = true;
+	tchannel_send(&scan_results, msg, true);
+
+	free(saves_path);
+	return NULL;
+}
+
+// moves finished entries into the list, blocks only to cancel a scan
+static void screen_sworld_receive(bool block) {
+	struct world_scan_msg* msg;
+
+	while(scanning && tchannel_receive(&scan_results, (void**)&msg, block)) {
+		if(msg->done) {
+			thread_join(&scan_thread);
+			scanning = false;
+		} else if(worlds && !block) {
+			stack_push(worlds, &msg->opt);
+		} else {
+			world_option_clear(&msg->opt);
+		}
+
+		free(msg);
+	}
+}
+
 static void screen_sworld_reset(struct screen* s, int width, int height) {
 	input_pointer_enable(true);
 
 	if(gstate.local_player)
 		gstate.local_player->data.local_player.capture_input = false;
 
+	if(!scan_init) {
+		tchannel_init(&scan_results, 8);
+		scan_init = true;
+	}
+
+	// a scan from last time could still be running
+	screen_sworld_receive(true);
+
 	if(worlds) {
 		while(!stack_empty(worlds)) {
 			struct world_option opt;
 			stack_pop(worlds, &opt);
-			string_clear(opt.name);
-			string_clear(opt.directory);
-			string_clear(opt.path);
+			world_option_clear(&opt);
 		}
 
 		stack_destroy(worlds);
@@ -76,47 +162,15 @@ static void screen_sworld_reset(struct screen* s, int width, int height) {
 	worlds = malloc(sizeof(struct stack));
 	stack_create(worlds, 8, sizeof(struct world_option));
 
-	const char* saves_path
+	const char* saves_config
 		= config_read_string(&gstate.config_user, "paths.worlds", "saves");
+	// owned by the scan thread
+	char* saves_path = malloc(strlen(saves_config) + 1);
 
-	DIR* d = opendir(saves_path);
-
-	if(d) {
-		struct dirent* dir;
-		while((dir = readdir(d))) {
-			if(dir->d_type & DT_DIR && *dir->d_name != '.') {
-				struct world_option opt;
-				string_init_printf(opt.path, "%s/%s", saves_path, dir->d_name);
-
-				struct level_archive la;
-				if(level_archive_create(&la, opt.path)) {
-					char name[64];
-
-					if(!level_archive_read(&la, LEVEL_NAME, name, sizeof(name)))
-						strcpy(name, "Missing name");
-
-					string_init_set_str(opt.name, name);
-					string_init_set_str(opt.directory, dir->d_name);
-
-					if(!level_archive_read(&la, LEVEL_DISK_SIZE, &opt.byte_size,
-										   0))
-						opt.byte_size = 0;
-
-					if(!level_archive_read(&la, LEVEL_LAST_PLAYED,
-										   &opt.last_access, 0))
-						opt.last_access = 0;
-
-					opt.last_access /= 1000;
-
-					level_archive_destroy(&la);
-					stack_push(worlds, &opt);
-				} else {
-					string_clear(opt.path);
-				}
-			}
-		}
-
-		closedir(d);
+	if(saves_path) {
+		strcpy(saves_path, saves_config);
+		scanning = true;
+		thread_create(&scan_thread, screen_sworld_scan, saves_path, 2);
 	}
 
 	gui_selection = 0;
@@ -127,10 +181,13 @@ static void screen_sworld_reset(struct screen* s, int width, int height) {
 }
 
 static void screen_sworld_update(struct screen* s, float dt) {
+	screen_sworld_receive(false);
+
 	if(input_pressed(IB_GUI_UP) && gui_selection > 0)
 		gui_selection--;
 
-	if(input_pressed(IB_GUI_DOWN) && gui_selection < stack_size(worlds) - 1)
+	// list may still be empty while the scan runs
+	if(input_pressed(IB_GUI_DOWN) && gui_selection + 1 < stack_size(worlds))
 		gui_selection++;
 
 	if(scroll_offset + (int)gui_selection * entry_height < 4)
@@ -158,16 +215,20 @@ static void screen_sworld_update(struct screen* s, float dt) {
 }
 
 static void screen_sworld_render2D(struct screen* s, int width, int height) {
+	gutil_layer(GUTIL_LAYER_BACKGROUND);
 	gutil_bg();
 
+	gutil_layer(GUTIL_LAYER_OVERLAY);
 	gutil_text((width - gutil_font_width("Select World", 8 * GFX_GUI_SCALE)) / 2,
 			   top_visible - 8 * GFX_GUI_SCALE * 1.5F, "Select World", 8 * GFX_GUI_SCALE, true);
 
-	gfx_texture(false);
+	gutil_layer(GUTIL_LAYER_PANEL);
+	gutil_texture(false);
 	gutil_texquad_col(0, top_visible, 0, 0, 0, 0, width, height_visible, 0, 0,
 					  0, 128);
-	gfx_texture(true);
+	gutil_texture(true);
 
+	gutil_batch_flush();
 	gfx_scissor(true, 0, top_visible, width, height_visible);
 
 	int offset = scroll_offset;
@@ -177,14 +238,17 @@ static void screen_sworld_render2D(struct screen* s, int width, int height) {
 		stack_at(worlds, &opt, idx);
 
 		if(gui_selection == idx) {
-			gfx_texture(false);
+			gutil_layer(GUTIL_LAYER_PANEL);
+			gutil_texture(false);
 			gutil_texquad_col((width - 220 * GFX_GUI_SCALE) / 2.0F, top_visible + offset, 0, 0,
 							  0, 0, 220 * GFX_GUI_SCALE, 36 * GFX_GUI_SCALE, 128, 128, 128, 255);
 			gutil_texquad_col((width - 218 * GFX_GUI_SCALE) / 2.0F, top_visible + GFX_GUI_SCALE + offset, 0,
 							  0, 0, 0, 218 * GFX_GUI_SCALE, 34 * GFX_GUI_SCALE, 0, 0, 0, 255);
-			gfx_texture(true);
+			gutil_texture(true);
 		}
 
+		gutil_layer(GUTIL_LAYER_OVERLAY);
+
 		gutil_text((width - 218 * GFX_GUI_SCALE) / 2.0F + 3 * GFX_GUI_SCALE, top_visible + 3 * GFX_GUI_SCALE + offset,
 				   (char*)string_get_cstr(opt.name), 8 * GFX_GUI_SCALE, true);
 
@@ -202,6 +266,7 @@ static void screen_sworld_render2D(struct screen* s, int width, int height) {
 		offset += entry_height;
 	}
 
+	gutil_batch_flush();
 	gfx_scissor(false, 0, 0, 0, 0);
 
 	int icon_offset = 16 * GFX_GUI_SCALE;
@@ -111,18 +111,22 @@ static void screen_sign_render2D(struct screen* s, int width, int height) {
 		= windowc_get_latest(gstate.windows[sign_container]);
 
 	// darken background
-	gfx_texture(false);
+	gutil_layer(GUTIL_LAYER_BACKGROUND);
+	gutil_texture(false);
 	gutil_texquad_col(0, 0, 0, 0, 0, 0, width, height, 0, 0, 0, 180);
-	gfx_texture(true);
+	gutil_texture(true);
 
 	int off_x = (width - GUI_WIDTH * GFX_GUI_SCALE) / 2;
 	int off_y = (height - GUI_HEIGHT * GFX_GUI_SCALE) / 2;
 
 	// draw sign texture
-	gfx_bind_texture(&texture_terrain);
+	gutil_layer(GUTIL_LAYER_PANEL);
+	gutil_bind_texture(&texture_terrain);
 	gutil_texquad(off_x, off_y, TEX_OFFSET(TEXTURE_X(tex_atlas_lookup(TEXAT_PLANKS))), TEX_OFFSET(TEXTURE_Y(tex_atlas_lookup(TEXAT_PLANKS))), 16, 16, GUI_WIDTH * GFX_GUI_SCALE, GUI_HEIGHT * GFX_GUI_SCALE);
 
 	// draw text
+	gutil_layer(GUTIL_LAYER_OVERLAY);
+
 	for(size_t k = 0; k < 64; k++) {
 		char str[2];
 		struct item_data chr;
@@ -145,7 +149,8 @@ static void screen_sign_render2D(struct screen* s, int width, int height) {
 	icon_offset += gutil_control_icon(icon_offset, IB_INVENTORY, "Leave");
 
 	if(pointer_available) {
-		gfx_bind_texture(&texture_pointer);
+		gutil_layer(GUTIL_LAYER_POINTER);
+		gutil_bind_texture(&texture_pointer);
 		gutil_texquad_rt_any(pointer_x, pointer_y, glm_rad(pointer_angle), 0, 0,
 							 256, 256, 48 * GFX_GUI_SCALE, 48 * GFX_GUI_SCALE);
 	}
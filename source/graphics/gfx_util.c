@@ -21,99 +21,96 @@
 
 #include "../daytime.h"
 #include "../game/game_state.h"
+#include "../platform/displaylist.h"
 #include "../platform/gfx.h"
+#include "../util.h"
 #include "gfx_util.h"
 
-static void gutil_render_stars(mat4 view_matrix, float time) {
-	float fade = 0.0f;
-	float day_ticks = fmodf(time, 24000.0f);
+#define STAR_COUNT 1000
+#define STAR_RADIUS 90.0F
+#define STAR_SIZE 0.2F
 
-	if (day_ticks > 13000.0f && day_ticks < 14000.0f)
-	    fade = (day_ticks - 13000.0f) / 1000.0f;  // fade-in
-	else if (day_ticks >= 14000.0f && day_ticks <= 22000.0f)
-	    fade = 1.0f;
-	else if (day_ticks > 22000.0f && day_ticks < 23000.0f)
-	    fade = (23000.0f - day_ticks) / 1000.0f;  // fade-out
+static struct displaylist stars_mesh;
+static bool stars_baked = false;
+
+static void gutil_bake_stars(void) {
+	// own generator, the star field must look the same every night
+	struct random_gen rnd = {.seed = 42};
+
+	displaylist_init(&stars_mesh, STAR_COUNT * 4, 3 * 2 + 2 * 1 + 1);
+
+	for(int k = 0; k < STAR_COUNT; k++) {
+		float theta = rand_gen_flt(&rnd) * GLM_PI * 2.0F;
+		float phi = rand_gen_flt(&rnd) * GLM_PI;
+
+		vec3 normal = {cosf(theta) * sinf(phi), cosf(phi),
+					   sinf(theta) * sinf(phi)};
+
+		// quad lies tangent to the sphere, so it faces the camera at its center
+		vec3 right, up;
+		glm_vec3_cross(fabsf(normal[1]) < 0.9F ? GLM_YUP : GLM_XUP, normal,
+					   right);
+		glm_vec3_normalize(right);
+		glm_vec3_cross(normal, right, up);
+
+		glm_vec3_scale(normal, STAR_RADIUS, normal);
+		glm_vec3_scale(right, STAR_SIZE, right);
+		glm_vec3_scale(up, STAR_SIZE, up);
+
+		for(int v = 0; v < 4; v++) {
+			float sr = (v == 1 || v == 2) ? 1.0F : -1.0F;
+			float su = (v < 2) ? 1.0F : -1.0F;
+
+			displaylist_pos(
+				&stars_mesh,
+				roundf((normal[0] + right[0] * sr + up[0] * su) * 256.0F),
+				roundf((normal[1] + right[1] * sr + up[1] * su) * 256.0F),
+				roundf((normal[2] + right[2] * sr + up[2] * su) * 256.0F));
+			displaylist_color(&stars_mesh, 0);
+			displaylist_texcoord(&stars_mesh, 0, 0);
+		}
+	}
+
+	displaylist_finalize(&stars_mesh, STAR_COUNT * 4);
+	stars_baked = true;
+}
+
+static float gutil_stars_fade(float time) {
+	float day_ticks = fmodf(time, 24000.0F);
+
+	if(day_ticks > 13000.0F && day_ticks < 14000.0F)
+		return (day_ticks - 13000.0F) / 1000.0F; // fade-in
+	else if(day_ticks >= 14000.0F && day_ticks <= 22000.0F)
+		return 1.0F;
+	else if(day_ticks > 22000.0F && day_ticks < 23000.0F)
+		return (23000.0F - day_ticks) / 1000.0F; // fade-out
 	else
-	    fade = 0.0f;
+		return 0.0F;
+}
 
-	float scale = 0.2f; // star size. 0.2 seems about right Bigger than this
+// expects the celestial modelview to be set already
+static void gutil_render_stars(float time) {
+	uint8_t star_alpha = (uint8_t)(gutil_stars_fade(time) * 255.0F);
 
-	uint8_t star_alpha = (uint8_t)(fade * 255.0f);
-	if (star_alpha == 0)
+	if(star_alpha == 0)
 		return;
 
+	if(!stars_baked)
+		gutil_bake_stars();
+
 	gfx_texture(false);
-	gfx_lighting(false);
+	gfx_lighting(true);
+	gfx_constant_color(true, 180, 190, 255, star_alpha);
 	gfx_blending(MODE_BLEND2);
 	gfx_alpha_test(false);
 	gfx_cull_func(MODE_NONE);
 
-	srand(42);
-
-	uint8_t star_r = 180;
-	uint8_t star_g = 190;
-	uint8_t star_b = 255;
-
-	for (int i = 0; i < 1000; i++) {
-	    float theta = glm_rad(rand() % 360);
-	    float phi = glm_rad(rand() % 180);
-	    float radius = 90.0f;
-
-	    float x = cosf(theta) * sinf(phi) * radius;
-	    float y = cosf(phi) * radius;
-	    float z = sinf(theta) * sinf(phi) * radius;
-
-	    vec3 pos = {x, y, z};
-
-	    // billboard-quads zoals bij particles
-	    float vertices[12];
-	    float texcoords[8] = {
-	        0.0f, 0.0f,
-	        1.0f, 0.0f,
-	        1.0f, 1.0f,
-	        0.0f, 1.0f
-	    };
-	    uint8_t colors[16] = {
-	        star_r, star_g, star_b, star_alpha,
-	        star_r, star_g, star_b, star_alpha,
-	        star_r, star_g, star_b, star_alpha,
-	        star_r, star_g, star_b, star_alpha
-	    };
-
-	    vec3 right = {
-	        view_matrix[0][0],
-	        view_matrix[1][0],
-	        view_matrix[2][0]
-	    };
-	    vec3 up = {
-	        view_matrix[0][1],
-	        view_matrix[1][1],
-	        view_matrix[2][1]
-	    };
-
-	    glm_vec3_scale(right, scale, right);
-	    glm_vec3_scale(up, scale, up);
-
-	    vec3 v0, v1, v2, v3;
-	    glm_vec3_sub(pos, right, v0); glm_vec3_add(v0, up, v0); // top-left
-	    glm_vec3_add(pos, right, v1); glm_vec3_add(v1, up, v1); // top-right
-	    glm_vec3_add(pos, right, v2); glm_vec3_sub(v2, up, v2); // bottom-right
-	    glm_vec3_sub(pos, right, v3); glm_vec3_sub(v3, up, v3); // bottom-left
-
-	    memcpy(vertices +  0, v0, sizeof(vec3));
-	    memcpy(vertices +  3, v1, sizeof(vec3));
-	    memcpy(vertices +  6, v2, sizeof(vec3));
-	    memcpy(vertices +  9, v3, sizeof(vec3));
-
-	    gfx_draw_quads_flt(4, vertices, colors, texcoords);
-	}
+	displaylist_render(&stars_mesh);
 
-	gfx_alpha_test(true);
-	gfx_blending(MODE_OFF);
-	gfx_texture(true);
 	gfx_cull_func(MODE_BACK);
-
+	gfx_constant_color(false, 0, 0, 0, 0);
+	gfx_lighting(false);
+	gfx_texture(true);
 }
 
 
@@ -277,10 +274,6 @@ void gutil_sky_box(mat4 view_matrix, float celestial_angle, vec3 color_top,
 	gfx_fog(false);
 	gfx_texture(true);
 
-	gutil_render_stars(view_matrix, daytime_get_time());
-
-	gfx_blending(MODE_BLEND2);
-
 	mat4 tmp;
 	glm_translate_to(view_matrix,
 					 (vec3) {gstate.camera.x, gstate.camera.y, gstate.camera.z},
@@ -288,6 +281,10 @@ void gutil_sky_box(mat4 view_matrix, float celestial_angle, vec3 color_top,
 	glm_rotate_x(tmp, glm_rad(celestial_angle * 360.0F), model_view);
 	gfx_matrix_modelview(model_view);
 
+	gutil_render_stars(daytime_get_time());
+
+	gfx_blending(MODE_BLEND2);
+
 	gfx_bind_texture(&texture_sun);
 	gfx_draw_quads(
 		4, (int16_t[]) {-30, 100, -30, -30, 100, 30, 30, 100, 30, 30, 100, -30},
@@ -22,9 +22,258 @@
 #include "../platform/gfx.h"
 #include "gui_util.h"
 #include "gfx_settings.h"
+#include "item_icons.h"
 #include "render_block.h"
 #include "texture_atlas.h"
 
+#define GUI_BATCH_QUADS 2048
+#define GUI_BATCH_ITEMS 128
+#define GUI_BATCH_GROUPS 48
+
+struct gui_state {
+	struct tex_gfx* tex;
+	bool texture;
+	enum gfx_blend blend;
+};
+
+// everything submitted to one layer with the same render state
+struct gui_group {
+	enum gutil_layer layer;
+	struct gui_state state;
+	bool items;
+	size_t offset, count;
+};
+
+struct gui_quad {
+	int16_t vertices[4 * 3];
+	uint8_t colors[4 * 4];
+	uint16_t texcoords[4 * 2];
+	size_t group;
+};
+
+struct gui_item {
+	struct item_data item;
+	int x, y, depth;
+	size_t group;
+};
+
+static struct {
+	bool active;
+	enum gutil_layer layer;
+	struct gui_state state;
+	struct gui_group groups[GUI_BATCH_GROUPS];
+	size_t groups_count;
+	struct gui_quad quads[GUI_BATCH_QUADS];
+	size_t quads_count;
+	struct gui_item items[GUI_BATCH_ITEMS];
+	size_t items_count;
+	int16_t vertices[GUI_BATCH_QUADS * 4 * 3];
+	uint8_t colors[GUI_BATCH_QUADS * 4 * 4];
+	uint16_t texcoords[GUI_BATCH_QUADS * 4 * 2];
+} batch;
+
+static void gutil_draw_item_labels(struct item_data* item, struct item* it,
+								   int x, int y);
+static void gutil_draw_item_now(struct item_data* item, int x, int y,
+								int layer);
+
+static bool gui_state_equal(struct gui_state* a, struct gui_state* b) {
+	return a->tex == b->tex && a->texture == b->texture
+		&& a->blend == b->blend;
+}
+
+static void gui_state_apply(struct gui_state* s) {
+	gfx_blending(s->blend);
+	gfx_texture(s->texture);
+
+	if(s->tex)
+		gfx_bind_texture(s->tex);
+}
+
+// returns NULL if the batch needs to be flushed first
+static struct gui_group* gui_batch_group(bool items) {
+	struct gui_state state = batch.state;
+
+	if(!state.texture)
+		state.tex = NULL;
+
+	for(size_t k = batch.groups_count; k > 0; k--) {
+		struct gui_group* g = batch.groups + k - 1;
+
+		if(g->layer == batch.layer && g->items == items
+		   && gui_state_equal(&g->state, &state))
+			return g;
+	}
+
+	if(batch.groups_count >= GUI_BATCH_GROUPS)
+		return NULL;
+
+	struct gui_group* g = batch.groups + batch.groups_count++;
+	*g = (struct gui_group) {
+		.layer = batch.layer,
+		.state = state,
+		.items = items,
+		.offset = 0,
+		.count = 0,
+	};
+
+	return g;
+}
+
+static void gutil_quads(size_t vertex_count, const int16_t* vertices,
+						const uint8_t* colors, const uint16_t* texcoords) {
+	assert(vertex_count % 4 == 0);
+	assert(vertices && colors && texcoords);
+
+	if(!batch.active) {
+		gfx_draw_quads(vertex_count, vertices, colors, texcoords);
+		return;
+	}
+
+	struct gui_group* g = gui_batch_group(false);
+
+	for(size_t k = 0; k < vertex_count / 4; k++) {
+		if(!g || batch.quads_count >= GUI_BATCH_QUADS) {
+			gutil_batch_flush();
+			g = gui_batch_group(false);
+			assert(g);
+		}
+
+		struct gui_quad* q = batch.quads + batch.quads_count++;
+		memcpy(q->vertices, vertices + k * 4 * 3, sizeof(q->vertices));
+		memcpy(q->colors, colors + k * 4 * 4, sizeof(q->colors));
+		memcpy(q->texcoords, texcoords + k * 4 * 2, sizeof(q->texcoords));
+		q->group = g - batch.groups;
+		g->count++;
+	}
+}
+
+void gutil_batch_begin() {
+	assert(!batch.active);
+
+	batch.groups_count = 0;
+	batch.quads_count = 0;
+	batch.items_count = 0;
+	batch.layer = GUTIL_LAYER_BACKGROUND;
+	batch.state = (struct gui_state) {
+		.tex = NULL,
+		.texture = true,
+		.blend = MODE_BLEND,
+	};
+
+	gui_state_apply(&batch.state);
+	batch.active = true;
+}
+
+void gutil_batch_flush() {
+	if(!batch.active)
+		return;
+
+	// items and text of replayed items are drawn immediately
+	batch.active = false;
+	struct gui_state state = batch.state;
+
+	// stable sort of groups by layer
+	size_t order[GUI_BATCH_GROUPS];
+	for(size_t k = 0; k < batch.groups_count; k++) {
+		size_t j = k;
+
+		while(j > 0 && batch.groups[order[j - 1]].layer > batch.groups[k].layer) {
+			order[j] = order[j - 1];
+			j--;
+		}
+
+		order[j] = k;
+	}
+
+	size_t offset = 0;
+	for(size_t k = 0; k < batch.groups_count; k++) {
+		struct gui_group* g = batch.groups + order[k];
+		g->offset = offset;
+		offset += g->count;
+		g->count = 0;
+	}
+
+	// make quads of each group contiguous
+	for(size_t k = 0; k < batch.quads_count; k++) {
+		struct gui_quad* q = batch.quads + k;
+		struct gui_group* g = batch.groups + q->group;
+		size_t idx = g->offset + g->count++;
+
+		memcpy(batch.vertices + idx * 4 * 3, q->vertices, sizeof(q->vertices));
+		memcpy(batch.colors + idx * 4 * 4, q->colors, sizeof(q->colors));
+		memcpy(batch.texcoords + idx * 4 * 2, q->texcoords,
+			   sizeof(q->texcoords));
+	}
+
+	struct gui_state* applied = NULL;
+
+	for(size_t k = 0; k < batch.groups_count; k++) {
+		struct gui_group* g = batch.groups + order[k];
+
+		if(g->items) {
+			for(size_t i = 0; i < batch.items_count; i++) {
+				struct gui_item* it = batch.items + i;
+
+				if(it->group == order[k]) {
+					gui_state_apply(&g->state);
+					gutil_draw_item_now(&it->item, it->x, it->y, it->depth);
+				}
+			}
+
+			applied = NULL;
+		} else if(g->count > 0) {
+			if(!applied || !gui_state_equal(applied, &g->state))
+				gui_state_apply(&g->state);
+
+			applied = &g->state;
+			gfx_draw_quads(g->count * 4, batch.vertices + g->offset * 4 * 3,
+						   batch.colors + g->offset * 4 * 4,
+						   batch.texcoords + g->offset * 4 * 2);
+		}
+	}
+
+	batch.groups_count = 0;
+	batch.quads_count = 0;
+	batch.items_count = 0;
+	batch.state = state;
+	batch.active = true;
+
+	gui_state_apply(&batch.state);
+}
+
+void gutil_batch_end() {
+	gutil_batch_flush();
+	batch.active = false;
+}
+
+void gutil_layer(enum gutil_layer layer) {
+	batch.layer = layer;
+}
+
+void gutil_bind_texture(struct tex_gfx* tex) {
+	assert(tex);
+
+	batch.state.tex = tex;
+
+	if(!batch.active)
+		gfx_bind_texture(tex);
+}
+
+void gutil_texture(bool enable) {
+	batch.state.texture = enable;
+
+	if(!batch.active)
+		gfx_texture(enable);
+}
+
+void gutil_blending(enum gfx_blend mode) {
+	batch.state.blend = mode;
+
+	if(!batch.active)
+		gfx_blending(mode);
+}
+
 int gutil_control_icon(int x, enum input_button b, const char* str) {
 	int symbol, symbol_help;
 	enum input_category category;
@@ -32,7 +281,7 @@ int gutil_control_icon(int x, enum input_button b, const char* str) {
 	if(!input_symbol(b, &symbol, &symbol_help, &category))
 		return 0;
 
-	gfx_bind_texture(&texture_controls);
+	gutil_bind_texture(&texture_controls);
 	int scale = 16 * GFX_GUI_SCALE;
 	int text_scale = 5 * GFX_GUI_SCALE;
 
@@ -46,7 +295,7 @@ int gutil_control_icon(int x, enum input_button b, const char* str) {
 
 void gutil_texquad_col(int x, int y, int tx, int ty, int sx, int sy, int width,
 					   int height, uint8_t r, uint8_t g, uint8_t b, uint8_t a) {
-	gfx_draw_quads(
+	gutil_quads(
 		4,
 		(int16_t[]) {x, y, -2, x + width, y, -2, x + width, y + height, -2, x,
 					 y + height, -2},
@@ -62,7 +311,7 @@ void gutil_texquad(int x, int y, int tx, int ty, int sx, int sy, int width,
 
 void gutil_texquad_rt(int x, int y, int tx, int ty, int sx, int sy, int width,
 					  int height) {
-	gfx_draw_quads(
+	gutil_quads(
 		4,
 		(int16_t[]) {x, y, -2, x + width, y, -2, x + width, y + height, -2, x,
 					 y + height, -2},
@@ -77,7 +326,7 @@ void gutil_texquad_rt_any(int x, int y, float angle, int tx, int ty, int sx,
 	height *= 0.707107F;
 	angle -= glm_rad(45.0F);
 
-	gfx_draw_quads(
+	gutil_quads(
 		4,
 		(int16_t[]) {x + sinf(angle) * width, y - cosf(angle) * height, -2,
 					 x + cosf(angle) * width, y + sinf(angle) * height, -2,
@@ -89,7 +338,7 @@ void gutil_texquad_rt_any(int x, int y, float angle, int tx, int ty, int sx,
 }
 
 void gutil_bg() {
-	gfx_bind_texture(&texture_terrain);
+	gutil_bind_texture(&texture_terrain);
 
 	int scale = 16 * 4;
 	int cx = (gfx_width() + scale - 1) / scale;
@@ -177,70 +426,214 @@ static const uint8_t chat_colors[16][3] = {
 	{0xFF, 0xFF, 0xFF},
 };
 
+#define TEXT_CACHE_SIZE 32
+#define TEXT_CACHE_LENGTH 64
+
+// glyph quads of one string, shadows first
+struct text_mesh {
+	size_t vertex_count;
+	int16_t vertices[TEXT_CACHE_LENGTH * 2 * 4 * 3];
+	uint8_t colors[TEXT_CACHE_LENGTH * 2 * 4 * 4];
+	uint16_t texcoords[TEXT_CACHE_LENGTH * 2 * 4 * 2];
+};
+
+static struct text_cache_entry {
+	bool valid;
+	char str[TEXT_CACHE_LENGTH + 1];
+	int x, y, scale;
+	bool shadow;
+	struct text_mesh mesh;
+} text_cache[TEXT_CACHE_SIZE];
+
+static void text_mesh_glyph(struct text_mesh* m, int x, int y, int z,
+							int scale, uint8_t tex_x, uint8_t tex_y,
+							const uint8_t* color) {
+	int16_t* v = m->vertices + m->vertex_count * 3;
+	uint8_t* c = m->colors + m->vertex_count * 4;
+	uint16_t* t = m->texcoords + m->vertex_count * 2;
+
+	memcpy(v,
+		   (int16_t[]) {x, y, z, x + scale, y, z, x + scale, y + scale, z, x,
+						y + scale, z},
+		   sizeof(int16_t) * 4 * 3);
+
+	for(int k = 0; k < 4; k++) {
+		c[k * 4 + 0] = color[0];
+		c[k * 4 + 1] = color[1];
+		c[k * 4 + 2] = color[2];
+		c[k * 4 + 3] = 0xFF;
+	}
+
+	memcpy(t,
+		   (uint16_t[]) {tex_x, tex_y, tex_x + 16, tex_y, tex_x + 16,
+						 tex_y + 16, tex_x, tex_y + 16},
+		   sizeof(uint16_t) * 4 * 2);
+
+	m->vertex_count += 4;
+}
+
+// builds the first length characters of str, returns the last color used
+static int text_mesh_build(struct text_mesh* m, int* x, int y,
+						   const char* str, size_t length, int col, int scale,
+						   bool shadow) {
+	assert(length <= TEXT_CACHE_LENGTH);
+
+	m->vertex_count = 0;
+	int col_start = col;
+	int pos_x = *x;
+
+	for(int pass = shadow ? 0 : 1; pass < 2; pass++) {
+		int skip = 0;
+		col = col_start;
+		pos_x = *x;
+
+		for(size_t k = 0; k < length; k++) {
+			char c = str[k];
+
+			if(c == '\247')
+				skip = 2;
+
+			if(skip > 0) {
+				skip--;
+
+				if(c >= '0' && c <= '9')
+					col = c - '0';
+
+				if(c >= 'a' && c <= 'f')
+					col = c - 'a' + 10;
+			} else {
+				uint8_t tex_x = c % 16 * 16;
+				uint8_t tex_y = c / 16 * 16;
+
+				if(pass == 0) {
+					text_mesh_glyph(m, pos_x + scale / 8, y + scale / 8, -2,
+									scale, tex_x, tex_y,
+									(uint8_t[]) {chat_colors[col][0] / 4,
+												 chat_colors[col][1] / 4,
+												 chat_colors[col][2] / 4});
+				} else {
+					text_mesh_glyph(m, pos_x, y, -1, scale, tex_x, tex_y,
+									chat_colors[col]);
+				}
+
+				pos_x += (font_char_width[(int)c] + 1) * scale / 8;
+			}
+		}
+	}
+
+	*x = pos_x;
+	return col;
+}
+
+static uint32_t text_cache_hash(int x, int y, const char* str, int scale,
+								bool shadow) {
+	// FNV-1a
+	uint32_t hash = 2166136261U;
+
+	for(const char* c = str; *c; c++)
+		hash = (hash ^ (uint8_t)*c) * 16777619U;
+
+	int key[4] = {x, y, scale, shadow};
+	for(size_t k = 0; k < sizeof(key) / sizeof(*key); k++)
+		hash = (hash ^ (uint32_t)key[k]) * 16777619U;
+
+	return hash;
+}
+
 void gutil_text(int x, int y, const char* str, int scale, bool shadow) {
-	gfx_bind_texture(&texture_font);
+	assert(str);
 
-	int skip = 0;
-	int col = 15;
+	gutil_bind_texture(&texture_font);
 
-	while(*str) {
-		if(*str == '\247')
-			skip = 2;
+	size_t length = strlen(str);
 
-		if(skip > 0) {
-			skip--;
+	if(length > TEXT_CACHE_LENGTH) {
+		// too long to be cached, build in pieces
+		static struct text_mesh tmp;
+		int col = 15;
 
-			if(*str >= '0' && *str <= '9')
-				col = *str - '0';
+		while(length > 0) {
+			size_t n = length;
 
-			if(*str >= 'a' && *str <= 'f')
-				col = *str - 'a' + 10;
-		} else {
-			uint8_t tex_x = *str % 16 * 16;
-			uint8_t tex_y = *str / 16 * 16;
-			uint8_t width = (font_char_width[(int)*str] + 1) * scale / 8;
-
-			if(shadow) {
-				gfx_draw_quads(
-					4,
-					(int16_t[]) {x + scale / 8, y + scale / 8, -2,
-								 x + scale + scale / 8, y + scale / 8, -2,
-								 x + scale + scale / 8, y + scale + scale / 8,
-								 -2, x + scale / 8, y + scale + scale / 8, -2},
-					(uint8_t[]) {
-						chat_colors[col][0] / 4, chat_colors[col][1] / 4,
-						chat_colors[col][2] / 4, 0xFF, chat_colors[col][0] / 4,
-						chat_colors[col][1] / 4, chat_colors[col][2] / 4, 0xFF,
-						chat_colors[col][0] / 4, chat_colors[col][1] / 4,
-						chat_colors[col][2] / 4, 0xFF, chat_colors[col][0] / 4,
-						chat_colors[col][1] / 4, chat_colors[col][2] / 4, 0xFF},
-					(uint16_t[]) {tex_x, tex_y, tex_x + 16, tex_y, tex_x + 16,
-								  tex_y + 16, tex_x, tex_y + 16});
+			if(n > TEXT_CACHE_LENGTH) {
+				n = TEXT_CACHE_LENGTH;
+
+				// do not split a color code
+				if(str[n - 1] == '\247')
+					n--;
 			}
 
-			gfx_draw_quads(
-				4,
-				(int16_t[]) {x, y, -1, x + scale, y, -1, x + scale, y + scale,
-							 -1, x, y + scale, -1},
-				(uint8_t[]) {chat_colors[col][0], chat_colors[col][1],
-							 chat_colors[col][2], 0xFF, chat_colors[col][0],
-							 chat_colors[col][1], chat_colors[col][2], 0xFF,
-							 chat_colors[col][0], chat_colors[col][1],
-							 chat_colors[col][2], 0xFF, chat_colors[col][0],
-							 chat_colors[col][1], chat_colors[col][2], 0xFF},
-				(uint16_t[]) {tex_x, tex_y, tex_x + 16, tex_y, tex_x + 16,
-							  tex_y + 16, tex_x, tex_y + 16});
-
-			x += width;
+			col = text_mesh_build(&tmp, &x, y, str, n, col, scale, shadow);
+
+			if(tmp.vertex_count > 0)
+				gutil_quads(tmp.vertex_count, tmp.vertices, tmp.colors,
+							   tmp.texcoords);
+
+			str += n;
+			length -= n;
 		}
 
-		str++;
+		return;
+	}
+
+	struct text_cache_entry* e
+		= text_cache
+		+ text_cache_hash(x, y, str, scale, shadow) % TEXT_CACHE_SIZE;
+
+	if(!e->valid || e->x != x || e->y != y || e->scale != scale
+	   || e->shadow != shadow || strcmp(e->str, str) != 0) {
+		e->valid = true;
+		e->x = x;
+		e->y = y;
+		e->scale = scale;
+		e->shadow = shadow;
+		strcpy(e->str, str);
+		text_mesh_build(&e->mesh, &x, y, str, length, 15, scale, shadow);
 	}
+
+	if(e->mesh.vertex_count > 0)
+		gutil_quads(e->mesh.vertex_count, e->mesh.vertices, e->mesh.colors,
+					   e->mesh.texcoords);
 }
 
 void gutil_draw_item(struct item_data* item, int x, int y, int layer) {
 	assert(item);
 
+	if(!batch.active) {
+		gutil_draw_item_now(item, x, y, layer);
+		return;
+	}
+
+	struct gui_state state = batch.state;
+
+	if(item_icons_draw(item, x, y)) {
+		gutil_draw_item_labels(item, item_get(item), x, y);
+		batch.state = state;
+		return;
+	}
+
+	// not baked yet, draw the model this frame
+	struct gui_group* g = gui_batch_group(true);
+
+	if(!g || batch.items_count >= GUI_BATCH_ITEMS) {
+		gutil_batch_flush();
+		g = gui_batch_group(true);
+		assert(g);
+	}
+
+	batch.items[batch.items_count++] = (struct gui_item) {
+		.item = *item,
+		.x = x,
+		.y = y,
+		.depth = layer,
+		.group = g - batch.groups,
+	};
+}
+
+static void gutil_draw_item_now(struct item_data* item, int x, int y,
+								int layer) {
+	assert(item);
+
 	struct item* it = item_get(item);
 
 	if(it) {
@@ -253,22 +646,7 @@ void gutil_draw_item(struct item_data* item, int x, int y, int layer) {
 		gfx_write_buffers(true, false, false);
 		gfx_depth_range(0.0F, 1.0F);
 
-		if(it->has_damage && item->durability > 0) {
-			gfx_texture(false);
-			gutil_texquad_col(x + 4, y + 26, 0, 0, 0, 0, 26, 4, 0, 0, 0, 255);
-			gutil_texquad_col(
-				x + 4, y + 26, 0, 0, 0, 0,
-				26 * (1.0F - (float)item->durability / (float)it->max_damage),
-				2, 4, 251, 0, 255);
-			gfx_texture(true);
-		}
-
-		if(item->count > 1) {
-			char count[4];
-			snprintf(count, sizeof(count), "%u", item->count);
-			gutil_text(17 * GFX_GUI_SCALE - gutil_font_width(count, 8 * GFX_GUI_SCALE) + x, y + 9 * GFX_GUI_SCALE, count,
-					   8 * GFX_GUI_SCALE, true);
-		}
+		gutil_draw_item_labels(item, it, x, y);
 	} else {
 		char tmp[16];
 		snprintf(tmp, sizeof(tmp), "%u", item->id);
@@ -280,3 +658,25 @@ void gutil_draw_item(struct item_data* item, int x, int y, int layer) {
 				   true);
 	}
 }
+
+static void gutil_draw_item_labels(struct item_data* item, struct item* it,
+								   int x, int y) {
+	assert(item && it);
+
+	if(it->has_damage && item->durability > 0) {
+		gutil_texture(false);
+		gutil_texquad_col(x + 4, y + 26, 0, 0, 0, 0, 26, 4, 0, 0, 0, 255);
+		gutil_texquad_col(
+			x + 4, y + 26, 0, 0, 0, 0,
+			26 * (1.0F - (float)item->durability / (float)it->max_damage),
+			2, 4, 251, 0, 255);
+		gutil_texture(true);
+	}
+
+	if(item->count > 1) {
+		char count[4];
+		snprintf(count, sizeof(count), "%u", item->count);
+		gutil_text(17 * GFX_GUI_SCALE - gutil_font_width(count, 8 * GFX_GUI_SCALE) + x, y + 9 * GFX_GUI_SCALE, count,
+				   8 * GFX_GUI_SCALE, true);
+	}
+}
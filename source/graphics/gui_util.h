@@ -24,9 +24,29 @@
 #include <stdint.h>
 
 #include "../item/items.h"
+#include "../platform/gfx.h"
 #include "../platform/input.h"
 #include "../platform/texture.h"
 
+// later layers are drawn on top, within a layer by order of first use
+enum gutil_layer {
+	GUTIL_LAYER_BACKGROUND,
+	GUTIL_LAYER_PANEL,
+	GUTIL_LAYER_ITEMS,
+	GUTIL_LAYER_OVERLAY,
+	GUTIL_LAYER_HELD_ITEM,
+	GUTIL_LAYER_TOOLTIP,
+	GUTIL_LAYER_POINTER,
+};
+
+void gutil_batch_begin(void);
+void gutil_batch_flush(void);
+void gutil_batch_end(void);
+void gutil_layer(enum gutil_layer layer);
+void gutil_bind_texture(struct tex_gfx* tex);
+void gutil_texture(bool enable);
+void gutil_blending(enum gfx_blend mode);
+
 int gutil_control_icon(int x, enum input_button b, const char* str);
 void gutil_texquad_col(int x, int y, int tx, int ty, int sx, int sy, int width,
 					   int height, uint8_t r, uint8_t g, uint8_t b, uint8_t a);
@@ -0,0 +1,288 @@
+/*
+	Copyright (c) 2023 ByteBit/xtreme8000
+
+	This file is part of CavEX.
+
+	CavEX is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	CavEX is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with CavEX.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <m-lib/m-dict.h>
+
+#include "../platform/gfx.h"
+#include "gfx_settings.h"
+#include "gui_util.h"
+#include "item_icons.h"
+
+#define ICON_ATLAS_SIZE 512
+#define ICON_PADDING (2 * GFX_GUI_SCALE)
+#define ICON_CELL (16 * GFX_GUI_SCALE + ICON_PADDING * 2)
+#define ICON_ATLAS_CELLS (ICON_ATLAS_SIZE / ICON_CELL)
+#define ICON_SLOTS (ICON_ATLAS_CELLS * ICON_ATLAS_CELLS)
+// each bake reads back the framebuffer, new icons are spread over frames
+#define ICON_BAKE_MAX 16
+#define ICON_PENDING (-1)
+
+DICT_DEF2(dict_icon, uint32_t, M_BASIC_OPLIST, int, M_BASIC_OPLIST)
+
+struct tex_gfx texture_item_icons;
+
+static dict_icon_t icons;
+static size_t icons_used;
+static size_t icons_pending;
+static uint8_t* atlas;
+// owner and last frame drawn of every atlas slot, for eviction
+static uint32_t slot_key[ICON_SLOTS];
+static uint32_t slot_frame[ICON_SLOTS];
+static uint32_t frame;
+
+void item_icons_init() {
+	dict_icon_init(icons);
+	icons_used = 0;
+	icons_pending = 0;
+	atlas = NULL;
+	frame = 0;
+}
+
+static uint32_t item_icon_key(struct item_data* item, struct item* it) {
+	uint8_t metadata = item->durability;
+
+	// damage is drawn as a bar on top of the icon
+	if(it->has_damage
+	   || (item_is_block(item) && it->render_data.block.has_default))
+		metadata = 0;
+
+	return ((uint32_t)item->id << 8) | metadata;
+}
+
+bool item_icons_draw(struct item_data* item, int x, int y) {
+	assert(item);
+
+	struct item* it = item_get(item);
+
+	if(!it)
+		return false;
+
+	uint32_t key = item_icon_key(item, it);
+	int* slot = dict_icon_get(icons, key);
+
+	if(!slot) {
+		dict_icon_set_at(icons, key, ICON_PENDING);
+		icons_pending++;
+		return false;
+	}
+
+	if(*slot == ICON_PENDING)
+		return false;
+
+	slot_frame[*slot] = frame;
+
+	// texture coordinates are in 1/256 of the atlas size
+	int size = ICON_CELL * 256 / ICON_ATLAS_SIZE;
+
+	gutil_bind_texture(&texture_item_icons);
+	gutil_texquad(x - ICON_PADDING, y - ICON_PADDING,
+				  (*slot % ICON_ATLAS_CELLS) * size,
+				  (*slot / ICON_ATLAS_CELLS) * size, size, size, ICON_CELL,
+				  ICON_CELL);
+	return true;
+}
+
+// recovers color and alpha from the same icon drawn on black and white
+static void item_icons_unblend(uint8_t* dest, const uint8_t* black,
+							   const uint8_t* white) {
+	int alpha = 255
+		- ((white[0] - black[0]) + (white[1] - black[1])
+		   + (white[2] - black[2]))
+			/ 3;
+
+	if(alpha <= 0) {
+		memset(dest, 0, 4);
+		return;
+	}
+
+	if(alpha > 255)
+		alpha = 255;
+
+	for(int k = 0; k < 3; k++) {
+		int col = black[k] * 255 / alpha;
+		dest[k] = col > 255 ? 255 : col;
+	}
+
+	dest[3] = alpha;
+}
+
+static void item_icons_render(struct item_data* item, int x, int y,
+							  uint8_t background) {
+	gfx_texture(false);
+	gutil_texquad_col(x, y, 0, 0, 0, 0, ICON_CELL, ICON_CELL, background,
+					  background, background, 0xFF);
+	gfx_texture(true);
+
+	struct item* it = item_get(item);
+	assert(it);
+
+	mat4 model;
+	glm_translate_make(model,
+					   (vec3) {x + ICON_PADDING, y + ICON_PADDING, 0});
+
+	gfx_write_buffers(true, true, true);
+	it->renderItem(it, item, model, true, R_ITEM_ENV_INVENTORY);
+	gfx_write_buffers(true, false, false);
+}
+
+// least recently drawn slot, its icon has to be baked again when needed
+static int item_icons_slot() {
+	if(icons_used < ICON_SLOTS)
+		return icons_used++;
+
+	int lru = 0;
+	for(int k = 1; k < ICON_SLOTS; k++) {
+		if(slot_frame[k] < slot_frame[lru])
+			lru = k;
+	}
+
+	// drawn last frame, every slot is on screen and the rest has to wait
+	if(slot_frame[lru] + 1 >= frame)
+		return ICON_PENDING;
+
+	// a bake that failed may have left the slot without its icon
+	int* owner = dict_icon_get(icons, slot_key[lru]);
+	if(owner && *owner == lru)
+		dict_icon_erase(icons, slot_key[lru]);
+
+	return lru;
+}
+
+void item_icons_bake() {
+	frame++;
+
+	if(!icons_pending)
+		return;
+
+	size_t width, height;
+	gfx_copy_framebuffer(NULL, &width, &height);
+
+	// upper half of the screen is used for black, lower half for white
+	size_t columns = width / ICON_CELL;
+	size_t rows = height / 2 / ICON_CELL;
+	size_t capacity = columns * rows;
+
+	if(capacity > ICON_BAKE_MAX)
+		capacity = ICON_BAKE_MAX;
+
+	if(!capacity)
+		return;
+
+	if(!atlas) {
+		atlas = calloc(ICON_ATLAS_SIZE * ICON_ATLAS_SIZE, 4);
+
+		if(!atlas)
+			return;
+	}
+
+	uint32_t keys[ICON_BAKE_MAX];
+	int slots[ICON_BAKE_MAX];
+	size_t count = 0;
+
+	dict_icon_it_t it;
+	dict_icon_it(it, icons);
+
+	while(!dict_icon_end_p(it) && count < capacity) {
+		if(dict_icon_ref(it)->value == ICON_PENDING)
+			keys[count++] = dict_icon_ref(it)->key;
+
+		dict_icon_next(it);
+	}
+
+	// not while iterating, taking a slot may erase another icon
+	for(size_t k = 0; k < count; k++) {
+		slots[k] = item_icons_slot();
+
+		if(slots[k] == ICON_PENDING) {
+			count = k;
+			break;
+		}
+
+		slot_key[slots[k]] = keys[k];
+		slot_frame[slots[k]] = frame;
+	}
+
+	if(!count)
+		return;
+
+	uint8_t* pixels = malloc(width * height * 4);
+	uint8_t* upload = malloc(ICON_ATLAS_SIZE * ICON_ATLAS_SIZE * 4);
+
+	if(!pixels || !upload) {
+		free(pixels);
+		free(upload);
+		return;
+	}
+
+	gfx_mode_gui();
+
+	for(size_t k = 0; k < count; k++) {
+		struct item_data item = (struct item_data) {
+			.id = keys[k] >> 8,
+			.durability = keys[k] & 0xFF,
+			.count = 1,
+		};
+
+		int x = (k % columns) * ICON_CELL;
+		int y = (k / columns) * ICON_CELL;
+		item_icons_render(&item, x, y, 0x00);
+		item_icons_render(&item, x, y + rows * ICON_CELL, 0xFF);
+	}
+
+	gfx_copy_framebuffer(pixels, &width, &height);
+	gfx_discard_framebuffer();
+
+	for(size_t k = 0; k < count; k++) {
+		int slot = slots[k];
+		dict_icon_set_at(icons, keys[k], slot);
+
+		size_t src_x = (k % columns) * ICON_CELL;
+		size_t src_y = (k / columns) * ICON_CELL;
+		size_t dst_x = (slot % ICON_ATLAS_CELLS) * ICON_CELL;
+		size_t dst_y = (slot / ICON_ATLAS_CELLS) * ICON_CELL;
+
+		for(size_t y = 0; y < ICON_CELL; y++) {
+			for(size_t x = 0; x < ICON_CELL; x++) {
+				uint8_t* black = pixels + (src_x + x + (src_y + y) * width) * 4;
+				uint8_t* white = pixels
+					+ (src_x + x + (src_y + y + rows * ICON_CELL) * width) * 4;
+				item_icons_unblend(
+					atlas + (dst_x + x + (dst_y + y) * ICON_ATLAS_SIZE) * 4,
+					black, white);
+			}
+		}
+	}
+
+	icons_pending -= count;
+	free(pixels);
+
+	memcpy(upload, atlas, ICON_ATLAS_SIZE * ICON_ATLAS_SIZE * 4);
+
+	if(texture_item_icons.data) {
+		tex_gfx_update(&texture_item_icons, upload);
+	} else {
+		tex_gfx_load(&texture_item_icons, upload, ICON_ATLAS_SIZE,
+					 ICON_ATLAS_SIZE, TEX_FMT_RGBA16, false);
+	}
+}
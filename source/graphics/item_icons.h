@@ -0,0 +1,35 @@
+/*
+	Copyright (c) 2023 ByteBit/xtreme8000
+
+	This file is part of CavEX.
+
+	CavEX is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	CavEX is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with CavEX.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef ITEM_ICONS_H
+#define ITEM_ICONS_H
+
+#include <stdbool.h>
+
+#include "../item/items.h"
+#include "../platform/texture.h"
+
+extern struct tex_gfx texture_item_icons;
+
+void item_icons_init(void);
+bool item_icons_draw(struct item_data* item, int x, int y);
+void item_icons_bake(void);
+
+#endif
@@ -17,11 +17,29 @@
 	along with CavEX.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <assert.h>
+#include <m-lib/m-string.h>
 #include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
+#include "../config.h"
+#include "../game/game_state.h"
 #include "../platform/texture.h"
 #include "texture_atlas.h"
 
+// bump when the layout of tex_atlas_compute() output changes
+#define ATLAS_CACHE_VERSION 1
+
+struct atlas_cache_header {
+	char magic[4];
+	uint32_t version;
+	uint64_t hash;
+	uint32_t width, height;
+	uint32_t entries;
+};
+
 static uint8_t global_block_atlas[TEXAT_MAX];
 static uint8_t global_particle_atlas[TEXAT_MAX];
 
@@ -33,6 +51,16 @@ static int clamp_n(int x, int n) {
 	return x;
 }
 
+// FNV-1a
+static uint64_t hash_bytes(uint64_t hash, const void* data, size_t length) {
+	const uint8_t* bytes = data;
+
+	for(size_t k = 0; k < length; k++)
+		hash = (hash ^ bytes[k]) * 0x100000001B3;
+
+	return hash;
+}
+
 static const uint8_t redstone_colors[16][3] = {
     {111,   0,  0},  // 0: off
     {120,   3,  0},  // 1
@@ -97,17 +125,35 @@ void tex_atlas_reg_grass(dict_atlas_src_t atlas, enum tex_atlas_entry name,
 							 });
 }
 
+// one row of a tile, edge pixels repeated into the border
+static void atlas_row(uint8_t* dst, const uint8_t* src, int tile_size,
+					  int border) {
+	for(int k = 0; k < border; k++) {
+		memcpy(dst + k * 4, src, 4);
+		memcpy(dst + (tile_size + border + k) * 4,
+			   src + (tile_size - 1) * 4, 4);
+	}
+
+	memcpy(dst + border * 4, src, tile_size * 4);
+}
+
 void* tex_atlas_compute(dict_atlas_src_t atlas, uint8_t* atlas_dst,
 						uint8_t* image, size_t width, size_t height) {
 	assert(image && width >= 256 && width == height);
 
 	int tile_size = width / 16;
 	int border_scale = width / 256;
+	int row_length = tile_size + 2 * border_scale;
 
 	uint8_t* output = malloc(width * height * 4);
+	// background tile of the current row, for entries with bg enabled
+	uint8_t* bg_row = malloc(row_length * 4);
 
-	if(!output)
+	if(!output || !bg_row) {
+		free(output);
+		free(bg_row);
 		return NULL;
+	}
 
 	memset(output, 255, width * height * 4);
 
@@ -119,40 +165,42 @@ void* tex_atlas_compute(dict_atlas_src_t atlas, uint8_t* atlas_dst,
 	while(!dict_atlas_src_end_p(it)) {
 		struct texture_entry* e = dict_atlas_src_ref(it);
 
-		size_t current_x = (current % 14) * (tile_size + 2 * border_scale)
-			+ 3 * border_scale;
-		size_t current_y = (current / 14) * (tile_size + 2 * border_scale)
-			+ 3 * border_scale;
-
-		// int64_t to prevent unreasonable gcc warning
-		for(int64_t y = -border_scale; y < tile_size + border_scale; y++) {
-			for(int64_t x = -border_scale; x < tile_size + border_scale; x++) {
-				uint8_t* src_col = image
-					+ ((clamp_n(x, tile_size) + e->x * tile_size)
-					   + (clamp_n(y, tile_size) + e->y * tile_size) * width)
-						* 4;
-				uint8_t* dst_col
-					= output + ((current_x + x) + (current_y + y) * width) * 4;
+		size_t current_x = (current % 14) * row_length + 2 * border_scale;
+		size_t current_y = (current / 14) * row_length + 3 * border_scale;
+
+		for(int y = -border_scale; y < tile_size + border_scale; y++) {
+			int src_y = clamp_n(y, tile_size);
+			uint8_t* dst = output + (current_x + (current_y + y) * width) * 4;
+
+			atlas_row(dst,
+					  image
+						  + (e->x * tile_size
+							 + (src_y + e->y * tile_size) * width)
+							  * 4,
+					  tile_size, border_scale);
+
+			if(!e->colorize.enable && !e->bg.enable)
+				continue;
+
+			if(e->bg.enable)
+				atlas_row(bg_row,
+						  image
+							  + (e->bg.x * tile_size
+								 + (src_y + e->bg.y * tile_size) * width)
+								  * 4,
+						  tile_size, border_scale);
+
+			for(int x = 0; x < row_length; x++) {
+				uint8_t* col = dst + x * 4;
 
 				if(e->colorize.enable) {
-					dst_col[0] = src_col[0] * e->colorize.r / 255;
-					dst_col[1] = src_col[1] * e->colorize.g / 255;
-					dst_col[2] = src_col[2] * e->colorize.b / 255;
-					dst_col[3] = src_col[3];
-				} else {
-					for(size_t k = 0; k < 4; k++)
-						dst_col[k] = src_col[k];
+					col[0] = col[0] * e->colorize.r / 255;
+					col[1] = col[1] * e->colorize.g / 255;
+					col[2] = col[2] * e->colorize.b / 255;
 				}
 
-				if(e->bg.enable && dst_col[3] < 128) {
-					uint8_t* src_col2 = image
-						+ ((clamp_n(x, tile_size) + e->bg.x * tile_size)
-						   + (clamp_n(y, tile_size) + e->bg.y * tile_size)
-							   * width)
-							* 4;
-					for(size_t k = 0; k < 4; k++)
-						dst_col[k] = src_col2[k];
-				}
+				if(e->bg.enable && col[3] < 128)
+					memcpy(col, bg_row + x * 4, 4);
 			}
 		}
 
@@ -162,6 +210,148 @@ void* tex_atlas_compute(dict_atlas_src_t atlas, uint8_t* atlas_dst,
 		dict_atlas_src_next(it);
 	}
 
+	free(bg_row);
+	return output;
+}
+
+static uint64_t atlas_hash(dict_atlas_src_t atlas, const char* filename) {
+	uint64_t hash = 0xCBF29CE484222325;
+	uint32_t version = ATLAS_CACHE_VERSION;
+	hash = hash_bytes(hash, &version, sizeof(version));
+
+	dict_atlas_src_it_t it;
+	dict_atlas_src_it(it, atlas);
+
+	while(!dict_atlas_src_end_p(it)) {
+		struct texture_entry* e = dict_atlas_src_ref(it);
+		// field by field, the struct has padding and bitfields
+		uint8_t def[] = {
+			e->name & 0xFF,	   e->name >> 8,	  e->x,
+			e->y,			   e->colorize.enable, e->colorize.r,
+			e->colorize.g,	   e->colorize.b,	  e->bg.enable,
+			e->bg.x,		   e->bg.y,
+		};
+
+		hash = hash_bytes(hash, def, sizeof(def));
+		dict_atlas_src_next(it);
+	}
+
+	FILE* f = fopen(filename, "rb");
+
+	if(!f)
+		return 0;
+
+	uint8_t buffer[4096];
+	size_t length;
+
+	while((length = fread(buffer, 1, sizeof(buffer), f)) > 0)
+		hash = hash_bytes(hash, buffer, length);
+
+	fclose(f);
+	return hash;
+}
+
+static void* atlas_cache_load(const char* filename, uint64_t hash,
+							  uint8_t* atlas_dst, size_t* width,
+							  size_t* height) {
+	FILE* f = fopen(filename, "rb");
+
+	if(!f)
+		return NULL;
+
+	struct atlas_cache_header h;
+	uint8_t* output = NULL;
+
+	if(fread(&h, sizeof(h), 1, f) == 1 && !memcmp(h.magic, "CXAT", 4)
+	   && h.version == ATLAS_CACHE_VERSION && h.hash == hash
+	   && h.entries == TEXAT_MAX && h.width == h.height && h.width >= 256
+	   && h.width <= 4096) {
+		output = malloc(h.width * h.height * 4);
+
+		if(output
+		   && (fread(atlas_dst, TEXAT_MAX, 1, f) != 1
+			   || fread(output, h.width * h.height * 4, 1, f) != 1)) {
+			free(output);
+			output = NULL;
+		}
+	}
+
+	fclose(f);
+
+	if(output) {
+		*width = h.width;
+		*height = h.height;
+	}
+
+	return output;
+}
+
+static void atlas_cache_save(const char* filename, uint64_t hash,
+							 uint8_t* atlas_dst, void* output, size_t width,
+							 size_t height) {
+	FILE* f = fopen(filename, "wb");
+
+	// texture pack might be read-only, just bake again next time
+	if(!f)
+		return;
+
+	struct atlas_cache_header h = (struct atlas_cache_header) {
+		.magic = {'C', 'X', 'A', 'T'},
+		.version = ATLAS_CACHE_VERSION,
+		.hash = hash,
+		.width = width,
+		.height = height,
+		.entries = TEXAT_MAX,
+	};
+
+	bool ok = fwrite(&h, sizeof(h), 1, f) == 1
+		&& fwrite(atlas_dst, TEXAT_MAX, 1, f) == 1
+		&& fwrite(output, width * height * 4, 1, f) == 1;
+	fclose(f);
+
+	if(!ok)
+		remove(filename);
+}
+
+/* Bakes the atlas of a texture pack image, or loads it from a cache file
+ * next to the image. The cache is keyed by the image file and the atlas
+ * definition, so edits to either bake it again. */
+static void* tex_atlas_cached(dict_atlas_src_t atlas, uint8_t* atlas_dst,
+							  const char* filename, size_t* width,
+							  size_t* height) {
+	assert(atlas && atlas_dst && filename && width && height);
+
+	string_t path, cache_path;
+	string_init_printf(
+		path, "%s/%s",
+		config_read_string(&gstate.config_user, "paths.texturepack", "assets"),
+		filename);
+	string_init_printf(cache_path, "%s.atlas", string_get_cstr(path));
+
+	uint64_t hash = atlas_hash(atlas, string_get_cstr(path));
+	void* output = NULL;
+
+	if(hash)
+		output = atlas_cache_load(string_get_cstr(cache_path), hash, atlas_dst,
+								  width, height);
+
+	if(!output) {
+		uint8_t* image = tex_read(filename, width, height);
+
+		if(image) {
+			output = tex_atlas_compute(atlas, atlas_dst, image, *width,
+									   *height);
+			free(image);
+		}
+
+		if(output && hash)
+			atlas_cache_save(string_get_cstr(cache_path), hash, atlas_dst,
+							 output, *width, *height);
+	}
+
+	string_clear(path);
+	string_clear(cache_path);
+
 	return output;
 }
 
@@ -364,11 +554,9 @@ void* tex_atlas_block(const char* filename, size_t* width, size_t* height) {
 
 	memset(global_block_atlas, 0, sizeof(global_block_atlas));
 
-	uint8_t* image = tex_read(filename, width, height);
-	void* output = tex_atlas_compute(atlas, global_block_atlas, image,
-									 *width, *height);
+	void* output
+		= tex_atlas_cached(atlas, global_block_atlas, filename, width, height);
 	dict_atlas_src_clear(atlas);
-	free(image);
 
 	return output;
 }
@@ -411,13 +599,9 @@ void* tex_atlas_particles(const char* filename, size_t* width, size_t* height) {
 // you can register other rows here…
 
   memset(global_particle_atlas, 0, sizeof(global_particle_atlas));
-	uint8_t* image = tex_read(filename, width, height);
-	void* output = tex_atlas_compute(atlas,
-									 global_particle_atlas,
-									 image,
-									 *width, *height);
+	void* output = tex_atlas_cached(atlas, global_particle_atlas, filename,
+									width, height);
 	dict_atlas_src_clear(atlas);
-	free(image);
 	return output;
 
 }
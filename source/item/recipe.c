@@ -18,70 +18,78 @@
 */
 
 #include <stdarg.h>
+#include <string.h>
 
 #include "recipe.h"
 
-array_recipe_t recipes_crafting;
+struct recipe_list recipes_crafting;
+
+// item ids of a grid, trimmed to the non-empty slots
+struct recipe_pattern {
+	size_t width, height;
+	size_t x, y;
+	uint16_t id[9];
+};
 
 static void add_tools() {
 	// wood
 	recipe_add(
-		recipes_crafting,
+		&recipes_crafting,
 		(struct item_data) {.id = ITEM_WOOD_SWORD, .durability = 0, .count = 1},
 		1, 3, (uint8_t[]) {1, 1, 2}, (struct item_data) {.id = BLOCK_PLANKS},
 		false, (struct item_data) {.id = ITEM_STICK}, false);
-	recipe_add(recipes_crafting,
+	recipe_add(&recipes_crafting,
 			   (struct item_data) {
 				   .id = ITEM_WOOD_PICKAXE, .durability = 0, .count = 1},
 			   3, 3, (uint8_t[]) {1, 1, 1, 0, 2, 0, 0, 2, 0},
 			   (struct item_data) {.id = BLOCK_PLANKS}, false,
 			   (struct item_data) {.id = ITEM_STICK}, false);
-	recipe_add(recipes_crafting,
+	recipe_add(&recipes_crafting,
 			   (struct item_data) {
 				   .id = ITEM_WOOD_SHOVEL, .durability = 0, .count = 1},
 			   1, 3, (uint8_t[]) {1, 2, 2},
 			   (struct item_data) {.id = BLOCK_PLANKS}, false,
 			   (struct item_data) {.id = ITEM_STICK}, false);
 	recipe_add(
-		recipes_crafting,
+		&recipes_crafting,
 		(struct item_data) {.id = ITEM_WOOD_AXE, .durability = 0, .count = 1},
 		2, 3, (uint8_t[]) {1, 1, 1, 2, 0, 2},
 		(struct item_data) {.id = BLOCK_PLANKS}, false,
 		(struct item_data) {.id = ITEM_STICK}, false);
 	recipe_add(
-		recipes_crafting,
+		&recipes_crafting,
 		(struct item_data) {.id = ITEM_WOOD_HOE, .durability = 0, .count = 1},
 		2, 3, (uint8_t[]) {1, 1, 0, 2, 0, 2},
 		(struct item_data) {.id = BLOCK_PLANKS}, false,
 		(struct item_data) {.id = ITEM_STICK}, false);
 
 	// stone
-	recipe_add(recipes_crafting,
+	recipe_add(&recipes_crafting,
 			   (struct item_data) {
 				   .id = ITEM_STONE_SWORD, .durability = 0, .count = 1},
 			   1, 3, (uint8_t[]) {1, 1, 2},
 			   (struct item_data) {.id = BLOCK_COBBLESTONE}, false,
 			   (struct item_data) {.id = ITEM_STICK}, false);
-	recipe_add(recipes_crafting,
+	recipe_add(&recipes_crafting,
 			   (struct item_data) {
 				   .id = ITEM_STONE_PICKAXE, .durability = 0, .count = 1},
 			   3, 3, (uint8_t[]) {1, 1, 1, 0, 2, 0, 0, 2, 0},
 			   (struct item_data) {.id = BLOCK_COBBLESTONE}, false,
 			   (struct item_data) {.id = ITEM_STICK}, false);
-	recipe_add(recipes_crafting,
+	recipe_add(&recipes_crafting,
 			   (struct item_data) {
 				   .id = ITEM_STONE_SHOVEL, .durability = 0, .count = 1},
 			   1, 3, (uint8_t[]) {1, 2, 2},
 			   (struct item_data) {.id = BLOCK_COBBLESTONE}, false,
 			   (struct item_data) {.id = ITEM_STICK}, false);
 	recipe_add(
-		recipes_crafting,
+		&recipes_crafting,
 		(struct item_data) {.id = ITEM_STONE_AXE, .durability = 0, .count = 1},
 		2, 3, (uint8_t[]) {1, 1, 1, 2, 0, 2},
 		(struct item_data) {.id = BLOCK_COBBLESTONE}, false,
 		(struct item_data) {.id = ITEM_STICK}, false);
 	recipe_add(
-		recipes_crafting,
+		&recipes_crafting,
 		(struct item_data) {.id = ITEM_STONE_HOE, .durability = 0, .count = 1},
 		2, 3, (uint8_t[]) {1, 1, 0, 2, 0, 2},
 		(struct item_data) {.id = BLOCK_COBBLESTONE}, false,
@@ -89,30 +97,30 @@ static void add_tools() {
 
 	// gold
 	recipe_add(
-		recipes_crafting,
+		&recipes_crafting,
 		(struct item_data) {.id = ITEM_GOLD_SWORD, .durability = 0, .count = 1},
 		1, 3, (uint8_t[]) {1, 1, 2}, (struct item_data) {.id = ITEM_GOLD},
 		false, (struct item_data) {.id = ITEM_STICK}, false);
-	recipe_add(recipes_crafting,
+	recipe_add(&recipes_crafting,
 			   (struct item_data) {
 				   .id = ITEM_GOLD_PICKAXE, .durability = 0, .count = 1},
 			   3, 3, (uint8_t[]) {1, 1, 1, 0, 2, 0, 0, 2, 0},
 			   (struct item_data) {.id = ITEM_GOLD}, false,
 			   (struct item_data) {.id = ITEM_STICK}, false);
-	recipe_add(recipes_crafting,
+	recipe_add(&recipes_crafting,
 			   (struct item_data) {
 				   .id = ITEM_GOLD_SHOVEL, .durability = 0, .count = 1},
 			   1, 3, (uint8_t[]) {1, 2, 2},
 			   (struct item_data) {.id = ITEM_GOLD}, false,
 			   (struct item_data) {.id = ITEM_STICK}, false);
 	recipe_add(
-		recipes_crafting,
+		&recipes_crafting,
 		(struct item_data) {.id = ITEM_GOLD_AXE, .durability = 0, .count = 1},
 		2, 3, (uint8_t[]) {1, 1, 1, 2, 0, 2},
 		(struct item_data) {.id = ITEM_GOLD}, false,
 		(struct item_data) {.id = ITEM_STICK}, false);
 	recipe_add(
-		recipes_crafting,
+		&recipes_crafting,
 		(struct item_data) {.id = ITEM_GOLD_HOE, .durability = 0, .count = 1},
 		2, 3, (uint8_t[]) {1, 1, 0, 2, 0, 2},
 		(struct item_data) {.id = ITEM_GOLD}, false,
@@ -120,61 +128,61 @@ static void add_tools() {
 
 	// iron
 	recipe_add(
-		recipes_crafting,
+		&recipes_crafting,
 		(struct item_data) {.id = ITEM_IRON_SWORD, .durability = 0, .count = 1},
 		1, 3, (uint8_t[]) {1, 1, 2}, (struct item_data) {.id = ITEM_IRON},
 		false, (struct item_data) {.id = ITEM_STICK}, false);
-	recipe_add(recipes_crafting,
+	recipe_add(&recipes_crafting,
 			   (struct item_data) {
 				   .id = ITEM_IRON_PICKAXE, .durability = 0, .count = 1},
 			   3, 3, (uint8_t[]) {1, 1, 1, 0, 2, 0, 0, 2, 0},
 			   (struct item_data) {.id = ITEM_IRON}, false,
 			   (struct item_data) {.id = ITEM_STICK}, false);
-	recipe_add(recipes_crafting,
+	recipe_add(&recipes_crafting,
 			   (struct item_data) {
 				   .id = ITEM_IRON_SHOVEL, .durability = 0, .count = 1},
 			   1, 3, (uint8_t[]) {1, 2, 2},
 			   (struct item_data) {.id = ITEM_IRON}, false,
 			   (struct item_data) {.id = ITEM_STICK}, false);
 	recipe_add(
-		recipes_crafting,
+		&recipes_crafting,
 		(struct item_data) {.id = ITEM_IRON_AXE, .durability = 0, .count = 1},
 		2, 3, (uint8_t[]) {1, 1, 1, 2, 0, 2},
 		(struct item_data) {.id = ITEM_IRON}, false,
 		(struct item_data) {.id = ITEM_STICK}, false);
 	recipe_add(
-		recipes_crafting,
+		&recipes_crafting,
 		(struct item_data) {.id = ITEM_IRON_HOE, .durability = 0, .count = 1},
 		2, 3, (uint8_t[]) {1, 1, 0, 2, 0, 2},
 		(struct item_data) {.id = ITEM_IRON}, false,
 		(struct item_data) {.id = ITEM_STICK}, false);
 
 	// diamond
-	recipe_add(recipes_crafting,
+	recipe_add(&recipes_crafting,
 			   (struct item_data) {
 				   .id = ITEM_DIAMOND_SWORD, .durability = 0, .count = 1},
 			   1, 3, (uint8_t[]) {1, 1, 2},
 			   (struct item_data) {.id = ITEM_DIAMOND}, false,
 			   (struct item_data) {.id = ITEM_STICK}, false);
-	recipe_add(recipes_crafting,
+	recipe_add(&recipes_crafting,
 			   (struct item_data) {
 				   .id = ITEM_DIAMOND_PICKAXE, .durability = 0, .count = 1},
 			   3, 3, (uint8_t[]) {1, 1, 1, 0, 2, 0, 0, 2, 0},
 			   (struct item_data) {.id = ITEM_DIAMOND}, false,
 			   (struct item_data) {.id = ITEM_STICK}, false);
-	recipe_add(recipes_crafting,
+	recipe_add(&recipes_crafting,
 			   (struct item_data) {
 				   .id = ITEM_DIAMOND_SHOVEL, .durability = 0, .count = 1},
 			   1, 3, (uint8_t[]) {1, 2, 2},
 			   (struct item_data) {.id = ITEM_DIAMOND}, false,
 			   (struct item_data) {.id = ITEM_STICK}, false);
-	recipe_add(recipes_crafting,
+	recipe_add(&recipes_crafting,
 			   (struct item_data) {
 				   .id = ITEM_DIAMOND_AXE, .durability = 0, .count = 1},
 			   2, 3, (uint8_t[]) {1, 1, 1, 2, 0, 2},
 			   (struct item_data) {.id = ITEM_DIAMOND}, false,
 			   (struct item_data) {.id = ITEM_STICK}, false);
-	recipe_add(recipes_crafting,
+	recipe_add(&recipes_crafting,
 			   (struct item_data) {
 				   .id = ITEM_DIAMOND_HOE, .durability = 0, .count = 1},
 			   2, 3, (uint8_t[]) {1, 1, 0, 2, 0, 2},
@@ -184,110 +192,110 @@ static void add_tools() {
 
 static void add_armor() {
 	// leather
-	recipe_add(recipes_crafting,
+	recipe_add(&recipes_crafting,
 			   (struct item_data) {
 				   .id = ITEM_LEATHER_HELMET, .durability = 0, .count = 1},
 			   3, 2, (uint8_t[]) {1, 1, 1, 1, 0, 1},
 			   (struct item_data) {.id = ITEM_LEATHER}, false);
-	recipe_add(recipes_crafting,
+	recipe_add(&recipes_crafting,
 			   (struct item_data) {
 				   .id = ITEM_LEATHER_CHESTPLATE, .durability = 0, .count = 1},
 			   3, 3, (uint8_t[]) {1, 0, 1, 1, 1, 1, 1, 1, 1},
 			   (struct item_data) {.id = ITEM_LEATHER}, false);
-	recipe_add(recipes_crafting,
+	recipe_add(&recipes_crafting,
 			   (struct item_data) {
 				   .id = ITEM_LEATHER_LEGGINGS, .durability = 0, .count = 1},
 			   3, 3, (uint8_t[]) {1, 1, 1, 1, 0, 1, 1, 0, 1},
 			   (struct item_data) {.id = ITEM_LEATHER}, false);
-	recipe_add(recipes_crafting,
+	recipe_add(&recipes_crafting,
 			   (struct item_data) {
 				   .id = ITEM_LEATHER_BOOTS, .durability = 0, .count = 1},
 			   3, 2, (uint8_t[]) {1, 0, 1, 1, 0, 1},
 			   (struct item_data) {.id = ITEM_LEATHER}, false);
 
 	// chain
-	recipe_add(recipes_crafting,
+	recipe_add(&recipes_crafting,
 			   (struct item_data) {
 				   .id = ITEM_CHAIN_HELMET, .durability = 0, .count = 1},
 			   3, 2, (uint8_t[]) {1, 1, 1, 1, 0, 1},
 			   (struct item_data) {.id = BLOCK_FIRE}, false);
-	recipe_add(recipes_crafting,
+	recipe_add(&recipes_crafting,
 			   (struct item_data) {
 				   .id = ITEM_CHAIN_CHESTPLATE, .durability = 0, .count = 1},
 			   3, 3, (uint8_t[]) {1, 0, 1, 1, 1, 1, 1, 1, 1},
 			   (struct item_data) {.id = BLOCK_FIRE}, false);
-	recipe_add(recipes_crafting,
+	recipe_add(&recipes_crafting,
 			   (struct item_data) {
 				   .id = ITEM_CHAIN_LEGGINGS, .durability = 0, .count = 1},
 			   3, 3, (uint8_t[]) {1, 1, 1, 1, 0, 1, 1, 0, 1},
 			   (struct item_data) {.id = BLOCK_FIRE}, false);
-	recipe_add(recipes_crafting,
+	recipe_add(&recipes_crafting,
 			   (struct item_data) {
 				   .id = ITEM_CHAIN_BOOTS, .durability = 0, .count = 1},
 			   3, 2, (uint8_t[]) {1, 0, 1, 1, 0, 1},
 			   (struct item_data) {.id = BLOCK_FIRE}, false);
 
 	// iron
-	recipe_add(recipes_crafting,
+	recipe_add(&recipes_crafting,
 			   (struct item_data) {
 				   .id = ITEM_IRON_HELMET, .durability = 0, .count = 1},
 			   3, 2, (uint8_t[]) {1, 1, 1, 1, 0, 1},
 			   (struct item_data) {.id = ITEM_IRON}, false);
-	recipe_add(recipes_crafting,
+	recipe_add(&recipes_crafting,
 			   (struct item_data) {
 				   .id = ITEM_IRON_CHESTPLATE, .durability = 0, .count = 1},
 			   3, 3, (uint8_t[]) {1, 0, 1, 1, 1, 1, 1, 1, 1},
 			   (struct item_data) {.id = ITEM_IRON}, false);
-	recipe_add(recipes_crafting,
+	recipe_add(&recipes_crafting,
 			   (struct item_data) {
 				   .id = ITEM_IRON_LEGGINGS, .durability = 0, .count = 1},
 			   3, 3, (uint8_t[]) {1, 1, 1, 1, 0, 1, 1, 0, 1},
 			   (struct item_data) {.id = ITEM_IRON}, false);
 	recipe_add(
-		recipes_crafting,
+		&recipes_crafting,
 		(struct item_data) {.id = ITEM_IRON_BOOTS, .durability = 0, .count = 1},
 		3, 2, (uint8_t[]) {1, 0, 1, 1, 0, 1},
 		(struct item_data) {.id = ITEM_IRON}, false);
 
 	// gold
-	recipe_add(recipes_crafting,
+	recipe_add(&recipes_crafting,
 			   (struct item_data) {
 				   .id = ITEM_GOLD_HELMET, .durability = 0, .count = 1},
 			   3, 2, (uint8_t[]) {1, 1, 1, 1, 0, 1},
 			   (struct item_data) {.id = ITEM_GOLD}, false);
-	recipe_add(recipes_crafting,
+	recipe_add(&recipes_crafting,
 			   (struct item_data) {
 				   .id = ITEM_GOLD_CHESTPLATE, .durability = 0, .count = 1},
 			   3, 3, (uint8_t[]) {1, 0, 1, 1, 1, 1, 1, 1, 1},
 			   (struct item_data) {.id = ITEM_GOLD}, false);
-	recipe_add(recipes_crafting,
+	recipe_add(&recipes_crafting,
 			   (struct item_data) {
 				   .id = ITEM_GOLD_LEGGINGS, .durability = 0, .count = 1},
 			   3, 3, (uint8_t[]) {1, 1, 1, 1, 0, 1, 1, 0, 1},
 			   (struct item_data) {.id = ITEM_GOLD}, false);
 	recipe_add(
-		recipes_crafting,
+		&recipes_crafting,
 		(struct item_data) {.id = ITEM_GOLD_BOOTS, .durability = 0, .count = 1},
 		3, 2, (uint8_t[]) {1, 0, 1, 1, 0, 1},
 		(struct item_data) {.id = ITEM_GOLD}, false);
 
 	// diamond
-	recipe_add(recipes_crafting,
+	recipe_add(&recipes_crafting,
 			   (struct item_data) {
 				   .id = ITEM_DIAMOND_HELMET, .durability = 0, .count = 1},
 			   3, 2, (uint8_t[]) {1, 1, 1, 1, 0, 1},
 			   (struct item_data) {.id = ITEM_DIAMOND}, false);
-	recipe_add(recipes_crafting,
+	recipe_add(&recipes_crafting,
 			   (struct item_data) {
 				   .id = ITEM_DIAMOND_CHESTPLATE, .durability = 0, .count = 1},
 			   3, 3, (uint8_t[]) {1, 0, 1, 1, 1, 1, 1, 1, 1},
 			   (struct item_data) {.id = ITEM_DIAMOND}, false);
-	recipe_add(recipes_crafting,
+	recipe_add(&recipes_crafting,
 			   (struct item_data) {
 				   .id = ITEM_DIAMOND_LEGGINGS, .durability = 0, .count = 1},
 			   3, 3, (uint8_t[]) {1, 1, 1, 1, 0, 1, 1, 0, 1},
 			   (struct item_data) {.id = ITEM_DIAMOND}, false);
-	recipe_add(recipes_crafting,
+	recipe_add(&recipes_crafting,
 			   (struct item_data) {
 				   .id = ITEM_DIAMOND_BOOTS, .durability = 0, .count = 1},
 			   3, 2, (uint8_t[]) {1, 0, 1, 1, 0, 1},
@@ -295,227 +303,228 @@ static void add_armor() {
 }
 
 void recipe_init() {
-	array_recipe_init(recipes_crafting);
+	array_recipe_init(recipes_crafting.recipes);
+	dict_recipe_index_init(recipes_crafting.index);
 
-	recipe_add(recipes_crafting,
+	recipe_add(&recipes_crafting,
 			   (struct item_data) {.id = ITEM_BOW, .durability = 0, .count = 1},
 			   3, 3, (uint8_t[]) {0, 1, 2, 1, 0, 2, 0, 1, 2},
 			   (struct item_data) {.id = ITEM_STICK}, false,
 			   (struct item_data) {.id = ITEM_STRING}, false);
 
 	recipe_add(
-		recipes_crafting,
+		&recipes_crafting,
 		(struct item_data) {.id = BLOCK_GOLD_CAST, .durability = 0, .count = 1},
 		3, 3, (uint8_t[]) {1, 1, 1, 1, 1, 1, 1, 1, 1},
 		(struct item_data) {.id = ITEM_GOLD}, false);
 	recipe_add(
-		recipes_crafting,
+		&recipes_crafting,
 		(struct item_data) {.id = BLOCK_IRON_CAST, .durability = 0, .count = 1},
 		3, 3, (uint8_t[]) {1, 1, 1, 1, 1, 1, 1, 1, 1},
 		(struct item_data) {.id = ITEM_IRON}, false);
-	recipe_add(recipes_crafting,
+	recipe_add(&recipes_crafting,
 			   (struct item_data) {
 				   .id = BLOCK_DIAMOND_CAST, .durability = 0, .count = 1},
 			   3, 3, (uint8_t[]) {1, 1, 1, 1, 1, 1, 1, 1, 1},
 			   (struct item_data) {.id = ITEM_DIAMOND}, false);
-	recipe_add(recipes_crafting,
+	recipe_add(&recipes_crafting,
 			   (struct item_data) {
 				   .id = BLOCK_LAPIS_CAST, .durability = 0, .count = 1},
 			   3, 3, (uint8_t[]) {1, 1, 1, 1, 1, 1, 1, 1, 1},
 			   (struct item_data) {.id = ITEM_DYE, .durability = 4}, true);
 	recipe_add(
-		recipes_crafting,
+		&recipes_crafting,
 		(struct item_data) {.id = BLOCK_CHEST, .durability = 0, .count = 1}, 3,
 		3, (uint8_t[]) {1, 1, 1, 1, 0, 1, 1, 1, 1},
 		(struct item_data) {.id = BLOCK_PLANKS}, false);
 	recipe_add(
-		recipes_crafting,
+		&recipes_crafting,
 		(struct item_data) {.id = BLOCK_IRON_CHEST, .durability = 0, .count = 1}, 3,
 		3, (uint8_t[]) {1, 1, 1, 1, 0, 1, 1, 1, 1},
 		(struct item_data) {.id = ITEM_IRON}, false);
 	recipe_add(
-		recipes_crafting,
+		&recipes_crafting,
 		(struct item_data) {.id = BLOCK_FURNACE, .durability = 0, .count = 1},
 		3, 3, (uint8_t[]) {1, 1, 1, 1, 0, 1, 1, 1, 1},
 		(struct item_data) {.id = BLOCK_COBBLESTONE}, false);
 	recipe_add(
-		recipes_crafting,
+		&recipes_crafting,
 		(struct item_data) {.id = BLOCK_JUKEBOX, .durability = 0, .count = 1},
 		3, 3, (uint8_t[]) {1, 1, 1, 1, 2, 1, 1, 1, 1},
 		(struct item_data) {.id = BLOCK_PLANKS}, false,
 		(struct item_data) {.id = ITEM_DIAMOND}, false);
 	recipe_add(
-		recipes_crafting,
+		&recipes_crafting,
 		(struct item_data) {.id = BLOCK_NOTEBLOCK, .durability = 0, .count = 1},
 		3, 3, (uint8_t[]) {1, 1, 1, 1, 2, 1, 1, 1, 1},
 		(struct item_data) {.id = BLOCK_PLANKS}, false,
 		(struct item_data) {.id = ITEM_REDSTONE}, false);
 	recipe_add(
-		recipes_crafting,
+		&recipes_crafting,
 		(struct item_data) {.id = BLOCK_BOOKSHELF, .durability = 0, .count = 1},
 		3, 3, (uint8_t[]) {1, 1, 1, 2, 2, 2, 1, 1, 1},
 		(struct item_data) {.id = BLOCK_PLANKS}, false,
 		(struct item_data) {.id = ITEM_BOOK}, false);
 	recipe_add(
-		recipes_crafting,
+		&recipes_crafting,
 		(struct item_data) {.id = BLOCK_TNT, .durability = 0, .count = 1}, 3, 3,
 		(uint8_t[]) {1, 2, 1, 2, 1, 2, 1, 2, 1},
 		(struct item_data) {.id = ITEM_GUNPOWDER}, false,
 		(struct item_data) {.id = BLOCK_SAND}, false);
 	recipe_add(
-		recipes_crafting,
+		&recipes_crafting,
 		(struct item_data) {.id = BLOCK_LADDER, .durability = 0, .count = 2}, 3,
 		3, (uint8_t[]) {1, 0, 1, 1, 1, 1, 1, 0, 1},
 		(struct item_data) {.id = ITEM_STICK}, false);
 	recipe_add(
-		recipes_crafting,
+		&recipes_crafting,
 		(struct item_data) {.id = ITEM_MINECART, .durability = 0, .count = 1}, 3, 2,
 		(uint8_t[]) {1, 0, 1, 1, 1, 1}, (struct item_data) {.id = ITEM_IRON},
 		false);
 	recipe_add(
-		recipes_crafting,
+		&recipes_crafting,
 		(struct item_data) {.id = ITEM_BUCKET, .durability = 0, .count = 1}, 3, 2,
 		(uint8_t[]) {1, 0, 1, 0, 1, 0}, (struct item_data) {.id = ITEM_IRON},
 		false);
 	recipe_add(
-		recipes_crafting,
+		&recipes_crafting,
 		(struct item_data) {.id = BLOCK_RAIL, .durability = 0, .count = 16}, 3,
 		3, (uint8_t[]) {1, 0, 1, 1, 2, 1, 1, 0, 1},
 		(struct item_data) {.id = ITEM_IRON}, false,
 		(struct item_data) {.id = ITEM_STICK}, false);
-	recipe_add(recipes_crafting,
+	recipe_add(&recipes_crafting,
 			   (struct item_data) {
 				   .id = BLOCK_POWERED_RAIL, .durability = 0, .count = 6},
 			   3, 3, (uint8_t[]) {1, 0, 1, 1, 2, 1, 1, 3, 1},
 			   (struct item_data) {.id = ITEM_GOLD}, false,
 			   (struct item_data) {.id = ITEM_STICK}, false,
 			   (struct item_data) {.id = ITEM_REDSTONE}, false);
-	recipe_add(recipes_crafting,
+	recipe_add(&recipes_crafting,
 			   (struct item_data) {
 				   .id = BLOCK_DETECTOR_RAIL, .durability = 0, .count = 6},
 			   3, 3, (uint8_t[]) {1, 0, 1, 1, 2, 1, 1, 3, 1},
 			   (struct item_data) {.id = ITEM_IRON}, false,
 			   (struct item_data) {.id = BLOCK_STONE_PRESSURE_PLATE}, false,
 			   (struct item_data) {.id = ITEM_REDSTONE}, false);
-	recipe_add(recipes_crafting,
+	recipe_add(&recipes_crafting,
 			   (struct item_data) {
 				   .id = BLOCK_WOODEN_STAIRS, .durability = 0, .count = 4},
 			   3, 3, (uint8_t[]) {1, 0, 0, 1, 1, 0, 1, 1, 1},
 			   (struct item_data) {.id = BLOCK_PLANKS}, false);
-	recipe_add(recipes_crafting,
+	recipe_add(&recipes_crafting,
 			   (struct item_data) {
 				   .id = BLOCK_STONE_STAIRS, .durability = 0, .count = 4},
 			   3, 3, (uint8_t[]) {1, 0, 0, 1, 1, 0, 1, 1, 1},
 			   (struct item_data) {.id = BLOCK_COBBLESTONE}, false);
-	recipe_add(recipes_crafting,
+	recipe_add(&recipes_crafting,
 			   (struct item_data) {
 				   .id = ITEM_APPLE_GOLDEN, .durability = 0, .count = 1},
 			   3, 3, (uint8_t[]) {1, 1, 1, 1, 2, 1, 1, 1, 1},
 			   (struct item_data) {.id = BLOCK_GOLD_CAST}, false,
 			   (struct item_data) {.id = ITEM_APPLE}, false);
 	recipe_add(
-		recipes_crafting,
+		&recipes_crafting,
 		(struct item_data) {.id = BLOCK_DISPENSER, .durability = 0, .count = 1},
 		3, 3, (uint8_t[]) {1, 1, 1, 1, 2, 1, 1, 3, 1},
 		(struct item_data) {.id = BLOCK_COBBLESTONE}, false,
 		(struct item_data) {.id = ITEM_BOW}, false,
 		(struct item_data) {.id = ITEM_REDSTONE}, false);
 	recipe_add(
-		recipes_crafting,
+		&recipes_crafting,
 		(struct item_data) {.id = BLOCK_FENCE, .durability = 0, .count = 2}, 3,
 		2, (uint8_t[]) {1, 1, 1, 1, 1, 1},
 		(struct item_data) {.id = ITEM_STICK}, false);
 	recipe_add(
-		recipes_crafting,
+		&recipes_crafting,
 		(struct item_data) {.id = ITEM_DOOR_WOOD, .durability = 0, .count = 1},
 		2, 3, (uint8_t[]) {1, 1, 1, 1, 1, 1},
 		(struct item_data) {.id = BLOCK_PLANKS}, false);
 	recipe_add(
-		recipes_crafting,
+		&recipes_crafting,
 		(struct item_data) {.id = BLOCK_TRAP_DOOR, .durability = 0, .count = 2},
 		3, 2, (uint8_t[]) {1, 1, 1, 1, 1, 1},
 		(struct item_data) {.id = BLOCK_PLANKS}, false);
 	recipe_add(
-		recipes_crafting,
+		&recipes_crafting,
 		(struct item_data) {.id = BLOCK_SIGN, .durability = 0, .count = 3},
 		3, 3, (uint8_t[]) {1, 1, 1, 1, 1, 1, 0, 2, 0},
 		(struct item_data) {.id = BLOCK_PLANKS}, false,
 		(struct item_data) {.id = ITEM_STICK}, false);
 	recipe_add(
-		recipes_crafting,
+		&recipes_crafting,
 		(struct item_data) {.id = ITEM_DOOR_IRON, .durability = 0, .count = 1},
 		2, 3, (uint8_t[]) {1, 1, 1, 1, 1, 1},
 		(struct item_data) {.id = ITEM_IRON}, false);
 	recipe_add(
-		recipes_crafting,
+		&recipes_crafting,
 		(struct item_data) {.id = ITEM_BOWL, .durability = 0, .count = 4}, 3, 2,
 		(uint8_t[]) {1, 0, 1, 0, 1, 0}, (struct item_data) {.id = BLOCK_PLANKS},
 		false);
-	recipe_add(recipes_crafting,
+	recipe_add(&recipes_crafting,
 			   (struct item_data) {.id = ITEM_BED, .durability = 0, .count = 1},
 			   3, 2, (uint8_t[]) {1, 1, 1, 2, 2, 2},
 			   (struct item_data) {.id = BLOCK_WOOL}, false,
 			   (struct item_data) {.id = BLOCK_PLANKS}, false);
 	recipe_add(
-		recipes_crafting,
+		&recipes_crafting,
 		(struct item_data) {.id = ITEM_SHEARS, .durability = 0, .count = 1}, 2,
 		2, (uint8_t[]) {0, 1, 1, 0}, (struct item_data) {.id = ITEM_IRON},
 		false);
 	recipe_add(
-		recipes_crafting,
+		&recipes_crafting,
 		(struct item_data) {.id = BLOCK_WORKBENCH, .durability = 0, .count = 1},
 		2, 2, (uint8_t[]) {1, 1, 1, 1}, (struct item_data) {.id = BLOCK_PLANKS},
 		false);
 	recipe_add(
-		recipes_crafting,
+		&recipes_crafting,
 		(struct item_data) {.id = BLOCK_SANDSTONE, .durability = 0, .count = 1},
 		2, 2, (uint8_t[]) {1, 1, 1, 1}, (struct item_data) {.id = BLOCK_SAND},
 		false);
-	recipe_add(recipes_crafting,
+	recipe_add(&recipes_crafting,
 			   (struct item_data) {
 				   .id = BLOCK_SNOW_BLOCK, .durability = 0, .count = 1},
 			   2, 2, (uint8_t[]) {1, 1, 1, 1},
 			   (struct item_data) {.id = ITEM_SNOW_BALL}, false);
 	recipe_add(
-		recipes_crafting,
+		&recipes_crafting,
 		(struct item_data) {.id = BLOCK_CLAY, .durability = 0, .count = 1}, 2,
 		2, (uint8_t[]) {1, 1, 1, 1}, (struct item_data) {.id = ITEM_CLAY_BALL},
 		false);
 	recipe_add(
-		recipes_crafting,
+		&recipes_crafting,
 		(struct item_data) {.id = BLOCK_BRICKS, .durability = 0, .count = 1}, 2,
 		2, (uint8_t[]) {1, 1, 1, 1}, (struct item_data) {.id = ITEM_BRICK},
 		false);
 	recipe_add(
-		recipes_crafting,
+		&recipes_crafting,
 		(struct item_data) {.id = BLOCK_GLOWSTONE, .durability = 0, .count = 1},
 		2, 2, (uint8_t[]) {1, 1, 1, 1},
 		(struct item_data) {.id = ITEM_GLOWSTONE_DUST}, false);
 	recipe_add(
-		recipes_crafting,
+		&recipes_crafting,
 		(struct item_data) {.id = BLOCK_WOOL, .durability = 0, .count = 1}, 2,
 		2, (uint8_t[]) {1, 1, 1, 1}, (struct item_data) {.id = ITEM_STRING},
 		false);
-	recipe_add(recipes_crafting,
+	recipe_add(&recipes_crafting,
 			   (struct item_data) {
 				   .id = ITEM_FLINT_STEEL, .durability = 0, .count = 1},
 			   2, 2, (uint8_t[]) {1, 0, 0, 2},
 			   (struct item_data) {.id = ITEM_IRON}, false,
 			   (struct item_data) {.id = ITEM_FLINT}, false);
 	recipe_add(
-		recipes_crafting,
+		&recipes_crafting,
 		(struct item_data) {.id = ITEM_ARROW, .durability = 0, .count = 4}, 1,
 		3, (uint8_t[]) {1, 2, 3}, (struct item_data) {.id = ITEM_FLINT}, false,
 		(struct item_data) {.id = ITEM_STICK}, false,
 		(struct item_data) {.id = ITEM_FEATHER}, false);
-	recipe_add(recipes_crafting,
+	recipe_add(&recipes_crafting,
 			   (struct item_data) {
 				   .id = ITEM_MUSHROOM_STEW, .durability = 0, .count = 1},
 			   1, 3, (uint8_t[]) {1, 2, 3},
 			   (struct item_data) {.id = BLOCK_RED_MUSHROOM}, false,
 			   (struct item_data) {.id = BLOCK_BROWM_MUSHROOM}, false,
 			   (struct item_data) {.id = ITEM_BOWL}, false);
-	recipe_add(recipes_crafting,
+	recipe_add(&recipes_crafting,
 			   (struct item_data) {
 				   .id = ITEM_MUSHROOM_STEW, .durability = 0, .count = 1},
 			   1, 3, (uint8_t[]) {1, 2, 3},
@@ -523,93 +532,93 @@ void recipe_init() {
 			   (struct item_data) {.id = BLOCK_RED_MUSHROOM}, false,
 			   (struct item_data) {.id = ITEM_BOWL}, false);
 	recipe_add(
-		recipes_crafting,
+		&recipes_crafting,
 		(struct item_data) {.id = ITEM_PAPER, .durability = 0, .count = 3}, 3,
 		1, (uint8_t[]) {1, 1, 1}, (struct item_data) {.id = ITEM_REED}, false);
 	recipe_add(
-		recipes_crafting,
+		&recipes_crafting,
 		(struct item_data) {.id = ITEM_BOOK, .durability = 0, .count = 1}, 1, 3,
 		(uint8_t[]) {1, 1, 1}, (struct item_data) {.id = ITEM_PAPER}, false);
 	recipe_add(
-		recipes_crafting,
+		&recipes_crafting,
 		(struct item_data) {.id = BLOCK_SLAB, .durability = 3, .count = 3}, 3,
 		1, (uint8_t[]) {1, 1, 1}, (struct item_data) {.id = BLOCK_COBBLESTONE},
 		false);
 	recipe_add(
-		recipes_crafting,
+		&recipes_crafting,
 		(struct item_data) {.id = BLOCK_SLAB, .durability = 0, .count = 3}, 3,
 		1, (uint8_t[]) {1, 1, 1}, (struct item_data) {.id = BLOCK_STONE},
 		false);
 	recipe_add(
-		recipes_crafting,
+		&recipes_crafting,
 		(struct item_data) {.id = BLOCK_SLAB, .durability = 1, .count = 3}, 3,
 		1, (uint8_t[]) {1, 1, 1}, (struct item_data) {.id = BLOCK_SANDSTONE},
 		false);
 	recipe_add(
-		recipes_crafting,
+		&recipes_crafting,
 		(struct item_data) {.id = BLOCK_SLAB, .durability = 2, .count = 3}, 3,
 		1, (uint8_t[]) {1, 1, 1}, (struct item_data) {.id = BLOCK_PLANKS},
 		false);
 	recipe_add(
-		recipes_crafting,
+		&recipes_crafting,
 		(struct item_data) {.id = ITEM_BREAD, .durability = 0, .count = 1}, 3,
 		1, (uint8_t[]) {1, 1, 1}, (struct item_data) {.id = ITEM_WHEAT}, false);
 	recipe_add(
-		recipes_crafting,
+		&recipes_crafting,
 		(struct item_data) {.id = ITEM_STICK, .durability = 0, .count = 4}, 1,
 		2, (uint8_t[]) {1, 1}, (struct item_data) {.id = BLOCK_PLANKS}, false);
 	recipe_add(
-		recipes_crafting,
+		&recipes_crafting,
 		(struct item_data) {.id = BLOCK_TORCH, .durability = 0, .count = 4}, 1,
 		2, (uint8_t[]) {1, 2}, (struct item_data) {.id = ITEM_COAL}, false,
 		(struct item_data) {.id = ITEM_STICK}, false);
-	recipe_add(recipes_crafting,
+	recipe_add(&recipes_crafting,
 			   (struct item_data) {
 				   .id = BLOCK_PUMPKIN_LIT, .durability = 0, .count = 1},
 			   1, 2, (uint8_t[]) {1, 2},
 			   (struct item_data) {.id = BLOCK_PUMPKIN}, false,
 			   (struct item_data) {.id = BLOCK_TORCH}, false);
-	recipe_add(recipes_crafting,
+	recipe_add(&recipes_crafting,
 			   (struct item_data) {
 				   .id = BLOCK_REDSTONE_TORCH_LIT, .durability = 0, .count = 1},
 			   1, 2, (uint8_t[]) {1, 2},
 			   (struct item_data) {.id = ITEM_REDSTONE}, false,
 			   (struct item_data) {.id = ITEM_STICK}, false);
-	recipe_add(recipes_crafting,
+	recipe_add(&recipes_crafting,
 			   (struct item_data) {.id = BLOCK_STONE_PRESSURE_PLATE,
 								   .durability = 0,
 								   .count = 1},
 			   2, 1, (uint8_t[]) {1, 1}, (struct item_data) {.id = BLOCK_STONE},
 			   false);
-	recipe_add(recipes_crafting,
+	recipe_add(&recipes_crafting,
 			   (struct item_data) {.id = BLOCK_WOOD_PRESSURE_PLATE,
 								   .durability = 0,
 								   .count = 1},
 			   2, 1, (uint8_t[]) {1, 1},
 			   (struct item_data) {.id = BLOCK_PLANKS}, false);
 	recipe_add(
-		recipes_crafting,
+		&recipes_crafting,
 		(struct item_data) {.id = ITEM_GOLD, .durability = 0, .count = 9}, 1, 1,
 		(uint8_t[]) {1}, (struct item_data) {.id = BLOCK_GOLD_CAST}, false);
 	recipe_add(
-		recipes_crafting,
+		&recipes_crafting,
 		(struct item_data) {.id = ITEM_IRON, .durability = 0, .count = 9}, 1, 1,
 		(uint8_t[]) {1}, (struct item_data) {.id = BLOCK_IRON_CAST}, false);
 	recipe_add(
-		recipes_crafting,
+		&recipes_crafting,
 		(struct item_data) {.id = ITEM_DIAMOND, .durability = 0, .count = 9}, 1,
 		1, (uint8_t[]) {1}, (struct item_data) {.id = BLOCK_DIAMOND_CAST},
 		false);
-	recipe_add(recipes_crafting,
+	recipe_add(&recipes_crafting,
 			   (struct item_data) {.id = ITEM_DYE, .durability = 4, .count = 9},
 			   1, 1, (uint8_t[]) {1},
 			   (struct item_data) {.id = BLOCK_LAPIS_CAST}, false);
 	recipe_add(
-		recipes_crafting,
+		&recipes_crafting,
 		(struct item_data) {.id = ITEM_SUGAR, .durability = 0, .count = 1}, 1,
 		1, (uint8_t[]) {1}, (struct item_data) {.id = ITEM_REED}, false);
 	recipe_add(
-		recipes_crafting,
+		&recipes_crafting,
 		(struct item_data) {.id = BLOCK_PLANKS, .durability = 0, .count = 4}, 1,
 		1, (uint8_t[]) {1}, (struct item_data) {.id = BLOCK_LOG}, false);
 
@@ -617,8 +626,67 @@ void recipe_init() {
 	add_armor();
 }
 
-void recipe_add(array_recipe_t recipes, struct item_data result, size_t width,
-				size_t height, uint8_t* shape, ...) {
+static void recipe_pattern_trim(struct recipe_pattern* p, uint16_t* ids,
+								size_t width, size_t height) {
+	size_t min_x = width, min_y = height, max_x = 0, max_y = 0;
+
+	for(size_t y = 0; y < height; y++) {
+		for(size_t x = 0; x < width; x++) {
+			if(ids[x + y * width]) {
+				min_x = (x < min_x) ? x : min_x;
+				min_y = (y < min_y) ? y : min_y;
+				max_x = (x > max_x) ? x : max_x;
+				max_y = (y > max_y) ? y : max_y;
+			}
+		}
+	}
+
+	if(min_x > max_x) {
+		*p = (struct recipe_pattern) {.width = 0, .height = 0};
+		return;
+	}
+
+	p->width = max_x - min_x + 1;
+	p->height = max_y - min_y + 1;
+	p->x = min_x;
+	p->y = min_y;
+
+	for(size_t y = 0; y < p->height; y++) {
+		for(size_t x = 0; x < p->width; x++)
+			p->id[x + y * p->width] = ids[(x + min_x) + (y + min_y) * width];
+	}
+}
+
+// same key for a pattern and its mirror image
+static uint64_t recipe_pattern_key(struct recipe_pattern* p) {
+	size_t length = p->width * p->height;
+	uint16_t mirror[9];
+
+	for(size_t y = 0; y < p->height; y++) {
+		for(size_t x = 0; x < p->width; x++)
+			mirror[x + y * p->width]
+				= p->id[(p->width - 1 - x) + y * p->width];
+	}
+
+	uint16_t* canonical
+		= (memcmp(mirror, p->id, length * sizeof(uint16_t)) < 0) ? mirror :
+																	p->id;
+
+	// FNV-1a
+	uint64_t key = 0xCBF29CE484222325;
+	key = (key ^ p->width) * 0x100000001B3;
+	key = (key ^ p->height) * 0x100000001B3;
+
+	for(size_t k = 0; k < length; k++) {
+		key = (key ^ (canonical[k] & 0xFF)) * 0x100000001B3;
+		key = (key ^ (canonical[k] >> 8)) * 0x100000001B3;
+	}
+
+	return key;
+}
+
+void recipe_add(struct recipe_list* recipes, struct item_data result,
+				size_t width, size_t height, uint8_t* shape, ...) {
 	assert(recipes && width > 0 && height > 0 && width * height <= 9 && shape);
 
 	size_t count = 0;
@@ -641,83 +709,106 @@ void recipe_add(array_recipe_t recipes, struct item_data result, size_t width,
 
 	va_end(inputs);
 
-	struct recipe r = (struct recipe) {
-		.result = result,
-		.width = width,
-		.height = height,
-	};
+	struct recipe_ingredients full[9];
+	uint16_t ids[9];
 
 	for(size_t k = 0; k < width * height; k++) {
 		if(shape[k] > 0) {
-			r.shape[k] = ingredients[shape[k] - 1];
+			full[k] = ingredients[shape[k] - 1];
 		} else {
-			r.shape[k].item.id = 0;
+			full[k].item.id = 0;
+		}
+
+		ids[k] = full[k].item.id;
+	}
+
+	struct recipe_pattern p;
+	recipe_pattern_trim(&p, ids, width, height);
+
+	struct recipe r = (struct recipe) {
+		.result = result,
+		.width = p.width,
+		.height = p.height,
+		.key = recipe_pattern_key(&p),
+		.next = SIZE_MAX,
+	};
+
+	for(size_t y = 0; y < p.height; y++) {
+		for(size_t x = 0; x < p.width; x++)
+			r.shape[x + y * p.width] = full[(x + p.x) + (y + p.y) * width];
+	}
+
+	size_t* first = dict_recipe_index_get(recipes->index, r.key);
+
+	// chain behind recipes added earlier, those are tried first
+	if(first) {
+		size_t k = *first;
+		struct recipe* last;
+
+		while((last = array_recipe_get(recipes->recipes, k))->next != SIZE_MAX)
+			k = last->next;
+
+		last->next = array_recipe_size(recipes->recipes);
+	} else {
+		dict_recipe_index_set_at(recipes->index, r.key,
+								 array_recipe_size(recipes->recipes));
+	}
+
+	array_recipe_push_back(recipes->recipes, r);
+}
+
+static bool recipe_match_pattern(struct recipe* r, struct item_data* slots,
+								 struct recipe_pattern* p, bool flip) {
+	for(size_t y = 0; y < r->height; y++) {
+		for(size_t x = 0; x < r->width; x++) {
+			struct recipe_ingredients* in = r->shape
+				+ (flip ? (r->width - 1 - x) : x) + y * r->width;
+			struct item_data* slot = slots + (x + p->x) + (y + p->y) * 3;
+
+			if(in->item.id != p->id[x + y * p->width])
+				return false;
+
+			if(in->item.id && in->match_durability
+			   && in->item.durability != slot->durability)
+				return false;
 		}
 	}
 
-	array_recipe_push_back(recipes, r);
+	return true;
 }
 
-bool recipe_match(array_recipe_t recipes, struct item_data slots[9],
+bool recipe_match(struct recipe_list* recipes, struct item_data slots[9],
 				  bool slot_empty[9], struct item_data* result) {
 	assert(recipes && slots && slot_empty && result);
 
-	array_recipe_it_t it;
-	array_recipe_it(it, recipes);
-
-	while(!array_recipe_end_p(it)) {
-		struct recipe* current = array_recipe_ref(it);
-
-		for(size_t y = 0; y <= 3 - current->height; y++) {
-			for(size_t x = 0; x <= 3 - current->width; x++) {
-				bool match_outside_empty = true;
-
-				// check that outside of pattern is empty
-				for(size_t py = 0; py < 3 && match_outside_empty; py++) {
-					for(size_t px = 0; px < 3 && match_outside_empty; px++) {
-						if((px < x || px >= x + current->width || py < y
-							|| py >= y + current->height)
-						   && !slot_empty[px + py * 3])
-							match_outside_empty = false;
-					}
-				}
-
-				// check pattern itself
-				for(int flip = 0; flip <= 1; flip++) {
-					bool match = match_outside_empty;
-
-					for(size_t py = 0; py < current->height && match; py++) {
-						for(size_t px = 0; px < current->width && match; px++) {
-							size_t slots_idx = (px + x) + (py + y) * 3;
-							size_t shape_idx
-								= (flip ? (current->width - 1 - px) : px)
-								+ py * current->width;
-
-							if(current->shape[shape_idx].item.id == 0) {
-								if(!slot_empty[slots_idx])
-									match = false;
-							} else {
-								if(slot_empty[slots_idx]
-								   || current->shape[shape_idx].item.id
-									   != slots[slots_idx].id
-								   || (current->shape->match_durability
-									   && current->shape[shape_idx]
-											   .item.durability
-										   != slots[slots_idx].durability))
-									match = false;
-							}
-						}
-					}
-
-					if(match) {
-						*result = current->result;
-						return true;
-					}
-				}
-			}
+	uint16_t ids[9];
+	for(size_t k = 0; k < 9; k++)
+		ids[k] = slot_empty[k] ? 0 : slots[k].id;
+
+	struct recipe_pattern p;
+	recipe_pattern_trim(&p, ids, 3, 3);
+
+	if(!p.width)
+		return false;
+
+	size_t* first
+		= dict_recipe_index_get(recipes->index, recipe_pattern_key(&p));
+
+	if(!first)
+		return false;
+
+	// more than one only for hash collisions or ingredients of the same id
+	for(size_t k = *first; k != SIZE_MAX;) {
+		struct recipe* r = array_recipe_get(recipes->recipes, k);
+
+		if(r->width == p.width && r->height == p.height
+		   && (recipe_match_pattern(r, slots, &p, false)
+			   || recipe_match_pattern(r, slots, &p, true))) {
+			*result = r->result;
+			return true;
 		}
 
-		array_recipe_next(it);
+		k = r->next;
 	}
 
 	return false;
@@ -21,6 +21,7 @@
 #define RECIPE_H
 
 #include <m-lib/m-array.h>
+#include <m-lib/m-dict.h>
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
@@ -29,21 +30,32 @@
 
 struct recipe {
 	struct item_data result;
+	// trimmed to the bounding box of the ingredients
 	size_t width, height;
 	struct recipe_ingredients {
 		struct item_data item;
 		bool match_durability;
 	} shape[9];
+	// hash of the normalized pattern, next recipe with the same hash
+	uint64_t key;
+	size_t next;
 };
 
 ARRAY_DEF(array_recipe, struct recipe, M_POD_OPLIST)
+DICT_DEF2(dict_recipe_index, uint64_t, M_BASIC_OPLIST, size_t, M_BASIC_OPLIST)
 
-extern array_recipe_t recipes_crafting;
+struct recipe_list {
+	array_recipe_t recipes;
+	// key to index of the first recipe in recipes
+	dict_recipe_index_t index;
+};
+
+extern struct recipe_list recipes_crafting;
 
 void recipe_init(void);
-void recipe_add(array_recipe_t recipes, struct item_data result, size_t width,
-				size_t height, uint8_t* shape, ...);
-bool recipe_match(array_recipe_t recipes, struct item_data slots[9],
+void recipe_add(struct recipe_list* recipes, struct item_data result,
+				size_t width, size_t height, uint8_t* shape, ...);
+bool recipe_match(struct recipe_list* recipes, struct item_data slots[9],
 				  bool slot_empty[9], struct item_data* result);
 
 #endif
\ No newline at end of file
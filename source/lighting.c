@@ -31,17 +31,17 @@ void lighting_heightmap_update(uint8_t* heightmap, c_coord_t x, w_coord_t y,
 
 	uint8_t* height = heightmap + x + z * CHUNK_SIZE;
 
-	if(blocks[type]
-	   && (!blocks[type]->can_see_through || blocks[type]->opacity > 0)) {
+	if(!(block_flags[type] & BLOCK_FLAG_SEE_THROUGH)
+	   || block_opacity[type] > 0) {
 		if(y >= *height)
 			*height = y + 1;
 	} else if(y < *height) {
 		while(*height > 0) {
 			struct block_data blk;
 
-			if(get_block(user, x, *height - 1, z, &blk) && blocks[blk.type]
-			   && (!blocks[blk.type]->can_see_through
-				   || blocks[blk.type]->opacity > 0))
+			if(get_block(user, x, *height - 1, z, &blk)
+			   && (!(block_flags[blk.type] & BLOCK_FLAG_SEE_THROUGH)
+				   || block_opacity[blk.type] > 0))
 				break;
 
 			(*height)--;
@@ -91,10 +91,9 @@ void lighting_update_at_block(
 		if(!ignore_sky_light && current.y >= column_height)
 			new_light_sky = 0xF;
 
-		if(blocks[old.type])
-			new_light_torch = blocks[old.type]->luminance;
+		new_light_torch = block_luminance[old.type];
 
-		if(!blocks[old.type] || blocks[old.type]->can_see_through) {
+		if(block_flags[old.type] & BLOCK_FLAG_SEE_THROUGH) {
 			for(enum side s = 0; s < SIDE_MAX; s++) {
 				int x, y, z;
 				blocks_side_offset(s, &x, &y, &z);
@@ -105,9 +104,7 @@ void lighting_update_at_block(
 								current.z + z, &other, NULL);
 
 				if(other_exists) {
-					int8_t opacity = blocks[old.type] ?
-						MAX_I8(blocks[old.type]->opacity, 1) :
-						1;
+					int8_t opacity = MAX_I8(block_opacity[old.type], 1);
 
 					new_light_sky
 						= MAX_I8(MAX_I8((int8_t)other.sky_light - opacity, 0),
@@ -31,28 +31,38 @@
 
 #include "chunk_mesher.h"
 #include "daytime.h"
+#include "far_terrain.h"
 #include "game/game_state.h"
 #include "game/gui/screen.h"
 #include "graphics/gfx_util.h"
 #include "graphics/gui_util.h"
+#include "graphics/item_icons.h"
 #include "graphics/gfx_settings.h"
 #include "graphics/render_entity.h"
 #include "item/recipe.h"
 #include "network/client_interface.h"
+#include "network/region_archive.h"
 #include "network/server_interface.h"
 #include "network/server_local.h"
 #include "particle.h"
 #include "platform/gfx.h"
 #include "platform/input.h"
+#include "screenshot.h"
 #include "world.h"
 
 #include "cNBT/nbt.h"
 #include "cglm/cglm.h"
-#include "lodepng/lodepng.h"
 
-int main(void) {
+int main(int argc, char** argv) {
 	float daytime, tick_delta;
 	bool render_world;
+	ptime_t startup = time_get();
+
+#ifdef PLATFORM_PC
+	// offline maintenance, does not need any of the game to be set up
+	if(argc == 3 && !strcmp(argv[1], "--compact-regions"))
+		return region_archive_compact_world(argv[2]) ? 0 : 1;
+#endif
 
 	gstate.quit = false;
 	gstate.camera = (struct camera) {
@@ -78,14 +88,27 @@ int main(void) {
 #endif
 
 	config_create(&gstate.config_user, "config.json");
+	gstate.config.mesh_budget
+		= config_read_int(&gstate.config_user, "mesher.mesh_budget_kb",
+						  WORLD_MESH_BUDGET_KB)
+		* 1024;
+	gstate.config.far_distance = config_read_int(
+		&gstate.config_user, "far_terrain.distance", FAR_TERRAIN_DISTANCE);
+	gstate.config.render_distance
+		= glm_max(gstate.config.render_distance, gstate.config.far_distance);
+	gstate.config.occlusion_culling
+		= config_read_int(&gstate.config_user, "gfx.occlusion_culling", 1);
 
 	input_init();
 	blocks_init();
 	items_init();
 	render_entity_init();
+	item_icons_init();
 
 	recipe_init();
+	ptime_t startup_gfx = time_get();
 	gfx_setup();
+	gstate.stats.startup_gfx = time_diff_s(startup_gfx, time_get());
 
 	screen_set(&screen_select_world);
 
@@ -97,7 +120,9 @@ int main(void) {
 	clin_init();
 	svin_init();
 	chunk_mesher_init();
+	far_terrain_init(gstate.config.far_distance);
 	particle_init();
+	screenshot_init();
 
 	dict_entity_init(gstate.entities);
 	gstate.local_player = NULL;
@@ -109,6 +134,8 @@ int main(void) {
 
 	ptime_t last_frame = time_get();
 	ptime_t last_tick = last_frame;
+	// everything up to the first frame of the title screen
+	gstate.stats.startup = time_diff_s(startup, last_frame);
 
 	while(!gstate.quit) {
 		ptime_t this_frame = time_get();
@@ -132,6 +159,7 @@ int main(void) {
 			tick_delta -= 1.0F;
 			if(!gstate.paused) {
 				particle_update();
+				particle_update_emitters(&gstate.world);
 				entities_client_tick(gstate.entities);
 			}
 		}
@@ -220,9 +248,16 @@ int main(void) {
 		gfx_flip_buffers(&gstate.stats.dt_gpu, &gstate.stats.dt_vsync);
 
 		if(!gstate.paused) {
+			// framebuffer is still empty here
+			item_icons_bake();
+
 			// must not modify displaylists while still rendering!
-			chunk_mesher_receive();
+			gstate.stats.upload_bytes = chunk_mesher_receive();
+			far_terrain_update(gstate.camera.x, gstate.camera.z);
 			world_render_completed(&gstate.world, render_world);
+			world_evict_meshes(&gstate.world, &gstate.camera,
+							   gstate.config.mesh_budget);
+			gstate.stats.mesh_bytes = gstate.world.mesh_bytes;
 
 			vec3 top_plane_color, bottom_plane_color, atmosphere_color;
 			daytime_sky_colors(daytime, top_plane_color, bottom_plane_color,
@@ -252,8 +287,10 @@ int main(void) {
 
 				gstate.stats.chunks_rendered
 					= world_render(&gstate.world, &gstate.camera, false);
+				gstate.stats.chunks_occluded = gstate.world.chunks_occluded;
 			} else {
 				gstate.stats.chunks_rendered = 0;
+				gstate.stats.chunks_occluded = 0;
 			}
 
 			if(gstate.current_screen->render3D) {
@@ -294,30 +331,25 @@ int main(void) {
 
 		}
 
-		if(gstate.current_screen->render2D)
+		if(gstate.current_screen->render2D) {
+			gutil_batch_begin();
 			gstate.current_screen->render2D(gstate.current_screen, gfx_width(),
 											gfx_height());
+			gutil_batch_end();
+		}
 
-		if(input_pressed(IB_SCREENSHOT)) {
-			size_t width, height;
-			gfx_copy_framebuffer(NULL, &width, &height);
-
-			void* image = malloc(width * height * 4);
-
-			if(image) {
-				gfx_copy_framebuffer(image, &width, &height);
+		if(input_pressed(IB_SCREENSHOT))
+			screenshot_request(
+				config_read_int(&gstate.config_user, "screenshot.burst", 1));
 
-				char name[64];
-				snprintf(name, sizeof(name), "%ld.png", (long)time(NULL));
-
-				lodepng_encode32_file(name, image, width, height);
-				free(image);
-			}
-		}
+		screenshot_capture();
 
 		input_poll();
 		gfx_finish(true);
 	}
 
+	// encodes still queued would be lost otherwise
+	screenshot_flush();
+
 	return 0;
 }
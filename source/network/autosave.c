@@ -0,0 +1,204 @@
+/*
+	Copyright (c) 2023 ByteBit/xtreme8000
+
+	This file is part of CavEX.
+
+	CavEX is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	CavEX is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with CavEX.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <assert.h>
+#include <string.h>
+
+#include "../platform/thread.h"
+#include "autosave.h"
+#include "chunk_nbt.h"
+
+struct autosave_job {
+	struct server_world* world;
+	w_coord_t x, z;
+	struct server_chunk chunk;
+	bool active;
+};
+
+static struct autosave_job jobs[AUTOSAVE_QLENGTH];
+static struct thread_channel jobs_empty;
+static struct thread_channel jobs_pending;
+static struct thread_channel jobs_done;
+
+// only touched by the server thread
+static size_t in_flight;
+static uint32_t ticks;
+static bool pass_active;
+
+// only touched by the save thread
+static struct chunk_nbt_stream stream;
+
+static void* autosave_thread(void* user) {
+	while(1) {
+		struct autosave_job* job;
+		tchannel_receive(&jobs_pending, (void**)&job, true);
+
+		// compression is the expensive part, the disk is not locked for it
+		uint8_t* nbt;
+		size_t nbt_length;
+		if(chunk_nbt_encode(&stream, job->x, job->z, &job->chunk, &nbt,
+							&nbt_length))
+			server_world_disk_write(job->world, job->x, job->z, nbt,
+									nbt_length);
+
+		// before the job is done, so a flush also waits for this
+		server_world_disk_compact(job->world);
+
+		tchannel_send(&jobs_done, job, true);
+	}
+
+	return NULL;
+}
+
+void autosave_init() {
+	tchannel_init(&jobs_empty, AUTOSAVE_QLENGTH);
+	tchannel_init(&jobs_pending, AUTOSAVE_QLENGTH);
+	tchannel_init(&jobs_done, AUTOSAVE_QLENGTH);
+
+	for(int k = 0; k < AUTOSAVE_QLENGTH; k++) {
+		jobs[k].active = false;
+		tchannel_send(&jobs_empty, jobs + k, true);
+	}
+
+	in_flight = 0;
+	ticks = 0;
+	pass_active = false;
+	chunk_nbt_init(&stream);
+
+	struct thread t;
+	thread_create(&t, autosave_thread, NULL, 2);
+}
+
+static void autosave_finish(struct autosave_job* job) {
+	// snapshot storage goes back to the world it was taken from
+	server_world_chunk_release(job->world, &job->chunk);
+	job->active = false;
+	in_flight--;
+	tchannel_send(&jobs_empty, job, true);
+}
+
+static void autosave_submit(struct autosave_job* job, struct server_world* w,
+							w_coord_t x, w_coord_t z, struct server_chunk* sc,
+							bool snapshot) {
+	job->world = w;
+	job->x = x;
+	job->z = z;
+	job->chunk = (struct server_chunk) {
+		.modified = false,
+		.tick_pending = NULL,
+		.tile_entities = NULL,
+	};
+
+	if(snapshot) {
+		if(!server_world_chunk_alloc(w, &job->chunk)) {
+			tchannel_send(&jobs_empty, job, true);
+			return;
+		}
+
+		memcpy(job->chunk.ids, sc->ids, SERVER_CHUNK_STORAGE);
+		job->chunk.tile_entities = tile_entity_store_copy(sc->tile_entities);
+	} else {
+		// chunk is unloaded, its storage is handed over instead
+		server_chunk_storage(&job->chunk, sc->ids);
+		job->chunk.tile_entities = sc->tile_entities;
+		sc->tile_entities = NULL;
+	}
+
+	sc->modified = false;
+	job->active = true;
+	in_flight++;
+	tchannel_send(&jobs_pending, job, true);
+}
+
+bool autosave_tick(struct server_world* w) {
+	assert(w);
+
+	struct autosave_job* job;
+	while(tchannel_receive(&jobs_done, (void**)&job, false))
+		autosave_finish(job);
+
+	bool interval = ++ticks >= AUTOSAVE_INTERVAL;
+
+	if(interval) {
+		ticks = 0;
+		pass_active = true;
+	}
+
+	// the pass is spread over several ticks to not stall the server
+	size_t budget = AUTOSAVE_TICK_BUDGET;
+	while(pass_active && budget >= SERVER_CHUNK_STORAGE) {
+		if(array_chunk_ids_empty_p(w->dirty)) {
+			pass_active = false;
+			break;
+		}
+
+		int64_t id = *array_chunk_ids_back(w->dirty);
+		struct server_chunk* sc = dict_server_chunks_get(w->chunks, id);
+
+		// already saved, or unloaded in the meantime
+		if(!sc || !sc->modified) {
+			array_chunk_ids_pop_back(NULL, w->dirty);
+			continue;
+		}
+
+		// save thread is behind, continue next tick
+		if(!tchannel_receive(&jobs_empty, (void**)&job, false))
+			break;
+
+		array_chunk_ids_pop_back(NULL, w->dirty);
+		autosave_submit(job, w, S_CHUNK_X(id), S_CHUNK_Z(id), sc, true);
+		budget -= SERVER_CHUNK_STORAGE;
+	}
+
+	return interval;
+}
+
+bool autosave_pending(w_coord_t x, w_coord_t z) {
+	for(int k = 0; k < AUTOSAVE_QLENGTH; k++) {
+		if(jobs[k].active && jobs[k].x == x && jobs[k].z == z)
+			return true;
+	}
+
+	return false;
+}
+
+void autosave_chunk(struct server_world* w, w_coord_t x, w_coord_t z,
+					struct server_chunk* sc, bool snapshot) {
+	assert(w && sc);
+
+	struct autosave_job* job;
+	if(!tchannel_receive(&jobs_empty, (void**)&job, false)) {
+		tchannel_receive(&jobs_done, (void**)&job, true);
+		autosave_finish(job);
+		tchannel_receive(&jobs_empty, (void**)&job, true);
+	}
+
+	autosave_submit(job, w, x, z, sc, snapshot);
+}
+
+void autosave_flush() {
+	while(in_flight > 0) {
+		struct autosave_job* job;
+		tchannel_receive(&jobs_done, (void**)&job, true);
+		autosave_finish(job);
+	}
+
+	ticks = 0;
+	pass_active = false;
+}
@@ -0,0 +1,42 @@
+/*
+	Copyright (c) 2023 ByteBit/xtreme8000
+
+	This file is part of CavEX.
+
+	CavEX is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	CavEX is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with CavEX.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef AUTOSAVE_H
+#define AUTOSAVE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "../world.h"
+#include "server_world.h"
+
+// ticks between two passes over the dirty chunks
+#define AUTOSAVE_INTERVAL (20 * 30)
+#define AUTOSAVE_QLENGTH 16
+// amount of chunk data copied for saving in a single tick
+#define AUTOSAVE_TICK_BUDGET (4 * SERVER_CHUNK_STORAGE)
+
+void autosave_init(void);
+bool autosave_tick(struct server_world* w);
+bool autosave_pending(w_coord_t x, w_coord_t z);
+void autosave_chunk(struct server_world* w, w_coord_t x, w_coord_t z,
+					struct server_chunk* sc, bool snapshot);
+void autosave_flush(void);
+
+#endif
@@ -0,0 +1,158 @@
+/*
+	Copyright (c) 2023 ByteBit/xtreme8000
+
+	This file is part of CavEX.
+
+	CavEX is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	CavEX is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with CavEX.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <assert.h>
+#include <stdlib.h>
+
+#include "../block/blocks.h"
+#include "block_tick.h"
+#include "fluid.h"
+#include "server_local.h"
+#include "server_world.h"
+
+/* Blocks that change over time (fluids, burning fuses, pressure plates)
+ * schedule themselves a few ticks into the future. Only those positions are
+ * visited, the rest of the world costs nothing per tick. */
+
+#define BLOCK_TICKS_PER_TICK 1024
+
+#define PENDING_IDX(x, y, z)                                                   \
+	((y) + (W2C_COORD(z) + W2C_COORD(x) * CHUNK_SIZE) * WORLD_HEIGHT)
+
+void block_tick_init(struct block_tick_sched* t) {
+	assert(t);
+
+	for(int k = 0; k < BLOCK_TICK_WHEEL_SIZE; k++)
+		array_block_tick_pos_init(t->wheel[k]);
+
+	t->tick = 0;
+}
+
+void block_tick_destroy(struct block_tick_sched* t) {
+	assert(t);
+
+	for(int k = 0; k < BLOCK_TICK_WHEEL_SIZE; k++)
+		array_block_tick_pos_clear(t->wheel[k]);
+}
+
+static bool pending_test_and_set(struct server_chunk* sc, size_t idx,
+								 bool value) {
+	if(!sc->tick_pending) {
+		if(!value)
+			return false;
+
+		sc->tick_pending
+			= calloc(CHUNK_SIZE * CHUNK_SIZE * WORLD_HEIGHT / 8, 1);
+		assert(sc->tick_pending);
+	}
+
+	bool prev = sc->tick_pending[idx / 8] & (1 << (idx % 8));
+
+	if(value)
+		sc->tick_pending[idx / 8] |= (1 << (idx % 8));
+	else
+		sc->tick_pending[idx / 8] &= ~(1 << (idx % 8));
+
+	return prev;
+}
+
+void block_tick_schedule(struct server_world* w, w_coord_t x, w_coord_t y,
+						 w_coord_t z, uint32_t delay) {
+	assert(w && delay > 0 && delay < BLOCK_TICK_WHEEL_SIZE);
+
+	if(y < 0 || y >= WORLD_HEIGHT)
+		return;
+
+	struct server_chunk* sc = dict_server_chunks_get(
+		w->chunks, S_CHUNK_ID(WCOORD_CHUNK_OFFSET(x), WCOORD_CHUNK_OFFSET(z)));
+
+	// already waiting for its turn
+	if(!sc || pending_test_and_set(sc, PENDING_IDX(x, y, z), true))
+		return;
+
+	array_block_tick_pos_push_back(
+		w->ticks.wheel[(w->ticks.tick + delay) % BLOCK_TICK_WHEEL_SIZE],
+		(struct block_tick_pos) {x, y, z});
+}
+
+static void block_tick_update(struct server_local* s, w_coord_t x,
+							  w_coord_t y, w_coord_t z) {
+	struct block_data blk;
+	if(!server_world_get_block(&s->world, x, y, z, &blk))
+		return;
+
+	if(fluid_is(blk.type)) {
+		fluid_update(s, x, y, z);
+	} else if(blocks[blk.type] && blocks[blk.type]->onWorldTick) {
+		blocks[blk.type]->onWorldTick(s,
+									  &(struct block_info) {
+										  .block = &blk,
+										  .neighbours = NULL,
+										  .x = x,
+										  .y = y,
+										  .z = z,
+									  });
+	}
+}
+
+void block_tick_run(struct server_local* s) {
+	assert(s);
+
+	struct server_world* w = &s->world;
+	struct block_tick_sched* t = &w->ticks;
+	array_block_tick_pos_t* slot = t->wheel + t->tick % BLOCK_TICK_WHEEL_SIZE;
+	size_t count = array_block_tick_pos_size(*slot);
+
+	if(!count) {
+		t->tick++;
+		return;
+	}
+
+	// updates scheduled from within this tick are due in the future
+	array_block_tick_pos_t due;
+	array_block_tick_pos_init(due);
+	array_block_tick_pos_swap(due, *slot);
+	t->tick++;
+
+	server_world_batch_begin(w);
+
+	for(size_t k = 0; k < count; k++) {
+		struct block_tick_pos p = *array_block_tick_pos_get(due, k);
+		struct server_chunk* sc = dict_server_chunks_get(
+			w->chunks,
+			S_CHUNK_ID(WCOORD_CHUNK_OFFSET(p.x), WCOORD_CHUNK_OFFSET(p.z)));
+
+		// chunk was unloaded in the meantime
+		if(!sc)
+			continue;
+
+		if(k >= BLOCK_TICKS_PER_TICK) {
+			// over budget, stays pending and is retried next tick
+			array_block_tick_pos_push_back(
+				t->wheel[t->tick % BLOCK_TICK_WHEEL_SIZE], p);
+			continue;
+		}
+
+		if(pending_test_and_set(sc, PENDING_IDX(p.x, p.y, p.z), false))
+			block_tick_update(s, p.x, p.y, p.z);
+	}
+
+	server_world_batch_end(w);
+	array_block_tick_pos_clear(due);
+}
@@ -0,0 +1,52 @@
+/*
+	Copyright (c) 2023 ByteBit/xtreme8000
+
+	This file is part of CavEX.
+
+	CavEX is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	CavEX is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with CavEX.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef BLOCK_TICK_H
+#define BLOCK_TICK_H
+
+#include <m-lib/m-array.h>
+#include <stdint.h>
+
+#include "../world.h"
+
+struct server_local;
+struct server_world;
+
+struct block_tick_pos {
+	w_coord_t x, y, z;
+};
+
+ARRAY_DEF(array_block_tick_pos, struct block_tick_pos, M_POD_OPLIST)
+
+// longest delay is lava with 30 ticks
+#define BLOCK_TICK_WHEEL_SIZE 32
+
+struct block_tick_sched {
+	// scheduled updates, indexed by due tick
+	array_block_tick_pos_t wheel[BLOCK_TICK_WHEEL_SIZE];
+	uint32_t tick;
+};
+
+void block_tick_init(struct block_tick_sched* t);
+void block_tick_destroy(struct block_tick_sched* t);
+void block_tick_schedule(struct server_world* w, w_coord_t x, w_coord_t y,
+						 w_coord_t z, uint32_t delay);
+void block_tick_run(struct server_local* s);
+
+#endif
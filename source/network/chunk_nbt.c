@@ -0,0 +1,757 @@
+/*
+	Copyright (c) 2023 ByteBit/xtreme8000
+
+	This file is part of CavEX.
+
+	CavEX is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	CavEX is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with CavEX.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "chunk_nbt.h"
+#include "server_world.h"
+#include "tile_entity.h"
+
+enum nbt_tag {
+	NBT_END = 0,
+	NBT_BYTE = 1,
+	NBT_SHORT = 2,
+	NBT_INT = 3,
+	NBT_LONG = 4,
+	NBT_FLOAT = 5,
+	NBT_DOUBLE = 6,
+	NBT_BYTE_ARRAY = 7,
+	NBT_STRING = 8,
+	NBT_LIST = 9,
+	NBT_COMPOUND = 10,
+	NBT_INT_ARRAY = 11,
+	NBT_LONG_ARRAY = 12,
+};
+
+#define NBT_MAX_DEPTH 32
+#define NBT_MAX_NAME 32
+
+void chunk_nbt_init(struct chunk_nbt_stream* s) {
+	assert(s);
+
+	*s = (struct chunk_nbt_stream) {
+		.inflate_init = false,
+		.deflate_init = false,
+		.in = NULL,
+		.scratch = NULL,
+		.out = NULL,
+		.out_capacity = 0,
+	};
+}
+
+void chunk_nbt_destroy(struct chunk_nbt_stream* s) {
+	assert(s);
+
+	if(s->inflate_init)
+		inflateEnd(&s->inflate);
+
+	if(s->deflate_init)
+		deflateEnd(&s->deflate);
+
+	free(s->in);
+	free(s->scratch);
+	free(s->out);
+	chunk_nbt_init(s);
+}
+
+static bool stream_read(struct chunk_nbt_stream* s, void* dst, size_t length) {
+	s->inflate.next_out = dst;
+	s->inflate.avail_out = length;
+
+	while(s->inflate.avail_out > 0) {
+		if(s->inflate.avail_in == 0) {
+			size_t n = s->remaining < CHUNK_NBT_BUFFER ? s->remaining :
+														 CHUNK_NBT_BUFFER;
+
+			if(!n || fread(s->in, n, 1, s->file) != 1)
+				return false;
+
+			s->remaining -= n;
+			s->inflate.next_in = s->in;
+			s->inflate.avail_in = n;
+		}
+
+		int res = inflate(&s->inflate, Z_NO_FLUSH);
+
+		if(res == Z_STREAM_END)
+			return s->inflate.avail_out == 0;
+
+		if(res != Z_OK && res != Z_BUF_ERROR)
+			return false;
+	}
+
+	return true;
+}
+
+static bool stream_skip(struct chunk_nbt_stream* s, size_t length) {
+	while(length > 0) {
+		size_t n = length < CHUNK_NBT_BUFFER ? length : CHUNK_NBT_BUFFER;
+
+		if(!stream_read(s, s->scratch, n))
+			return false;
+
+		length -= n;
+	}
+
+	return true;
+}
+
+static bool stream_read_u8(struct chunk_nbt_stream* s, uint8_t* out) {
+	return stream_read(s, out, sizeof(uint8_t));
+}
+
+static bool stream_read_u16(struct chunk_nbt_stream* s, uint16_t* out) {
+	uint8_t tmp[2];
+
+	if(!stream_read(s, tmp, sizeof(tmp)))
+		return false;
+
+	*out = (tmp[0] << 8) | tmp[1];
+	return true;
+}
+
+static bool stream_read_s16(struct chunk_nbt_stream* s, int16_t* out) {
+	uint16_t tmp;
+
+	if(!stream_read_u16(s, &tmp))
+		return false;
+
+	*out = (int16_t)tmp;
+	return true;
+}
+
+static bool stream_read_s32(struct chunk_nbt_stream* s, int32_t* out) {
+	uint8_t tmp[4];
+
+	if(!stream_read(s, tmp, sizeof(tmp)))
+		return false;
+
+	*out = (int32_t)(((uint32_t)tmp[0] << 24) | (tmp[1] << 16) | (tmp[2] << 8)
+					 | tmp[3]);
+	return true;
+}
+
+// names too long for the buffer are skipped and reported as empty
+static bool stream_read_name(struct chunk_nbt_stream* s,
+							 char name[NBT_MAX_NAME]) {
+	uint16_t length;
+
+	if(!stream_read_u16(s, &length))
+		return false;
+
+	if(length >= NBT_MAX_NAME) {
+		*name = 0;
+		return stream_skip(s, length);
+	}
+
+	name[length] = 0;
+	return stream_read(s, name, length);
+}
+
+// strings longer than max are cut off
+static bool stream_read_string(struct chunk_nbt_stream* s, char* dst,
+							   size_t max, size_t* out_length) {
+	uint16_t length;
+
+	if(!stream_read_u16(s, &length))
+		return false;
+
+	size_t n = length < max ? length : max;
+	*out_length = n;
+	return stream_read(s, dst, n) && stream_skip(s, length - n);
+}
+
+static bool stream_skip_payload(struct chunk_nbt_stream* s, uint8_t type,
+								size_t depth) {
+	if(depth > NBT_MAX_DEPTH)
+		return false;
+
+	int32_t length;
+	uint16_t str_length;
+
+	switch(type) {
+		case NBT_BYTE: return stream_skip(s, 1);
+		case NBT_SHORT: return stream_skip(s, 2);
+		case NBT_INT:
+		case NBT_FLOAT: return stream_skip(s, 4);
+		case NBT_LONG:
+		case NBT_DOUBLE: return stream_skip(s, 8);
+		case NBT_STRING:
+			return stream_read_u16(s, &str_length)
+				&& stream_skip(s, str_length);
+		case NBT_BYTE_ARRAY:
+		case NBT_INT_ARRAY:
+		case NBT_LONG_ARRAY:
+			if(!stream_read_s32(s, &length) || length < 0)
+				return false;
+
+			return stream_skip(s,
+							   (size_t)length
+								   * (type == NBT_BYTE_ARRAY ?
+										  1 :
+										  (type == NBT_INT_ARRAY ? 4 : 8)));
+		case NBT_LIST: {
+			uint8_t element;
+			if(!stream_read_u8(s, &element) || !stream_read_s32(s, &length)
+			   || length < 0)
+				return false;
+
+			for(int32_t k = 0; k < length; k++) {
+				if(!stream_skip_payload(s, element, depth + 1))
+					return false;
+			}
+
+			return true;
+		}
+		case NBT_COMPOUND:
+			while(1) {
+				uint8_t tag;
+				char name[NBT_MAX_NAME];
+
+				if(!stream_read_u8(s, &tag))
+					return false;
+
+				if(tag == NBT_END)
+					return true;
+
+				if(!stream_read_name(s, name)
+				   || !stream_skip_payload(s, tag, depth + 1))
+					return false;
+			}
+		default: return false;
+	}
+}
+
+static bool stream_read_items(struct chunk_nbt_stream* s,
+							  struct item_data* items) {
+	uint8_t element;
+	int32_t length;
+
+	if(!stream_read_u8(s, &element) || !stream_read_s32(s, &length)
+	   || length < 0)
+		return false;
+
+	for(int32_t k = 0; k < length; k++) {
+		if(element != NBT_COMPOUND) {
+			if(!stream_skip_payload(s, element, 2))
+				return false;
+			continue;
+		}
+
+		struct item_data item = (struct item_data) {0};
+		uint8_t slot = MAX_CHEST_SLOTS;
+
+		while(1) {
+			uint8_t tag;
+			char name[NBT_MAX_NAME];
+
+			if(!stream_read_u8(s, &tag))
+				return false;
+
+			if(tag == NBT_END)
+				break;
+
+			if(!stream_read_name(s, name))
+				return false;
+
+			int16_t value;
+			bool res;
+
+			if(tag == NBT_BYTE && !strcmp(name, "Slot")) {
+				res = stream_read_u8(s, &slot);
+			} else if(tag == NBT_BYTE && !strcmp(name, "Count")) {
+				res = stream_read_u8(s, &item.count);
+			} else if(tag == NBT_SHORT && !strcmp(name, "id")) {
+				res = stream_read_s16(s, &value);
+				item.id = value;
+			} else if(tag == NBT_SHORT && !strcmp(name, "Damage")) {
+				res = stream_read_s16(s, &value);
+				item.durability = value;
+			} else {
+				res = stream_skip_payload(s, tag, 3);
+			}
+
+			if(!res)
+				return false;
+		}
+
+		if(slot < MAX_CHEST_SLOTS)
+			items[slot] = item;
+	}
+
+	return true;
+}
+
+static bool stream_read_tile_entity(struct chunk_nbt_stream* s,
+									struct tile_entity* te, bool* valid) {
+	char id[NBT_MAX_NAME] = "";
+	struct item_data items[MAX_CHEST_SLOTS];
+	char text[SIGN_SIZE];
+	w_coord_t pos[3] = {0, -1, 0};
+
+	memset(items, 0, sizeof(items));
+	memset(text, ' ', sizeof(text));
+
+	while(1) {
+		uint8_t tag;
+		char name[NBT_MAX_NAME];
+
+		if(!stream_read_u8(s, &tag))
+			return false;
+
+		if(tag == NBT_END)
+			break;
+
+		if(!stream_read_name(s, name))
+			return false;
+
+		bool res;
+		size_t length = 0;
+
+		if(tag == NBT_STRING && !strcmp(name, "id")) {
+			res = stream_read_string(s, id, sizeof(id) - 1, &length);
+
+			if(res)
+				id[length] = 0;
+		} else if(tag == NBT_INT && strlen(name) == 1 && *name >= 'x'
+				  && *name <= 'z') {
+			int32_t value;
+			res = stream_read_s32(s, &value);
+			pos[*name - 'x'] = value;
+		} else if(tag == NBT_LIST && !strcmp(name, "Items")) {
+			res = stream_read_items(s, items);
+		} else if(tag == NBT_STRING && !strncmp(name, "Text", 4)
+				  && name[4] >= '1' && name[4] < '1' + SIGN_LINES && !name[5]) {
+			// lines are padded with spaces, like the sign screen expects
+			res = stream_read_string(s,
+									 text + (name[4] - '1') * SIGN_LINE_LENGTH,
+									 SIGN_LINE_LENGTH, &length);
+		} else {
+			res = stream_skip_payload(s, tag, 2);
+		}
+
+		if(!res)
+			return false;
+	}
+
+	*valid = true;
+
+	if(!strcmp(id, "Chest")) {
+		tile_entity_init(te, TILE_ENTITY_CHEST, pos[0], pos[1], pos[2]);
+		memcpy(te->payload.items, items, sizeof(items));
+	} else if(!strcmp(id, "Sign")) {
+		tile_entity_init(te, TILE_ENTITY_SIGN, pos[0], pos[1], pos[2]);
+		memcpy(te->payload.text, text, sizeof(text));
+	} else {
+		*valid = false;
+	}
+
+	return true;
+}
+
+static bool stream_read_tile_entities(struct chunk_nbt_stream* s, w_coord_t x,
+									  w_coord_t z, struct server_chunk* sc) {
+	uint8_t element;
+	int32_t length;
+
+	if(!stream_read_u8(s, &element) || !stream_read_s32(s, &length)
+	   || length < 0)
+		return false;
+
+	for(int32_t k = 0; k < length; k++) {
+		if(element != NBT_COMPOUND) {
+			if(!stream_skip_payload(s, element, 2))
+				return false;
+			continue;
+		}
+
+		struct tile_entity te;
+		bool valid;
+
+		if(!stream_read_tile_entity(s, &te, &valid))
+			return false;
+
+		// furnaces and others are not supported yet, they are dropped
+		if(valid && te.y >= 0 && te.y < WORLD_HEIGHT
+		   && WCOORD_CHUNK_OFFSET(te.x) == x && WCOORD_CHUNK_OFFSET(te.z) == z)
+			tile_entity_store_add(&sc->tile_entities, &te);
+	}
+
+	return true;
+}
+
+struct level_array {
+	const char* name;
+	uint8_t* data;
+	int32_t length;
+	bool found;
+};
+
+static bool stream_read_level(struct chunk_nbt_stream* s, w_coord_t x,
+							  w_coord_t z, struct server_chunk* sc) {
+	struct level_array arrays[] = {
+		{"Blocks", sc->ids, CHUNK_SIZE * CHUNK_SIZE * WORLD_HEIGHT, false},
+		{"Data", sc->metadata, CHUNK_SIZE * CHUNK_SIZE * WORLD_HEIGHT / 2,
+		 false},
+		{"SkyLight", sc->lighting_sky,
+		 CHUNK_SIZE * CHUNK_SIZE * WORLD_HEIGHT / 2, false},
+		{"BlockLight", sc->lighting_torch,
+		 CHUNK_SIZE * CHUNK_SIZE * WORLD_HEIGHT / 2, false},
+		{"HeightMap", sc->heightmap, CHUNK_SIZE * CHUNK_SIZE, false},
+	};
+
+	bool found_x = false, found_z = false;
+
+	while(1) {
+		uint8_t tag;
+		char name[NBT_MAX_NAME];
+
+		if(!stream_read_u8(s, &tag))
+			return false;
+
+		if(tag == NBT_END)
+			break;
+
+		if(!stream_read_name(s, name))
+			return false;
+
+		bool consumed = false;
+
+		if(tag == NBT_BYTE_ARRAY) {
+			for(size_t k = 0; k < sizeof(arrays) / sizeof(*arrays); k++) {
+				if(!strcmp(name, arrays[k].name)) {
+					int32_t length;
+					if(!stream_read_s32(s, &length)
+					   || length != arrays[k].length
+					   || !stream_read(s, arrays[k].data, length))
+						return false;
+
+					arrays[k].found = true;
+					consumed = true;
+					break;
+				}
+			}
+		} else if(tag == NBT_LIST && !strcmp(name, "TileEntities")) {
+			if(!stream_read_tile_entities(s, x, z, sc))
+				return false;
+
+			consumed = true;
+		} else if(tag == NBT_INT && !strcmp(name, "xPos")) {
+			int32_t pos;
+			if(!stream_read_s32(s, &pos) || pos != x)
+				return false;
+
+			found_x = consumed = true;
+		} else if(tag == NBT_INT && !strcmp(name, "zPos")) {
+			int32_t pos;
+			if(!stream_read_s32(s, &pos) || pos != z)
+				return false;
+
+			found_z = consumed = true;
+		}
+
+		if(!consumed && !stream_skip_payload(s, tag, 1))
+			return false;
+	}
+
+	for(size_t k = 0; k < sizeof(arrays) / sizeof(*arrays); k++) {
+		if(!arrays[k].found)
+			return false;
+	}
+
+	return found_x && found_z;
+}
+
+bool chunk_nbt_decode(struct chunk_nbt_stream* s, FILE* f, size_t length,
+					  w_coord_t x, w_coord_t z, struct server_chunk* sc) {
+	assert(s && f && sc);
+	assert(sc->ids && sc->metadata && sc->lighting_sky && sc->lighting_torch
+		   && sc->heightmap);
+
+	if(!s->in)
+		s->in = malloc(CHUNK_NBT_BUFFER);
+
+	if(!s->scratch)
+		s->scratch = malloc(CHUNK_NBT_BUFFER);
+
+	if(!s->in || !s->scratch)
+		return false;
+
+	s->inflate.next_in = NULL;
+	s->inflate.avail_in = 0;
+
+	if(!s->inflate_init) {
+		s->inflate.zalloc = Z_NULL;
+		s->inflate.zfree = Z_NULL;
+		s->inflate.opaque = Z_NULL;
+
+		// accepts both gzip and zlib headers
+		if(inflateInit2(&s->inflate, 15 + 32) != Z_OK)
+			return false;
+
+		s->inflate_init = true;
+	} else if(inflateReset(&s->inflate) != Z_OK) {
+		return false;
+	}
+
+	s->file = f;
+	s->remaining = length;
+
+	uint8_t tag;
+	char name[NBT_MAX_NAME];
+
+	if(!stream_read_u8(s, &tag) || tag != NBT_COMPOUND
+	   || !stream_read_name(s, name))
+		return false;
+
+	// everything after the level compound is of no interest
+	while(1) {
+		if(!stream_read_u8(s, &tag) || tag == NBT_END
+		   || !stream_read_name(s, name))
+			return false;
+
+		if(tag == NBT_COMPOUND && !strcmp(name, "Level"))
+			return stream_read_level(s, x, z, sc);
+
+		if(!stream_skip_payload(s, tag, 1))
+			return false;
+	}
+}
+
+static bool stream_deflate(struct chunk_nbt_stream* s, int flush) {
+	while(1) {
+		if(s->deflate.avail_out == 0) {
+			size_t used = s->out_capacity;
+			uint8_t* tmp = realloc(s->out, s->out_capacity * 2);
+
+			if(!tmp)
+				return false;
+
+			s->out = tmp;
+			s->out_capacity *= 2;
+			s->deflate.next_out = s->out + used;
+			s->deflate.avail_out = s->out_capacity - used;
+		}
+
+		int res = deflate(&s->deflate, flush);
+
+		if(res == Z_STREAM_END)
+			return true;
+
+		if(res != Z_OK && res != Z_BUF_ERROR)
+			return false;
+
+		if(flush == Z_NO_FLUSH && s->deflate.avail_in == 0)
+			return true;
+	}
+}
+
+static bool stream_write(struct chunk_nbt_stream* s, const void* data,
+						 size_t length) {
+	s->deflate.next_in = (uint8_t*)data;
+	s->deflate.avail_in = length;
+	return stream_deflate(s, Z_NO_FLUSH);
+}
+
+static bool stream_write_tag(struct chunk_nbt_stream* s, uint8_t type,
+							 const char* name) {
+	size_t length = strlen(name);
+	assert(length < NBT_MAX_NAME);
+
+	uint8_t tmp[NBT_MAX_NAME + 3];
+	tmp[0] = type;
+	tmp[1] = length >> 8;
+	tmp[2] = length & 0xFF;
+	memcpy(tmp + 3, name, length);
+
+	return stream_write(s, tmp, length + 3);
+}
+
+static bool stream_write_s32(struct chunk_nbt_stream* s, int32_t value) {
+	uint32_t v = value;
+	return stream_write(
+		s, (uint8_t[]) {v >> 24, (v >> 16) & 0xFF, (v >> 8) & 0xFF, v & 0xFF},
+		4);
+}
+
+static bool stream_write_s16(struct chunk_nbt_stream* s, int16_t value) {
+	uint16_t v = value;
+	return stream_write(s, (uint8_t[]) {v >> 8, v & 0xFF}, 2);
+}
+
+static bool stream_write_string(struct chunk_nbt_stream* s, const char* str,
+								size_t length) {
+	return stream_write(s, (uint8_t[]) {length >> 8, length & 0xFF}, 2)
+		&& stream_write(s, str, length);
+}
+
+static bool stream_write_array(struct chunk_nbt_stream* s, const char* name,
+							   uint8_t* data, int32_t length) {
+	return stream_write_tag(s, NBT_BYTE_ARRAY, name)
+		&& stream_write_s32(s, length) && stream_write(s, data, length);
+}
+
+static bool stream_write_empty_list(struct chunk_nbt_stream* s,
+									const char* name) {
+	return stream_write_tag(s, NBT_LIST, name)
+		&& stream_write(s, (uint8_t[]) {NBT_COMPOUND}, 1)
+		&& stream_write_s32(s, 0);
+}
+
+static bool stream_write_tile_entity(struct chunk_nbt_stream* s,
+									 struct tile_entity* te) {
+	const char* id = (te->type == TILE_ENTITY_CHEST) ? "Chest" : "Sign";
+
+	bool res = stream_write_tag(s, NBT_STRING, "id")
+		&& stream_write_string(s, id, strlen(id))
+		&& stream_write_tag(s, NBT_INT, "x") && stream_write_s32(s, te->x)
+		&& stream_write_tag(s, NBT_INT, "y") && stream_write_s32(s, te->y)
+		&& stream_write_tag(s, NBT_INT, "z") && stream_write_s32(s, te->z);
+
+	if(te->type == TILE_ENTITY_CHEST) {
+		int32_t count = 0;
+		for(size_t k = 0; k < MAX_CHEST_SLOTS; k++) {
+			if(te->payload.items[k].id)
+				count++;
+		}
+
+		res = res && stream_write_tag(s, NBT_LIST, "Items")
+			&& stream_write(s, (uint8_t[]) {NBT_COMPOUND}, 1)
+			&& stream_write_s32(s, count);
+
+		for(size_t k = 0; k < MAX_CHEST_SLOTS && res; k++) {
+			struct item_data* item = te->payload.items + k;
+
+			if(item->id)
+				res = stream_write_tag(s, NBT_BYTE, "Slot")
+					&& stream_write(s, (uint8_t[]) {k}, 1)
+					&& stream_write_tag(s, NBT_SHORT, "id")
+					&& stream_write_s16(s, item->id)
+					&& stream_write_tag(s, NBT_SHORT, "Damage")
+					&& stream_write_s16(s, item->durability)
+					&& stream_write_tag(s, NBT_BYTE, "Count")
+					&& stream_write(s, &item->count, 1)
+					&& stream_write(s, (uint8_t[]) {NBT_END}, 1);
+		}
+	} else {
+		for(size_t k = 0; k < SIGN_LINES && res; k++) {
+			const char* line = te->payload.text + k * SIGN_LINE_LENGTH;
+			size_t length = SIGN_LINE_LENGTH;
+
+			// padding is not stored
+			while(length > 0 && line[length - 1] == ' ')
+				length--;
+
+			char name[] = "Text1";
+			name[4] += k;
+
+			res = stream_write_tag(s, NBT_STRING, name)
+				&& stream_write_string(s, line, length);
+		}
+	}
+
+	return res && stream_write(s, (uint8_t[]) {NBT_END}, 1);
+}
+
+static bool stream_write_tile_entities(struct chunk_nbt_stream* s,
+									   struct tile_entity_store* store) {
+	if(!store)
+		return stream_write_empty_list(s, "TileEntities");
+
+	if(!stream_write_tag(s, NBT_LIST, "TileEntities")
+	   || !stream_write(s, (uint8_t[]) {NBT_COMPOUND}, 1)
+	   || !stream_write_s32(s, dict_tile_entities_size(store->entries)))
+		return false;
+
+	dict_tile_entities_it_t it;
+	dict_tile_entities_it(it, store->entries);
+
+	while(!dict_tile_entities_end_p(it)) {
+		if(!stream_write_tile_entity(s, dict_tile_entities_ref(it)->value))
+			return false;
+
+		dict_tile_entities_next(it);
+	}
+
+	return true;
+}
+
+bool chunk_nbt_encode(struct chunk_nbt_stream* s, w_coord_t x, w_coord_t z,
+					  struct server_chunk* sc, uint8_t** data,
+					  size_t* length) {
+	assert(s && sc && data && length);
+
+	if(!s->deflate_init) {
+		s->deflate.zalloc = Z_NULL;
+		s->deflate.zfree = Z_NULL;
+		s->deflate.opaque = Z_NULL;
+
+		if(deflateInit(&s->deflate, Z_DEFAULT_COMPRESSION) != Z_OK)
+			return false;
+
+		s->deflate_init = true;
+	} else if(deflateReset(&s->deflate) != Z_OK) {
+		return false;
+	}
+
+	if(!s->out) {
+		// compressed chunks are almost always much smaller than this
+		s->out_capacity = deflateBound(
+			&s->deflate, CHUNK_SIZE * CHUNK_SIZE * WORLD_HEIGHT / 2 * 5);
+		s->out = malloc(s->out_capacity);
+
+		if(!s->out)
+			return false;
+	}
+
+	s->deflate.next_out = s->out;
+	s->deflate.avail_out = s->out_capacity;
+
+	bool success = stream_write_tag(s, NBT_COMPOUND, "")
+		&& stream_write_tag(s, NBT_COMPOUND, "Level")
+		&& stream_write_array(s, "Blocks", sc->ids,
+							  CHUNK_SIZE * CHUNK_SIZE * WORLD_HEIGHT)
+		&& stream_write_array(s, "Data", sc->metadata,
+							  CHUNK_SIZE * CHUNK_SIZE * WORLD_HEIGHT / 2)
+		&& stream_write_array(s, "SkyLight", sc->lighting_sky,
+							  CHUNK_SIZE * CHUNK_SIZE * WORLD_HEIGHT / 2)
+		&& stream_write_array(s, "BlockLight", sc->lighting_torch,
+							  CHUNK_SIZE * CHUNK_SIZE * WORLD_HEIGHT / 2)
+		&& stream_write_array(s, "HeightMap", sc->heightmap,
+							  CHUNK_SIZE * CHUNK_SIZE)
+		&& stream_write_empty_list(s, "Entities")
+		&& stream_write_tile_entities(s, sc->tile_entities)
+		&& stream_write_tag(s, NBT_LONG, "LastUpdate")
+		&& stream_write(s, (uint8_t[8]) {0}, 8)
+		&& stream_write_tag(s, NBT_INT, "xPos") && stream_write_s32(s, x)
+		&& stream_write_tag(s, NBT_INT, "zPos") && stream_write_s32(s, z)
+		&& stream_write_tag(s, NBT_BYTE, "TerrainPopulated")
+		&& stream_write(s, (uint8_t[]) {1}, 1)
+		&& stream_write(s, (uint8_t[]) {NBT_END, NBT_END}, 2)
+		&& stream_deflate(s, Z_FINISH);
+
+	if(!success)
+		return false;
+
+	*data = s->out;
+	*length = s->deflate.total_out;
+	return true;
+}
@@ -0,0 +1,58 @@
+/*
+	Copyright (c) 2023 ByteBit/xtreme8000
+
+	This file is part of CavEX.
+
+	CavEX is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	CavEX is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with CavEX.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef CHUNK_NBT_H
+#define CHUNK_NBT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <zlib.h>
+
+#include "../world.h"
+
+struct server_chunk;
+
+#define CHUNK_NBT_BUFFER 4096
+
+/* Reads and writes the chunk format of region files directly from and to the
+ * zlib stream, without building a cNBT tree in between. zlib state and
+ * buffers are kept around and reused for every chunk. */
+struct chunk_nbt_stream {
+	z_stream inflate;
+	z_stream deflate;
+	bool inflate_init;
+	bool deflate_init;
+	FILE* file;
+	size_t remaining;
+	uint8_t* in;
+	uint8_t* scratch;
+	uint8_t* out;
+	size_t out_capacity;
+};
+
+void chunk_nbt_init(struct chunk_nbt_stream* s);
+void chunk_nbt_destroy(struct chunk_nbt_stream* s);
+bool chunk_nbt_decode(struct chunk_nbt_stream* s, FILE* f, size_t length,
+					  w_coord_t x, w_coord_t z, struct server_chunk* sc);
+bool chunk_nbt_encode(struct chunk_nbt_stream* s, w_coord_t x, w_coord_t z,
+					  struct server_chunk* sc, uint8_t** data, size_t* length);
+
+#endif
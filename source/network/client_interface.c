@@ -242,6 +242,15 @@ void clin_process(struct client_rpc* call) {
 							call->payload.set_block.z,
 							call->payload.set_block.block, true);
 
+			break;
+		case CRPC_SET_BLOCKS:
+			for(size_t k = 0; k < call->payload.set_blocks.length; k++) {
+				struct world_modification_entry* e
+					= call->payload.set_blocks.list + k;
+				world_set_block(&gstate.world, e->x, e->y, e->z, e->blk, true);
+			}
+
+			free(call->payload.set_blocks.list);
 			break;
 		case CRPC_SPAWN_ITEM: {
 			struct entity** e_ptr = dict_entity_safe_get(
@@ -23,6 +23,7 @@
 #include "../entity/entity.h"
 #include "../item/items.h"
 #include "../item/window_container.h"
+#include "../lighting.h"
 #include "../world.h"
 
 #include "../cglm/cglm.h"
@@ -35,6 +36,7 @@ enum client_rpc_type {
 	CRPC_TIME_SET,
 	CRPC_WORLD_RESET,
 	CRPC_SET_BLOCK,
+	CRPC_SET_BLOCKS,
 	CRPC_WINDOW_TRANSACTION,
 	CRPC_SPAWN_ITEM,
 	CRPC_PICKUP_ITEM,
@@ -78,6 +80,10 @@ struct client_rpc {
 			w_coord_t x, y, z;
 			struct block_data block;
 		} set_block;
+		struct {
+			struct world_modification_entry* list;
+			size_t length;
+		} set_blocks;
 		struct {
 			uint8_t window;
 			uint16_t action_id;
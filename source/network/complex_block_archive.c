@@ -18,114 +18,195 @@
 */
 
 #include <assert.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "complex_block_archive.h"
 
-static int32_t swap_int32(int32_t n) {
-	n = ((n << 8) & 0xFF00FF00) | ((n >> 8) & 0xFF00FF);
-	return (n << 16) | ((n >> 16) & 0xFFFF);
+// layout of the old archives, with fixed amount of entries
+#define MAX_CHESTS 256
+#define MAX_SIGNS 256
+
+struct complex_block_pos {
+	int32_t x, y, z;
+};
+
+static int32_t read_s32(uint8_t* data) {
+	return (int32_t)(((uint32_t)data[0] << 24) | (data[1] << 16)
+					 | (data[2] << 8) | data[3]);
 }
 
-static uint16_t swap_uint16(uint16_t n) {
-	return (n << 8) | (n >> 8);
+static void write_s32(int32_t in, uint8_t* data) {
+	uint32_t v = in;
+	data[0] = v >> 24;
+	data[1] = (v >> 16) & 0xFF;
+	data[2] = (v >> 8) & 0xFF;
+	data[3] = v & 0xFF;
 }
 
-static int is_little_endian() {
-	volatile uint32_t i=0x01234567;
-	return (*((uint8_t*)(&i))) == 0x67;
+static FILE* archive_open(string_t path, const char* name, const char* mode) {
+	string_t filename;
+	string_init_printf(filename, "%s/%s", string_get_cstr(path), name);
+	FILE* f = fopen(string_get_cstr(filename), mode);
+	string_clear(filename);
+	return f;
 }
 
-static void swap_endianness(struct complex_block_pos* pos, struct item_data* items) {
-	if(is_little_endian()) {
-		for(int i=0; i<MAX_CHESTS; i++) {
-			pos[i].x = swap_int32(pos[i].x);	
-			pos[i].y = swap_int32(pos[i].y);	
-			pos[i].z = swap_int32(pos[i].z);	
-			if(items) {
-				for(int j=0; j<MAX_CHEST_SLOTS; j++) {
-					(items + i*MAX_CHEST_SLOTS + j)->id = swap_uint16((items + i*MAX_CHEST_SLOTS + j)->id);
-				}
-			}
-		}
-	}
+static void archive_remove(string_t path, const char* name) {
+	string_t filename;
+	string_init_printf(filename, "%s/%s", string_get_cstr(path), name);
+	remove(string_get_cstr(filename));
+	string_clear(filename);
 }
 
-void chest_archive_write(struct complex_block_pos* pos, struct item_data* items, string_t path) {
-	assert(pos && items && path);
+static void archive_read(struct server_world* w, string_t path,
+						 enum tile_entity_type type) {
+	bool chest = (type == TILE_ENTITY_CHEST);
+	size_t count = chest ? MAX_CHESTS : MAX_SIGNS;
+	size_t entry_size
+		= chest ? MAX_CHEST_SLOTS * sizeof(struct item_data) : SIGN_SIZE;
 
-	swap_endianness(pos, items);
+	FILE* f = archive_open(path, chest ? "chests.dat" : "signs.dat", "rb");
 
-	string_t filename;
-	string_init_printf(filename, "%s/chests.dat",
-					   string_get_cstr(path));
-	FILE* f = fopen(string_get_cstr(filename), "wb");
-	string_clear(filename);
-	if (!f) return;
+	if(!f)
+		return;
 
-	fputc(0, f); //format version byte
-	fwrite(pos, 1, MAX_CHESTS*sizeof(struct complex_block_pos), f);
-	fwrite(items, 1, MAX_CHEST_SLOTS*MAX_CHESTS*sizeof(struct item_data), f);
-	fclose(f);
-}
+	uint8_t* pos = malloc(count * sizeof(struct complex_block_pos));
+	uint8_t* data = malloc(count * entry_size);
 
-void chest_archive_read(struct complex_block_pos* pos, struct item_data* items, string_t path) {
-	assert(pos && items && path);
-	memset(pos, -1, MAX_CHESTS*sizeof(struct complex_block_pos));
-	memset(items, 0, MAX_CHEST_SLOTS*MAX_CHESTS*sizeof(struct item_data));
+	int format_version = fgetc(f);
+	if(format_version != 0)
+		puts("Warning: old tile entity archive uses a newer format");
 
-	string_t filename;
-	string_init_printf(filename, "%s/chests.dat",
-					   string_get_cstr(path));
-	FILE* f = fopen(string_get_cstr(filename), "rb");
-	string_clear(filename);
-	if(!f) return;
+	if(!pos || !data || format_version != 0
+	   || fread(pos, sizeof(struct complex_block_pos), count, f) != count
+	   || fread(data, entry_size, count, f) != count) {
+		free(pos);
+		free(data);
+		fclose(f);
+		return;
+	}
 
-	uint8_t format_version = fgetc(f);
-	if(format_version != 0) puts("Warning: chests.dat uses a newer format");
-	fread(pos, 1, MAX_CHESTS*sizeof(struct complex_block_pos), f);
-	fread(items, 1, MAX_CHEST_SLOTS*MAX_CHESTS*sizeof(struct item_data), f);
 	fclose(f);
 
-	swap_endianness(pos, items);
-}
+	for(size_t k = 0; k < count; k++) {
+		uint8_t* p = pos + k * sizeof(struct complex_block_pos);
+		w_coord_t y = read_s32(p + 4);
 
-void sign_archive_write(struct complex_block_pos* pos, char* texts, string_t path) {
-	assert(pos && texts && path);
+		// free entries are marked by a negative y
+		if(y < 0 || y >= WORLD_HEIGHT)
+			continue;
 
-	swap_endianness(pos, NULL);
+		struct tile_entity* te = malloc(sizeof(struct tile_entity));
 
-	string_t filename;
-	string_init_printf(filename, "%s/signs.dat",
-					   string_get_cstr(path));
-	FILE* f = fopen(string_get_cstr(filename), "wb");
-	string_clear(filename);
-	if (!f) return;
+		if(!te)
+			break;
 
-	fputc(0, f); //format version byte
-	fwrite(pos, 1, MAX_SIGNS*sizeof(struct complex_block_pos), f);
-	fwrite(texts, 1, MAX_SIGNS*SIGN_SIZE*sizeof(char), f);
-	fclose(f);
+		tile_entity_init(te, type, read_s32(p), y, read_s32(p + 8));
+
+		if(chest) {
+			for(size_t i = 0; i < MAX_CHEST_SLOTS; i++) {
+				uint8_t* item = data + k * entry_size + i * 4;
+				te->payload.items[i] = (struct item_data) {
+					.id = (item[0] << 8) | item[1],
+					.durability = item[2],
+					.count = item[3],
+				};
+			}
+		} else {
+			memcpy(te->payload.text, data + k * entry_size, SIGN_SIZE);
+		}
+
+		array_tile_entities_push_back(w->legacy_tile_entities, te);
+	}
+
+	free(pos);
+	free(data);
 }
 
-void sign_archive_read(struct complex_block_pos* pos, char* texts, string_t path) {
-	assert(pos && texts && path);
-	memset(pos, -1, MAX_SIGNS*sizeof(struct complex_block_pos));
-	memset(texts, ' ', MAX_SIGNS*SIGN_SIZE*sizeof(char));
+static void archive_write(struct server_world* w, string_t path,
+						  enum tile_entity_type type) {
+	bool chest = (type == TILE_ENTITY_CHEST);
+	size_t count = chest ? MAX_CHESTS : MAX_SIGNS;
+	size_t entry_size
+		= chest ? MAX_CHEST_SLOTS * sizeof(struct item_data) : SIGN_SIZE;
+	const char* name = chest ? "chests.dat" : "signs.dat";
+
+	size_t remaining = 0;
+	for(size_t k = 0; k < array_tile_entities_size(w->legacy_tile_entities);
+		k++) {
+		if((*array_tile_entities_get(w->legacy_tile_entities, k))->type == type)
+			remaining++;
+	}
 
-	string_t filename;
-	string_init_printf(filename, "%s/signs.dat",
-					   string_get_cstr(path));
-	FILE* f = fopen(string_get_cstr(filename), "rb");
-	string_clear(filename);
-	if(!f) return;
+	// everything is stored in chunks by now
+	if(!remaining) {
+		archive_remove(path, name);
+		return;
+	}
 
-	uint8_t format_version = fgetc(f);
-	if(format_version != 0) puts("Warning: signs.dat uses a newer format");
-	fread(pos, 1, MAX_CHESTS*sizeof(struct complex_block_pos), f);
-	fread(texts, 1, MAX_CHEST_SLOTS*MAX_CHESTS*sizeof(struct item_data), f);
-	fclose(f);
+	uint8_t* pos = malloc(count * sizeof(struct complex_block_pos));
+	uint8_t* data = calloc(count, entry_size);
+
+	if(!pos || !data) {
+		free(pos);
+		free(data);
+		return;
+	}
 
-	swap_endianness(pos, NULL);
+	memset(pos, 0xFF, count * sizeof(struct complex_block_pos));
+
+	size_t index = 0;
+	for(size_t k = 0; k < array_tile_entities_size(w->legacy_tile_entities)
+		&& index < count;
+		k++) {
+		struct tile_entity* te
+			= *array_tile_entities_get(w->legacy_tile_entities, k);
+
+		if(te->type != type)
+			continue;
+
+		uint8_t* p = pos + index * sizeof(struct complex_block_pos);
+		write_s32(te->x, p);
+		write_s32(te->y, p + 4);
+		write_s32(te->z, p + 8);
+
+		if(chest) {
+			for(size_t i = 0; i < MAX_CHEST_SLOTS; i++) {
+				uint8_t* item = data + index * entry_size + i * 4;
+				item[0] = te->payload.items[i].id >> 8;
+				item[1] = te->payload.items[i].id & 0xFF;
+				item[2] = te->payload.items[i].durability;
+				item[3] = te->payload.items[i].count;
+			}
+		} else {
+			memcpy(data + index * entry_size, te->payload.text, SIGN_SIZE);
+		}
+
+		index++;
+	}
+
+	FILE* f = archive_open(path, name, "wb");
+
+	if(f) {
+		fputc(0, f); // format version byte
+		fwrite(pos, sizeof(struct complex_block_pos), count, f);
+		fwrite(data, entry_size, count, f);
+		fclose(f);
+	}
+
+	free(pos);
+	free(data);
 }
 
+void complex_block_archive_read(struct server_world* w, string_t path) {
+	assert(w && path);
+	archive_read(w, path, TILE_ENTITY_CHEST);
+	archive_read(w, path, TILE_ENTITY_SIGN);
+}
 
+void complex_block_archive_write(struct server_world* w, string_t path) {
+	assert(w && path);
+	archive_write(w, path, TILE_ENTITY_CHEST);
+	archive_write(w, path, TILE_ENTITY_SIGN);
+}
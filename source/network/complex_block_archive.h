@@ -21,21 +21,12 @@
 #define COMPLEX_BLOCK_ARCHIVE_H
 
 #include <m-lib/m-string.h>
-#include <stdbool.h>
-#include <stddef.h>
-#include <stdint.h>
-#include <stdio.h>
-
-#include "../cNBT/nbt.h"
-#include "../cglm/cglm.h"
-
-#include "../item/inventory.h"
-#include "../item/items.h"
-#include "../world.h"
-#include "server_local.h"
-
-void chest_archive_read(struct complex_block_pos* pos, struct item_data* items, string_t path);
-void chest_archive_write(struct complex_block_pos* pos, struct item_data* items, string_t path);
-void sign_archive_read(struct complex_block_pos* pos, char* texts, string_t path);
-void sign_archive_write(struct complex_block_pos* pos, char* texts, string_t path);
+
+#include "server_world.h"
+
+/* chests.dat and signs.dat are only read to move their entries into chunks,
+ * what has not been moved yet is written back */
+void complex_block_archive_read(struct server_world* w, string_t path);
+void complex_block_archive_write(struct server_world* w, string_t path);
+
 #endif
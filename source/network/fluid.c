@@ -0,0 +1,185 @@
+/*
+	Copyright (c) 2023 ByteBit/xtreme8000
+
+	This file is part of CavEX.
+
+	CavEX is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	CavEX is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with CavEX.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <assert.h>
+
+#include "../block/blocks.h"
+#include "block_tick.h"
+#include "fluid.h"
+#include "server_local.h"
+#include "server_world.h"
+
+/* Fluids only move when something next to them changes. Every change
+ * schedules the fluid blocks around it a few ticks into the future and only
+ * those are updated, a lake at rest costs nothing. */
+
+#define FLUID_DELAY_WATER 5
+#define FLUID_DELAY_LAVA 30
+#define FLUID_FALLING 0x08
+
+static const int horizontal[4][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+
+bool fluid_is(uint8_t type) {
+	return type == BLOCK_WATER_FLOW || type == BLOCK_WATER_STILL
+		|| type == BLOCK_LAVA_FLOW || type == BLOCK_LAVA_STILL;
+}
+
+static bool fluid_is_lava(uint8_t type) {
+	return type == BLOCK_LAVA_FLOW || type == BLOCK_LAVA_STILL;
+}
+
+static bool fluid_same(uint8_t a, uint8_t b) {
+	return fluid_is(a) && fluid_is(b) && fluid_is_lava(a) == fluid_is_lava(b);
+}
+
+static bool fluid_replaceable(uint8_t type) {
+	return type == BLOCK_AIR
+		|| (!fluid_is(type) && blocks[type] && blocks[type]->place_ignore);
+}
+
+// distance from a source block, falling fluid counts as a source
+static int fluid_level(struct block_data blk) {
+	return (blk.metadata & FLUID_FALLING) ? 0 : (blk.metadata & 0x07);
+}
+
+void fluid_schedule(struct server_world* w, w_coord_t x, w_coord_t y,
+					w_coord_t z, uint8_t type) {
+	assert(w && fluid_is(type));
+
+	block_tick_schedule(w, x, y, z,
+						fluid_is_lava(type) ? FLUID_DELAY_LAVA :
+											  FLUID_DELAY_WATER);
+}
+
+static void fluid_set(struct server_local* s, w_coord_t x, w_coord_t y,
+					  w_coord_t z, uint8_t type, uint8_t metadata) {
+	server_world_set_block(s, x, y, z,
+						   (struct block_data) {
+							   .type = type,
+							   .metadata = metadata,
+							   .sky_light = 0,
+							   .torch_light = 0,
+						   });
+}
+
+void fluid_update(struct server_local* s, w_coord_t x, w_coord_t y,
+				  w_coord_t z) {
+	struct server_world* w = &s->world;
+	struct block_data cur, nb;
+
+	if(!server_world_get_block(w, x, y, z, &cur) || !fluid_is(cur.type))
+		return;
+
+	bool lava = fluid_is_lava(cur.type);
+	uint8_t type_flow = lava ? BLOCK_LAVA_FLOW : BLOCK_WATER_FLOW;
+	uint8_t type_still = lava ? BLOCK_LAVA_STILL : BLOCK_WATER_STILL;
+	int step = (lava && w->dimension != WORLD_DIM_NETHER) ? 2 : 1;
+
+	if(lava) {
+		for(int k = 0; k < SIDE_MAX; k++) {
+			int ox, oy, oz;
+			blocks_side_offset((enum side)k, &ox, &oy, &oz);
+
+			if(oy >= 0 && server_world_get_block(w, x + ox, y + oy, z + oz, &nb)
+			   && fluid_is(nb.type) && !fluid_is_lava(nb.type)) {
+				fluid_set(s, x, y, z,
+						  cur.metadata == 0 ? BLOCK_OBSIDIAN :
+											  BLOCK_COBBLESTONE,
+						  0);
+				return;
+			}
+		}
+	}
+
+	// flowing blocks take their level from the neighbours feeding them
+	if(cur.metadata != 0) {
+		int metadata;
+
+		if(server_world_get_block(w, x, y + 1, z, &nb)
+		   && fluid_same(nb.type, cur.type)) {
+			metadata = FLUID_FALLING;
+		} else {
+			int lowest = 8;
+			int sources = 0;
+
+			for(int k = 0; k < 4; k++) {
+				if(server_world_get_block(w, x + horizontal[k][0], y,
+										  z + horizontal[k][1], &nb)
+				   && fluid_same(nb.type, cur.type)) {
+					if(fluid_level(nb) < lowest)
+						lowest = fluid_level(nb);
+
+					if(nb.metadata == 0)
+						sources++;
+				}
+			}
+
+			metadata = lowest + step;
+
+			// water between two sources on solid ground becomes a source
+			if(!lava && sources >= 2 && server_world_get_block(w, x, y - 1, z, &nb)
+			   && ((blocks[nb.type] && !fluid_is(nb.type)
+					&& !fluid_replaceable(nb.type))
+				   || (fluid_same(nb.type, cur.type) && nb.metadata == 0)))
+				metadata = 0;
+
+			// nothing feeds this block anymore
+			if(metadata >= 8) {
+				fluid_set(s, x, y, z, BLOCK_AIR, 0);
+				return;
+			}
+		}
+
+		if(metadata != cur.metadata) {
+			cur.type = metadata == 0 ? type_still : type_flow;
+			cur.metadata = metadata;
+			fluid_set(s, x, y, z, cur.type, cur.metadata);
+		}
+	}
+
+	if(!server_world_get_block(w, x, y - 1, z, &nb))
+		return;
+
+	if(fluid_replaceable(nb.type)) {
+		fluid_set(s, x, y - 1, z, type_flow, FLUID_FALLING);
+		return;
+	}
+
+	// spread sideways only when standing on something
+	if(cur.metadata != 0 && fluid_same(nb.type, cur.type))
+		return;
+
+	int spread = (cur.metadata & FLUID_FALLING) ? 1 : fluid_level(cur) + step;
+
+	if(spread >= 8)
+		return;
+
+	for(int k = 0; k < 4; k++) {
+		w_coord_t nx = x + horizontal[k][0];
+		w_coord_t nz = z + horizontal[k][1];
+
+		if(!server_world_get_block(w, nx, y, nz, &nb))
+			continue;
+
+		if(fluid_replaceable(nb.type)
+		   || (nb.type == type_flow && !(nb.metadata & FLUID_FALLING)
+			   && nb.metadata > spread))
+			fluid_set(s, nx, y, nz, type_flow, spread);
+	}
+}
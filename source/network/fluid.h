@@ -0,0 +1,37 @@
+/*
+	Copyright (c) 2023 ByteBit/xtreme8000
+
+	This file is part of CavEX.
+
+	CavEX is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	CavEX is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with CavEX.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef FLUID_H
+#define FLUID_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "../world.h"
+
+struct server_local;
+struct server_world;
+
+bool fluid_is(uint8_t type);
+void fluid_schedule(struct server_world* w, w_coord_t x, w_coord_t y,
+					w_coord_t z, uint8_t type);
+void fluid_update(struct server_local* s, w_coord_t x, w_coord_t y,
+				  w_coord_t z);
+
+#endif
@@ -37,21 +37,20 @@ static void inv_on_close(struct inventory* inv) {
 	set_inv_slot_t changes;
 	set_inv_slot_init(changes);
 
-	for(int i = 0; i < MAX_CHESTS; i++) {
-		if(s->chest_pos[i].x == inv->x && s->chest_pos[i].y == inv->y && s->chest_pos[i].z == inv->z) {
-			for(size_t k = 0; k < CHEST_SIZE_STORAGE; k++) {
-				s->chest_items[i][k]
-					= inv->items[k + CHEST_SLOT_STORAGE];
-
-				struct item_data item;
-				inventory_get_slot(inv, k, &item);
-
-				if (item.id != 0) {
-					inventory_clear_slot(inv, k);
-					set_inv_slot_push(changes, k);
-				}
+	struct tile_entity* te
+		= server_world_tile_entity(&s->world, inv->x, inv->y, inv->z, true);
+
+	if(te) {
+		for(size_t k = 0; k < CHEST_SIZE_STORAGE; k++) {
+			te->payload.items[k] = inv->items[k + CHEST_SLOT_STORAGE];
+
+			struct item_data item;
+			inventory_get_slot(inv, k, &item);
+
+			if (item.id != 0) {
+				inventory_clear_slot(inv, k);
+				set_inv_slot_push(changes, k);
 			}
-			break;
 		}
 	}
 
@@ -108,14 +107,13 @@ static void inv_on_create(struct inventory* inv) {
 		set_inv_slot_push(changes, k + CHEST_SLOT_MAIN);
 	}
 
-	for(int i = 0; i < MAX_CHESTS; i++) {
-		if(s->chest_pos[i].x == inv->x && s->chest_pos[i].y == inv->y && s->chest_pos[i].z == inv->z) {
-			for(size_t k = 0; k < CHEST_SIZE_STORAGE; k++) {
-				inv->items[k + CHEST_SLOT_STORAGE]
-					= s->chest_items[i][k];
-				set_inv_slot_push(changes, k + CHEST_SLOT_STORAGE);
-			}
-			break;
+	struct tile_entity* te
+		= server_world_tile_entity(&s->world, inv->x, inv->y, inv->z, false);
+
+	if(te) {
+		for(size_t k = 0; k < CHEST_SIZE_STORAGE; k++) {
+			inv->items[k + CHEST_SLOT_STORAGE] = te->payload.items[k];
+			set_inv_slot_push(changes, k + CHEST_SLOT_STORAGE);
 		}
 	}
 	
@@ -32,7 +32,7 @@ static bool inv_match_crafting(struct inventory* inv,
 		slot_empty[k]
 			= !inventory_get_slot(inv, CRAFTING_SLOT_INPUT + k, slots + k);
 
-	return recipe_match(recipes_crafting, slots, slot_empty, result);
+	return recipe_match(&recipes_crafting, slots, slot_empty, result);
 }
 
 static bool inv_pre_action(struct inventory* inv, size_t slot, bool right,
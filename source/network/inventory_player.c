@@ -32,7 +32,7 @@ static bool inv_match_crafting(struct inventory* inv,
 		slot_empty[k + k / 2] = !inventory_get_slot(
 			inv, INVENTORY_SLOT_CRAFTING + k, slots + k + k / 2);
 
-	return recipe_match(recipes_crafting, slots, slot_empty, result);
+	return recipe_match(&recipes_crafting, slots, slot_empty, result);
 }
 
 static bool inv_pre_action(struct inventory* inv, size_t slot, bool right,
@@ -53,14 +53,12 @@ static void inv_on_close(struct inventory* inv) {
 	set_inv_slot_t changes;
 	set_inv_slot_init(changes);
 
-	// TODO: save sign text
-	for(int i = 0; i < MAX_SIGNS; i++) {
-		if(s->sign_pos[i].x == inv->x && s->sign_pos[i].y == inv->y && s->sign_pos[i].z == inv->z) {
-			for(size_t k = 0; k < SIGN_SIZE; k++) {
-				s->sign_texts[i][k] = inv->items[k].count;
-			}
-			break;
-		}
+	struct tile_entity* te
+		= server_world_tile_entity(&s->world, inv->x, inv->y, inv->z, true);
+
+	if(te) {
+		for(size_t k = 0; k < SIGN_SIZE; k++)
+			te->payload.text[k] = inv->items[k].count;
 	}
 
 
@@ -80,15 +78,14 @@ static void inv_on_create(struct inventory* inv) {
 	set_inv_slot_t changes;
 	set_inv_slot_init(changes);
 
-	// TODO: restore sign text
-	for(int i = 0; i < MAX_SIGNS; i++) {
-		if(s->sign_pos[i].x == inv->x && s->sign_pos[i].y == inv->y && s->sign_pos[i].z == inv->z) {
-			for(size_t k = 0; k < SIGN_SIZE; k++) {
-				inv->items[k].id = 1;
-				inv->items[k].count = s->sign_texts[i][k];
-				set_inv_slot_push(changes, k);
-			}
-			break;
+	struct tile_entity* te
+		= server_world_tile_entity(&s->world, inv->x, inv->y, inv->z, false);
+
+	if(te) {
+		for(size_t k = 0; k < SIGN_SIZE; k++) {
+			inv->items[k].id = 1;
+			inv->items[k].count = te->payload.text[k];
+			set_inv_slot_push(changes, k);
 		}
 	}
 	
@@ -18,9 +18,22 @@
 */
 
 #include <assert.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
 
 #include "level_archive.h"
 
+// also tells apart files written on a machine of other endianness
+#define LEVEL_SUMMARY_MAGIC 0x43584C31
+
+struct level_summary_cache {
+	uint32_t magic;
+	int64_t mtime;
+	int64_t size;
+	struct level_summary summary;
+};
+
 bool level_archive_create(struct level_archive* la, string_t filename) {
 	assert(la && filename);
 
@@ -397,7 +410,7 @@ bool level_archive_read_player(struct level_archive* la, vec3 position,
 	return true;
 }
 
-void level_archive_destroy(struct level_archive* la) {
+void level_archive_flush(struct level_archive* la) {
 	assert(la && la->data);
 
 	if(la->modified) {
@@ -406,9 +419,96 @@ void level_archive_destroy(struct level_archive* la) {
 		if(f) {
 			nbt_dump_file(la->data, f, STRAT_GZIP);
 			fclose(f);
+			la->modified = false;
+
+			// the summary might be outdated within the same mtime second
+			string_t meta;
+			string_init_set(meta, la->file_name);
+			string_cat_str(meta, ".meta");
+			remove(string_get_cstr(meta));
+			string_clear(meta);
 		}
 	}
+}
 
+void level_archive_destroy(struct level_archive* la) {
+	assert(la && la->data);
+
+	level_archive_flush(la);
 	string_clear(la->file_name);
 	nbt_free(la->data);
 }
+
+/* Reads name, size and last played time of a save. Parsing level.dat is
+ * slow, so the result is kept in "level.dat.meta" until level.dat changes. */
+bool level_archive_summary(string_t directory, struct level_summary* s) {
+	assert(directory && s);
+
+	string_t level, meta;
+	string_init_printf(level, "%s/level.dat", string_get_cstr(directory));
+	string_init_printf(meta, "%s.meta", string_get_cstr(level));
+
+	struct stat st;
+	if(stat(string_get_cstr(level), &st)) {
+		string_clear(level);
+		string_clear(meta);
+		return false;
+	}
+
+	struct level_summary_cache cache;
+	bool valid = false;
+	FILE* f = fopen(string_get_cstr(meta), "rb");
+
+	if(f) {
+		valid = fread(&cache, sizeof(cache), 1, f) == 1
+			&& cache.magic == LEVEL_SUMMARY_MAGIC
+			&& cache.mtime == (int64_t)st.st_mtime
+			&& cache.size == (int64_t)st.st_size;
+		fclose(f);
+	}
+
+	if(!valid) {
+		struct level_archive la;
+		if(!level_archive_create(&la, directory)) {
+			string_clear(level);
+			string_clear(meta);
+			return false;
+		}
+
+		memset(&cache, 0, sizeof(cache));
+		cache.magic = LEVEL_SUMMARY_MAGIC;
+		cache.mtime = st.st_mtime;
+		cache.size = st.st_size;
+
+		if(!level_archive_read(&la, LEVEL_NAME, cache.summary.name,
+							   sizeof(cache.summary.name)))
+			strcpy(cache.summary.name, "Missing name");
+
+		if(!level_archive_read(&la, LEVEL_DISK_SIZE, &cache.summary.disk_size,
+							   0))
+			cache.summary.disk_size = 0;
+
+		if(!level_archive_read(&la, LEVEL_LAST_PLAYED,
+							   &cache.summary.last_played, 0))
+			cache.summary.last_played = 0;
+
+		level_archive_destroy(&la);
+
+		f = fopen(string_get_cstr(meta), "wb");
+
+		if(f) {
+			if(fwrite(&cache, sizeof(cache), 1, f) != 1) {
+				fclose(f);
+				remove(string_get_cstr(meta));
+			} else {
+				fclose(f);
+			}
+		}
+	}
+
+	*s = cache.summary;
+
+	string_clear(level);
+	string_clear(meta);
+	return true;
+}
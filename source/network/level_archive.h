@@ -117,6 +117,13 @@ struct level_archive {
 	bool modified;
 };
 
+// what the world list needs to know about a save
+struct level_summary {
+	char name[64];
+	int64_t last_played;
+	int64_t disk_size;
+};
+
 bool level_archive_create(struct level_archive* la, string_t filename);
 bool level_archive_read(struct level_archive* la, struct level_archive_tag tag,
 						void* result, size_t length);
@@ -132,6 +139,8 @@ bool level_archive_read_inventory(struct level_archive* la,
 bool level_archive_read_player(struct level_archive* la, vec3 position,
 							   vec2 rotation, vec3 velocity,
 							   enum world_dim* dimension);
+void level_archive_flush(struct level_archive* la);
 void level_archive_destroy(struct level_archive* la);
+bool level_archive_summary(string_t directory, struct level_summary* s);
 
 #endif
@@ -0,0 +1,258 @@
+/*
+	Copyright (c) 2023 ByteBit/xtreme8000
+
+	This file is part of CavEX.
+
+	CavEX is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	CavEX is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with CavEX.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <assert.h>
+#include <m-lib/m-array.h>
+#include <m-lib/m-dict.h>
+#include <stdlib.h>
+
+#include "../block/blocks.h"
+#include "redstone.h"
+#include "server_local.h"
+
+/* Redstone is evaluated only when one of its inputs changes. A change queues
+ * its position, the wire networks touching it are collected into a graph and
+ * their power levels are solved in one breadth-first pass. Idle circuits are
+ * never visited. */
+
+struct rs_pos {
+	w_coord_t x, y, z;
+};
+
+#define RS_KEY(x, y, z)                                                        \
+	((((uint64_t)(x) & 0x3FFFFFF) << 33) | (((uint64_t)(z) & 0x3FFFFFF) << 7)  \
+	 | ((uint64_t)(y) & 0x7F))
+
+#define RS_UPDATES_MAX 1024
+
+ARRAY_DEF(array_rs_pos, struct rs_pos, M_POD_OPLIST)
+// wire position -> index into the node array
+DICT_DEF2(dict_rs_node, uint64_t, M_BASIC_OPLIST, size_t, M_BASIC_OPLIST)
+
+static struct {
+	array_rs_pos_t pending;
+	array_rs_pos_t nodes;
+	array_rs_pos_t queue;
+	dict_rs_node_t lookup;
+	uint8_t* power;
+	size_t power_length;
+	bool initialized;
+	bool running;
+	bool writing;
+	// wire currently written by redstone_solve()
+	struct rs_pos written;
+} rs;
+
+static const int rs_offsets[SIDE_MAX][3] = {
+	[SIDE_TOP] = {0, 1, 0},	  [SIDE_BOTTOM] = {0, -1, 0},
+	[SIDE_LEFT] = {-1, 0, 0}, [SIDE_RIGHT] = {1, 0, 0},
+	[SIDE_FRONT] = {0, 0, 1}, [SIDE_BACK] = {0, 0, -1},
+};
+
+static uint8_t redstone_source_power(struct block_data blk) {
+	switch(blk.type) {
+		case BLOCK_REDSTONE_TORCH_LIT: return 15;
+		case BLOCK_STONE_PRESSURE_PLATE:
+		case BLOCK_WOOD_PRESSURE_PLATE: return (blk.metadata & 0x01) ? 15 : 0;
+		default: return 0;
+	}
+}
+
+bool redstone_relevant(uint8_t type) {
+	return type == BLOCK_REDSTONE_WIRE || type == BLOCK_REDSTONE_TORCH
+		|| type == BLOCK_REDSTONE_TORCH_LIT || type == BLOCK_STONE_PRESSURE_PLATE
+		|| type == BLOCK_WOOD_PRESSURE_PLATE;
+}
+
+bool redstone_is_powered(struct server_world* w, w_coord_t x, w_coord_t y,
+						 w_coord_t z) {
+	assert(w);
+
+	for(int k = 0; k < SIDE_MAX; k++) {
+		struct block_data nb;
+		if(!server_world_get_block(w, x + rs_offsets[k][0],
+								   y + rs_offsets[k][1], z + rs_offsets[k][2],
+								   &nb))
+			continue;
+
+		if((nb.type == BLOCK_REDSTONE_WIRE && (nb.metadata & 0x0F) > 0)
+		   || redstone_source_power(nb) > 0)
+			return true;
+	}
+
+	return false;
+}
+
+static void redstone_collect(struct server_world* w, w_coord_t x, w_coord_t y,
+							 w_coord_t z) {
+	struct block_data blk;
+	if(!server_world_get_block(w, x, y, z, &blk)
+	   || blk.type != BLOCK_REDSTONE_WIRE
+	   || dict_rs_node_get(rs.lookup, RS_KEY(x, y, z)))
+		return;
+
+	// flood fill along horizontally connected wires
+	size_t start = array_rs_pos_size(rs.nodes);
+	dict_rs_node_set_at(rs.lookup, RS_KEY(x, y, z), start);
+	array_rs_pos_push_back(rs.nodes, (struct rs_pos) {x, y, z});
+
+	for(size_t k = start; k < array_rs_pos_size(rs.nodes); k++) {
+		struct rs_pos p = *array_rs_pos_get(rs.nodes, k);
+
+		for(int side = 0; side < SIDE_MAX; side++) {
+			if(side == SIDE_TOP || side == SIDE_BOTTOM)
+				continue;
+
+			w_coord_t nx = p.x + rs_offsets[side][0];
+			w_coord_t nz = p.z + rs_offsets[side][2];
+
+			if(dict_rs_node_get(rs.lookup, RS_KEY(nx, p.y, nz))
+			   || !server_world_get_block(w, nx, p.y, nz, &blk)
+			   || blk.type != BLOCK_REDSTONE_WIRE)
+				continue;
+
+			dict_rs_node_set_at(rs.lookup, RS_KEY(nx, p.y, nz),
+								array_rs_pos_size(rs.nodes));
+			array_rs_pos_push_back(rs.nodes, (struct rs_pos) {nx, p.y, nz});
+		}
+	}
+}
+
+static void redstone_solve(struct server_local* s, struct rs_pos origin) {
+	struct server_world* w = &s->world;
+
+	array_rs_pos_reset(rs.nodes);
+	array_rs_pos_reset(rs.queue);
+	dict_rs_node_reset(rs.lookup);
+
+	redstone_collect(w, origin.x, origin.y, origin.z);
+
+	for(int side = 0; side < SIDE_MAX; side++)
+		redstone_collect(w, origin.x + rs_offsets[side][0],
+						 origin.y + rs_offsets[side][1],
+						 origin.z + rs_offsets[side][2]);
+
+	size_t count = array_rs_pos_size(rs.nodes);
+
+	if(!count)
+		return;
+
+	if(count > rs.power_length) {
+		rs.power_length = count * 2;
+		rs.power = realloc(rs.power, rs.power_length);
+		assert(rs.power);
+	}
+
+	// wires next to a source are fully powered
+	for(size_t k = 0; k < count; k++) {
+		struct rs_pos p = *array_rs_pos_get(rs.nodes, k);
+		rs.power[k] = 0;
+
+		for(int side = 0; side < SIDE_MAX; side++) {
+			struct block_data nb;
+			if(server_world_get_block(w, p.x + rs_offsets[side][0],
+									  p.y + rs_offsets[side][1],
+									  p.z + rs_offsets[side][2], &nb)
+			   && redstone_source_power(nb) > 0) {
+				rs.power[k] = 15;
+				array_rs_pos_push_back(rs.queue, p);
+				break;
+			}
+		}
+	}
+
+	/* all seeds start at the same level, so a plain breadth-first pass
+	 * assigns every wire its strongest path */
+	for(size_t q = 0; q < array_rs_pos_size(rs.queue); q++) {
+		struct rs_pos p = *array_rs_pos_get(rs.queue, q);
+		uint8_t level = rs.power[*dict_rs_node_get(rs.lookup,
+												   RS_KEY(p.x, p.y, p.z))];
+
+		if(level <= 1)
+			continue;
+
+		for(int side = 0; side < SIDE_MAX; side++) {
+			if(side == SIDE_TOP || side == SIDE_BOTTOM)
+				continue;
+
+			size_t* idx = dict_rs_node_get(
+				rs.lookup,
+				RS_KEY(p.x + rs_offsets[side][0], p.y,
+					   p.z + rs_offsets[side][2]));
+
+			if(idx && rs.power[*idx] < level - 1) {
+				rs.power[*idx] = level - 1;
+				array_rs_pos_push_back(rs.queue, *array_rs_pos_get(rs.nodes,
+																   *idx));
+			}
+		}
+	}
+
+	// only wires that changed are written, consumers react to those writes
+	for(size_t k = 0; k < count; k++) {
+		struct rs_pos p = *array_rs_pos_get(rs.nodes, k);
+		struct block_data blk;
+
+		if(server_world_get_block(w, p.x, p.y, p.z, &blk)
+		   && (blk.metadata & 0x0F) != rs.power[k]) {
+			blk.metadata = rs.power[k];
+			rs.written = p;
+			rs.writing = true;
+			server_world_set_block(s, p.x, p.y, p.z, blk);
+			rs.writing = false;
+		}
+	}
+}
+
+void redstone_update(struct server_local* s, w_coord_t x, w_coord_t y,
+					 w_coord_t z) {
+	assert(s);
+
+	if(!rs.initialized) {
+		array_rs_pos_init(rs.pending);
+		array_rs_pos_init(rs.nodes);
+		array_rs_pos_init(rs.queue);
+		dict_rs_node_init(rs.lookup);
+		rs.power = NULL;
+		rs.power_length = 0;
+		rs.initialized = true;
+	}
+
+	/* The wire written while solving is the result, not a new input. Blocks
+	 * that react to that write are queued like any other change. */
+	if(rs.writing && x == rs.written.x && y == rs.written.y
+	   && z == rs.written.z)
+		return;
+
+	array_rs_pos_push_back(rs.pending, (struct rs_pos) {x, y, z});
+
+	if(rs.running)
+		return;
+
+	rs.running = true;
+
+	/* changes caused by consumers are settled within the same tick, in order,
+	 * a circuit that keeps toggling is cut off after RS_UPDATES_MAX */
+	for(size_t k = 0;
+		k < array_rs_pos_size(rs.pending) && k < RS_UPDATES_MAX; k++)
+		redstone_solve(s, *array_rs_pos_get(rs.pending, k));
+
+	array_rs_pos_reset(rs.pending);
+	rs.running = false;
+}
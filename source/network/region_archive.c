@@ -20,8 +20,14 @@
 #include <assert.h>
 #include <m-lib/m-string.h>
 
-#include "../cNBT/nbt.h"
+#ifdef PLATFORM_PC
+#include <dirent.h>
+#include <unistd.h>
+#endif
 
+#include "../platform/time.h"
+
+#include "chunk_nbt.h"
 #include "region_archive.h"
 #include "server_world.h"
 
@@ -205,9 +211,10 @@ bool region_archive_contains(struct region_archive* ra, w_coord_t x,
 	return true;
 }
 
-bool region_archive_get_blocks(struct region_archive* ra, w_coord_t x,
+bool region_archive_get_blocks(struct region_archive* ra,
+							   struct chunk_nbt_stream* s, w_coord_t x,
 							   w_coord_t z, struct server_chunk* sc) {
-	assert(ra && sc);
+	assert(ra && s && sc);
 	bool chunk_exists;
 	assert(region_archive_contains(ra, x, z, &chunk_exists) && chunk_exists);
 
@@ -230,7 +237,7 @@ bool region_archive_get_blocks(struct region_archive* ra, w_coord_t x,
 	}
 
 	uint32_t length;
-	if(!fread_u32(&length, f)
+	if(!fread_u32(&length, f) || length < 1
 	   || length + sizeof(uint32_t) > sectors * REGION_SECTOR_SIZE) {
 		fclose(f);
 		return false;
@@ -242,76 +249,11 @@ bool region_archive_get_blocks(struct region_archive* ra, w_coord_t x,
 		return false;
 	}
 
-	void* nbt_compressed = malloc(length - 1);
-
-	if(!nbt_compressed) {
-		fclose(f);
-		return false;
-	}
-
-	if(!fread(nbt_compressed, length - 1, 1, f)) {
-		free(nbt_compressed);
-		fclose(f);
-		return false;
-	}
-
-	nbt_node* chunk = nbt_parse_compressed(nbt_compressed, length - 1);
-
-	free(nbt_compressed);
+	// inflated straight into the chunk arrays provided by the caller
+	bool success = chunk_nbt_decode(s, f, length - 1, x, z, sc);
 	fclose(f);
 
-	if(!chunk)
-		return false;
-
-	nbt_node* n_x = nbt_find_by_path(chunk, ".Level.xPos");
-	nbt_node* n_z = nbt_find_by_path(chunk, ".Level.zPos");
-
-	if(!n_x || !n_z || n_x->type != TAG_INT || n_z->type != TAG_INT
-	   || n_x->payload.tag_int != x || n_z->payload.tag_int != z) {
-		nbt_free(chunk);
-		return false;
-	}
-
-	nbt_node* n_blocks = nbt_find_by_path(chunk, ".Level.Blocks");
-	nbt_node* n_metadata = nbt_find_by_path(chunk, ".Level.Data");
-	nbt_node* n_skyl = nbt_find_by_path(chunk, ".Level.SkyLight");
-	nbt_node* n_torchl = nbt_find_by_path(chunk, ".Level.BlockLight");
-	nbt_node* n_height = nbt_find_by_path(chunk, ".Level.HeightMap");
-
-	if(!n_blocks || !n_metadata || !n_skyl || !n_torchl || !n_height
-	   || n_blocks->type != TAG_BYTE_ARRAY || n_metadata->type != TAG_BYTE_ARRAY
-	   || n_skyl->type != TAG_BYTE_ARRAY || n_torchl->type != TAG_BYTE_ARRAY
-	   || n_height->type != TAG_BYTE_ARRAY
-	   || n_blocks->payload.tag_byte_array.length
-		   != CHUNK_SIZE * CHUNK_SIZE * WORLD_HEIGHT
-	   || n_metadata->payload.tag_byte_array.length
-		   != CHUNK_SIZE * CHUNK_SIZE * WORLD_HEIGHT / 2
-	   || n_skyl->payload.tag_byte_array.length
-		   != CHUNK_SIZE * CHUNK_SIZE * WORLD_HEIGHT / 2
-	   || n_torchl->payload.tag_byte_array.length
-		   != CHUNK_SIZE * CHUNK_SIZE * WORLD_HEIGHT / 2
-	   || n_height->payload.tag_byte_array.length != CHUNK_SIZE * CHUNK_SIZE) {
-		nbt_free(chunk);
-		return false;
-	}
-
-	// borrow memory regions from nbt tree
-
-	n_blocks->type = TAG_INVALID;
-	n_metadata->type = TAG_INVALID;
-	n_skyl->type = TAG_INVALID;
-	n_torchl->type = TAG_INVALID;
-	n_height->type = TAG_INVALID;
-
-	sc->ids = n_blocks->payload.tag_byte_array.data;
-	sc->metadata = n_metadata->payload.tag_byte_array.data;
-	sc->lighting_sky = n_skyl->payload.tag_byte_array.data;
-	sc->lighting_torch = n_torchl->payload.tag_byte_array.data;
-	sc->heightmap = n_height->payload.tag_byte_array.data;
-
-	nbt_free(chunk);
-
-	return true;
+	return success;
 }
 
 static bool file_overwrite_index(FILE* f, size_t index, uint32_t data) {
@@ -369,114 +311,32 @@ static bool file_overwrite_chunk(FILE* f, size_t offset, void* data,
 	return true;
 }
 
-bool region_archive_set_blocks(struct region_archive* ra, w_coord_t x,
+bool region_archive_set_blocks(struct region_archive* ra,
+							   struct chunk_nbt_stream* s, w_coord_t x,
 							   w_coord_t z, struct server_chunk* sc) {
-	assert(ra && sc);
-	assert(CHUNK_REGION_COORD(x) == ra->x && CHUNK_REGION_COORD(z) == ra->z);
+	assert(ra && s && sc);
 
-	FILE* f = fopen(string_get_cstr(ra->file_name), "rb+");
+	uint8_t* nbt;
+	size_t nbt_length;
 
-	// early exit
-	if(!f)
+	if(!chunk_nbt_encode(s, x, z, sc, &nbt, &nbt_length))
 		return false;
 
-	struct nbt_list root_list_sentinel = (struct nbt_list) {
-		.data = NULL,
-	};
-	struct nbt_list level_list_sentinel = (struct nbt_list) {
-		.data = NULL,
-	};
-	struct nbt_list empty_list_sentinel = (struct nbt_list) {
-		.data = &(nbt_node) {.type = TAG_COMPOUND},
-	};
-
-	INIT_LIST_HEAD(&root_list_sentinel.entry);
-	INIT_LIST_HEAD(&level_list_sentinel.entry);
-	INIT_LIST_HEAD(&empty_list_sentinel.entry);
-
-	nbt_node root = (nbt_node) {
-		.type = TAG_COMPOUND,
-		.name = "",
-		.payload.tag_compound = &root_list_sentinel,
-	};
-
-	nbt_node level = (nbt_node) {
-		.type = TAG_COMPOUND,
-		.name = "Level",
-		.payload.tag_compound = &level_list_sentinel,
-	};
-
-	struct nbt_list root_list = (struct nbt_list) {
-		.data = &level,
-	};
-
-	list_add_head(&root_list.entry, &root_list_sentinel.entry);
-
-	nbt_node level_list_nodes[] = {
-		{
-			.type = TAG_BYTE_ARRAY,
-			.name = "Blocks",
-			.payload.tag_byte_array.data = sc->ids,
-			.payload.tag_byte_array.length
-			= CHUNK_SIZE * CHUNK_SIZE * WORLD_HEIGHT,
-		},
-		{
-			.type = TAG_BYTE_ARRAY,
-			.name = "Data",
-			.payload.tag_byte_array.data = sc->metadata,
-			.payload.tag_byte_array.length
-			= CHUNK_SIZE * CHUNK_SIZE * WORLD_HEIGHT / 2,
-		},
-		{
-			.type = TAG_BYTE_ARRAY,
-			.name = "SkyLight",
-			.payload.tag_byte_array.data = sc->lighting_sky,
-			.payload.tag_byte_array.length
-			= CHUNK_SIZE * CHUNK_SIZE * WORLD_HEIGHT / 2,
-		},
-		{
-			.type = TAG_BYTE_ARRAY,
-			.name = "BlockLight",
-			.payload.tag_byte_array.data = sc->lighting_torch,
-			.payload.tag_byte_array.length
-			= CHUNK_SIZE * CHUNK_SIZE * WORLD_HEIGHT / 2,
-		},
-		{
-			.type = TAG_BYTE_ARRAY,
-			.name = "HeightMap",
-			.payload.tag_byte_array.data = sc->heightmap,
-			.payload.tag_byte_array.length = CHUNK_SIZE * CHUNK_SIZE,
-		},
-		{
-			.type = TAG_LIST,
-			.name = "Entities",
-			.payload.tag_list = &empty_list_sentinel,
-		},
-		{
-			.type = TAG_LIST,
-			.name = "TileEntities",
-			.payload.tag_list = &empty_list_sentinel,
-		},
-		{.type = TAG_LONG, .name = "LastUpdate", .payload.tag_long = 0},
-		{.type = TAG_INT, .name = "xPos", .payload.tag_int = x},
-		{.type = TAG_INT, .name = "zPos", .payload.tag_int = z},
-		{.type = TAG_BYTE, .name = "TerrainPopulated", .payload.tag_byte = 1},
-	};
-
-	struct nbt_list
-		level_list[sizeof(level_list_nodes) / sizeof(*level_list_nodes)];
-
-	for(size_t k = 0; k < sizeof(level_list) / sizeof(*level_list); k++) {
-		level_list[k].data = level_list_nodes + k;
-		list_add_tail(&level_list[k].entry, &level_list_sentinel.entry);
-	}
+	return region_archive_write_chunk(ra, x, z, nbt, nbt_length);
+}
 
-	struct buffer res = nbt_dump_compressed(&root, STRAT_INFLATE);
+bool region_archive_write_chunk(struct region_archive* ra, w_coord_t x,
+								w_coord_t z, uint8_t* nbt, size_t nbt_length) {
+	assert(ra && nbt && nbt_length > 0);
+	assert(CHUNK_REGION_COORD(x) == ra->x && CHUNK_REGION_COORD(z) == ra->z);
 
-	if(!res.data)
+	FILE* f = fopen(string_get_cstr(ra->file_name), "rb+");
+
+	// early exit
+	if(!f)
 		return false;
 
-	uint32_t new_data_sectors = (res.len + sizeof(uint32_t) + sizeof(uint8_t)
+	uint32_t new_data_sectors = (nbt_length + sizeof(uint32_t) + sizeof(uint8_t)
 								 + REGION_SECTOR_SIZE - 1)
 		/ REGION_SECTOR_SIZE;
 
@@ -498,11 +358,17 @@ bool region_archive_set_blocks(struct region_archive* ra, w_coord_t x,
 			success = false;
 
 		if(success
-		   && !file_overwrite_chunk(f, offset * REGION_SECTOR_SIZE, res.data,
-									res.len, false))
+		   && !file_overwrite_chunk(f, offset * REGION_SECTOR_SIZE, nbt,
+									nbt_length, false))
 			success = false;
 
 	} else {
+		// the sectors currently held by this chunk can be reused as well
+		if(CHUNK_EXISTS(offset, sectors)) {
+			ra->offsets[rx + rz * REGION_SIZE] = 0;
+			rebuild_occupied_list(ra);
+		}
+
 		/* append new data at end or insert it in between existing chunks where
 		 * there is enough space left */
 		uint32_t new_offset = 0;
@@ -539,18 +405,289 @@ bool region_archive_set_blocks(struct region_archive* ra, w_coord_t x,
 
 			if(success
 			   && !file_overwrite_chunk(f, new_offset * REGION_SECTOR_SIZE,
-										res.data, res.len, pad))
+										nbt, nbt_length, pad))
 				success = false;
 		} else {
+			ra->offsets[rx + rz * REGION_SIZE] = (offset << 8) | sectors;
 			success = false;
 		}
 	}
 
 	// this could be done without resorting the entire list
-	if(success)
-		success = rebuild_occupied_list(ra);
+	if(!rebuild_occupied_list(ra))
+		success = false;
 
 	fclose(f);
-	buffer_free(&res);
 	return success;
 }
+
+size_t region_archive_dead_sectors(struct region_archive* ra) {
+	assert(ra);
+
+	// chunks are sorted by offset, gaps between them are dead space
+	size_t dead = 0;
+	for(size_t k = 1; k < ra->occupied_index; k++) {
+		uint32_t prev_end = (ra->occupied_sorted[k - 1] >> 8)
+			+ (ra->occupied_sorted[k - 1] & 0xFF);
+		dead += (ra->occupied_sorted[k] >> 8) - prev_end;
+	}
+
+	return dead;
+}
+
+static size_t file_size(FILE* f) {
+	assert(f);
+
+	if(fseek(f, 0, SEEK_END))
+		return 0;
+
+	long size = ftell(f);
+	return size > 0 ? size : 0;
+}
+
+// copies a chunk to sector "to", then points index entry i at it
+static bool compact_move(struct region_archive* ra, FILE* f, size_t i,
+						 uint8_t* buffer, uint32_t length, uint32_t to) {
+	assert(ra && f && buffer);
+
+	uint32_t sectors = ra->offsets[i] & 0xFF;
+
+	if(fseek(f, to * REGION_SECTOR_SIZE, SEEK_SET)
+	   || fwrite_u32(length, f) != 1 || fwrite(buffer, length, 1, f) != 1)
+		return false;
+
+	// keep whole sectors, the copy might end up last in the file
+	for(size_t k = length + sizeof(uint32_t);
+		k < sectors * REGION_SECTOR_SIZE; k++) {
+		if(fputc(0, f) == EOF)
+			return false;
+	}
+
+	// data must be on disk before the index refers to it
+	if(fflush(f))
+		return false;
+
+	ra->offsets[i] = (to << 8) | sectors;
+
+	return !fseek(f, i * sizeof(uint32_t), SEEK_SET)
+		&& fwrite_u32(ra->offsets[i], f) == 1 && !fflush(f);
+}
+
+bool region_archive_compact(struct region_archive* ra, size_t* size_before,
+							size_t* size_after) {
+	assert(ra);
+
+	FILE* f = fopen(string_get_cstr(ra->file_name), "rb+");
+
+	if(!f)
+		return false;
+
+	size_t size = file_size(f);
+
+	if(size_before)
+		*size_before = size;
+
+	uint8_t* buffer = NULL;
+	size_t buffer_size = 0;
+	uint32_t next = 2;
+	// free space past every chunk, only ever used by one chunk at a time
+	uint32_t tail = (size + REGION_SECTOR_SIZE - 1) / REGION_SECTOR_SIZE;
+	bool success = true;
+
+	/* Moves every chunk down to the first free sector, in file order. A chunk
+	 * is copied before its index entry is updated, and never over its own
+	 * old copy: if the two would overlap, it takes a detour through the
+	 * space at the end of the file. The file stays valid if this is
+	 * interrupted, at worst with some dead sectors left over. */
+	for(size_t k = 1; k < ra->occupied_index && success; k++) {
+		uint32_t offset = ra->occupied_sorted[k] >> 8;
+		uint32_t sectors = ra->occupied_sorted[k] & 0xFF;
+
+		if(offset == next) {
+			next += sectors;
+			continue;
+		}
+
+		assert(offset > next);
+
+		uint32_t length;
+		if(fseek(f, offset * REGION_SECTOR_SIZE, SEEK_SET) != 0
+		   || !fread_u32(&length, f)
+		   || length + sizeof(uint32_t) > sectors * REGION_SECTOR_SIZE) {
+			success = false;
+			break;
+		}
+
+		if(buffer_size < length) {
+			uint8_t* tmp = realloc(buffer, length);
+
+			if(!tmp) {
+				success = false;
+				break;
+			}
+
+			buffer = tmp;
+			buffer_size = length;
+		}
+
+		if(!fread(buffer, length, 1, f)) {
+			success = false;
+			break;
+		}
+
+		size_t i = 0;
+		while(i < REGION_SIZE * REGION_SIZE
+			  && ra->offsets[i] != ra->occupied_sorted[k])
+			i++;
+
+		if(i == REGION_SIZE * REGION_SIZE) {
+			success = false;
+			break;
+		}
+
+		if(offset - next < sectors
+		   && !compact_move(ra, f, i, buffer, length, tail)) {
+			success = false;
+			break;
+		}
+
+		if(!compact_move(ra, f, i, buffer, length, next)) {
+			success = false;
+			break;
+		}
+
+		next += sectors;
+	}
+
+	free(buffer);
+
+	if(success && fflush(f))
+		success = false;
+
+#ifdef PLATFORM_PC
+	// mc requires files to be multiples of 4KiB, zero padding is added
+	if(success && ftruncate(fileno(f), (off_t)next * REGION_SECTOR_SIZE))
+		success = false;
+#else
+	/* strict C99 cannot shrink a file, the space after the last chunk stays
+	 * and new chunks are appended there before the file grows again */
+#endif
+
+	if(size_after)
+		*size_after = file_size(f);
+
+	fclose(f);
+
+	if(!rebuild_occupied_list(ra))
+		success = false;
+
+	return success;
+}
+
+#ifdef PLATFORM_PC
+static size_t region_archive_read_all(struct region_archive* ra) {
+	assert(ra);
+
+	FILE* f = fopen(string_get_cstr(ra->file_name), "rb");
+
+	if(!f)
+		return 0;
+
+	uint8_t* buffer = malloc(255 * REGION_SECTOR_SIZE);
+	size_t total = 0;
+
+	// same order the server loads chunks in when a player walks by
+	for(size_t k = 0; k < REGION_SIZE * REGION_SIZE && buffer; k++) {
+		uint32_t offset = ra->offsets[k] >> 8;
+		uint32_t sectors = ra->offsets[k] & 0xFF;
+		uint32_t length;
+
+		if(CHUNK_EXISTS(offset, sectors)
+		   && !fseek(f, offset * REGION_SECTOR_SIZE, SEEK_SET)
+		   && fread_u32(&length, f)
+		   && length + sizeof(uint32_t) <= sectors * REGION_SECTOR_SIZE
+		   && fread(buffer, length, 1, f))
+			total += length + sizeof(uint32_t);
+	}
+
+	free(buffer);
+	fclose(f);
+	return total;
+}
+
+static void compact_dimension(string_t world, const char* region_path,
+							  enum world_dim dimension, size_t* before,
+							  size_t* after) {
+	assert(world && region_path && before && after);
+
+	DIR* d = opendir(region_path);
+
+	if(!d)
+		return;
+
+	struct dirent* dir;
+	while((dir = readdir(d))) {
+		int x, z, end = 0;
+
+		if(sscanf(dir->d_name, "r.%d.%d.mcr%n", &x, &z, &end) != 2 || !end
+		   || dir->d_name[end])
+			continue;
+
+		struct region_archive ra;
+		if(!region_archive_create(&ra, world, x, z, dimension)) {
+			printf("%s/%s: could not be opened\n", region_path, dir->d_name);
+			continue;
+		}
+
+		ptime_t start = time_get();
+		size_t read_before = region_archive_read_all(&ra);
+		float time_before = time_diff_s(start, time_get());
+
+		size_t dead = region_archive_dead_sectors(&ra);
+		size_t size_before, size_after;
+		bool success = region_archive_compact(&ra, &size_before, &size_after);
+
+		start = time_get();
+		size_t read_after = region_archive_read_all(&ra);
+		float time_after = time_diff_s(start, time_get());
+
+		printf("%s/%s: %zu dead sectors, %zu KiB -> %zu KiB, read %.1f -> %.1f "
+			   "MiB/s%s\n",
+			   region_path, dir->d_name, dead, size_before / 1024,
+			   size_after / 1024,
+			   time_before > 0 ? read_before / time_before / 1048576.0F : 0.0F,
+			   time_after > 0 ? read_after / time_after / 1048576.0F : 0.0F,
+			   success ? "" : " (failed)");
+
+		*before += size_before;
+		*after += size_after;
+		region_archive_destroy(&ra);
+	}
+
+	closedir(d);
+}
+
+bool region_archive_compact_world(const char* world_path) {
+	assert(world_path);
+
+	string_t world, path;
+	string_init_set_str(world, world_path);
+	string_init(path);
+
+	size_t before = 0, after = 0;
+
+	string_printf(path, "%s/region", world_path);
+	compact_dimension(world, string_get_cstr(path), WORLD_DIM_OVERWORLD,
+					  &before, &after);
+
+	string_printf(path, "%s/DIM-1/region", world_path);
+	compact_dimension(world, string_get_cstr(path), WORLD_DIM_NETHER, &before,
+					  &after);
+
+	printf("total: %zu KiB -> %zu KiB\n", before / 1024, after / 1024);
+
+	string_clear(path);
+	string_clear(world);
+	return before > 0;
+}
+#endif
@@ -28,6 +28,7 @@
 #include "../world.h"
 
 struct server_chunk;
+struct chunk_nbt_stream;
 
 struct region_archive {
 	w_coord_t x, z;
@@ -44,6 +45,9 @@ ILIST_DEF(ilist_regions, struct region_archive, M_POD_OPLIST)
 #define REGION_SIZE_BITS 5
 #define REGION_SECTOR_SIZE 4096
 
+// regions with more dead sectors than this are compacted on eviction
+#define REGION_COMPACT_MIN_DEAD 16
+
 #define CHUNK_REGION_COORD(x) ((w_coord_t)floor(x / (float)REGION_SIZE))
 
 bool region_archive_create_new(struct region_archive* ra, string_t world_name,
@@ -54,9 +58,20 @@ bool region_archive_create(struct region_archive* ra, string_t world_name,
 void region_archive_destroy(struct region_archive* ra);
 bool region_archive_contains(struct region_archive* ra, w_coord_t x,
 							 w_coord_t z, bool* chunk_exists);
-bool region_archive_get_blocks(struct region_archive* ra, w_coord_t x,
+bool region_archive_get_blocks(struct region_archive* ra,
+							   struct chunk_nbt_stream* s, w_coord_t x,
 							   w_coord_t z, struct server_chunk* sc);
-bool region_archive_set_blocks(struct region_archive* ra, w_coord_t x,
+bool region_archive_set_blocks(struct region_archive* ra,
+							   struct chunk_nbt_stream* s, w_coord_t x,
 							   w_coord_t z, struct server_chunk* sc);
+bool region_archive_write_chunk(struct region_archive* ra, w_coord_t x,
+								w_coord_t z, uint8_t* nbt, size_t nbt_length);
+size_t region_archive_dead_sectors(struct region_archive* ra);
+bool region_archive_compact(struct region_archive* ra, size_t* size_before,
+							size_t* size_after);
+
+#ifdef PLATFORM_PC
+bool region_archive_compact_world(const char* world_path);
+#endif
 
 #endif
@@ -26,11 +26,13 @@
 
 #include "../item/window_container.h"
 #include "../platform/thread.h"
+#include "autosave.h"
 #include "client_interface.h"
 #include "inventory_logic.h"
 #include "server_interface.h"
 #include "server_local.h"
 #include "server_world.h"
+#include "worldgen.h"
 #include "complex_block_archive.h"
 
 #define CHUNK_DIST2(x1, x2, z1, z2)                                            \
@@ -235,6 +237,21 @@ void server_local_set_player_health(struct server_local* s, short new_health) {
 	});
 }
 
+static void server_local_save_level(struct server_local* s) {
+	assert(s);
+
+	level_archive_write_player(
+		&s->level, (vec3) {s->player.x, s->player.y, s->player.z},
+		(vec2) {s->player.rx, s->player.ry}, NULL, s->player.dimension);
+
+	level_archive_write_inventory(&s->level, &s->player.inventory);
+	level_archive_write(&s->level, LEVEL_TIME, &s->world_time);
+
+	level_archive_write(&s->level, LEVEL_PLAYER_HEALTH, &s->player.health);
+
+	complex_block_archive_write(&s->world, s->level_name);
+}
+
 static void server_local_process(struct server_rpc* call, void* user) {
 	assert(call && user);
 
@@ -408,17 +425,7 @@ static void server_local_process(struct server_rpc* call, void* user) {
 				.payload.world_reset.local_entity = 0,
 			});
 
-			level_archive_write_player(
-				&s->level, (vec3) {s->player.x, s->player.y, s->player.z},
-				(vec2) {s->player.rx, s->player.ry}, NULL, s->player.dimension);
-
-			level_archive_write_inventory(&s->level, &s->player.inventory);
-			level_archive_write(&s->level, LEVEL_TIME, &s->world_time);
-
-			level_archive_write(&s->level, LEVEL_PLAYER_HEALTH, &s->player.health);
-
-			chest_archive_write(s->chest_pos, s->chest_items[0], s->level_name);
-			sign_archive_write(s->sign_pos, s->sign_texts[0], s->level_name);
+			server_local_save_level(s);
 
 			dict_entity_it_t it;
 			dict_entity_it(it, s->entities);
@@ -430,6 +437,7 @@ static void server_local_process(struct server_rpc* call, void* user) {
 			dict_entity_reset(s->entities);
 			server_world_destroy(&s->world);
 			level_archive_destroy(&s->level);
+			worldgen_reset();
 
 			s->player.has_pos = false;
 			s->player.finished_loading = false;
@@ -469,9 +477,13 @@ static void server_local_process(struct server_rpc* call, void* user) {
 					s->player.old_vel_y = 0;
 					s->player.vel_y = 0;
 					s->player.has_pos = true;
+
+					complex_block_archive_read(&s->world, s->level_name);
 				}
 
 				level_archive_read(&s->level, LEVEL_TIME, &s->world_time, 0);
+				level_archive_read(&s->level, LEVEL_RANDOM_SEED,
+								   &s->world.seed, 0);
 
 				level_archive_read(&s->level, LEVEL_PLAYER_HEALTH, &s->player.health, 0);
 				if (s->player.health > MAX_PLAYER_HEALTH) s->player.health = MAX_PLAYER_HEALTH;
@@ -479,9 +491,6 @@ static void server_local_process(struct server_rpc* call, void* user) {
 				level_archive_read(&s->level, LEVEL_PLAYER_SPAWNY, &s->player.spawn_y, 0);
 				level_archive_read(&s->level, LEVEL_PLAYER_SPAWNZ, &s->player.spawn_z, 0);
 
-				chest_archive_read(s->chest_pos, s->chest_items[0], s->level_name);
-				sign_archive_read(s->sign_pos, s->sign_texts[0], s->level_name);
-
 				s->player.oxygen = MAX_OXYGEN;
 
 				dict_entity_reset(s->entities);
@@ -502,6 +511,34 @@ static void server_local_process(struct server_rpc* call, void* user) {
 	}
 }
 
+static void server_local_send_chunk(w_coord_t x, w_coord_t z,
+									struct server_chunk* sc) {
+	size_t sz = CHUNK_SIZE * CHUNK_SIZE * WORLD_HEIGHT;
+	void* ids = malloc(sz);
+	void* metadata = malloc(sz / 2);
+	void* lighting_sky = malloc(sz / 2);
+	void* lighting_torch = malloc(sz / 2);
+
+	memcpy(ids, sc->ids, sz);
+	memcpy(metadata, sc->metadata, sz / 2);
+	memcpy(lighting_sky, sc->lighting_sky, sz / 2);
+	memcpy(lighting_torch, sc->lighting_torch, sz / 2);
+
+	clin_rpc_send(&(struct client_rpc) {
+		.type = CRPC_CHUNK,
+		.payload.chunk.x = x * CHUNK_SIZE,
+		.payload.chunk.y = 0,
+		.payload.chunk.z = z * CHUNK_SIZE,
+		.payload.chunk.sx = CHUNK_SIZE,
+		.payload.chunk.sy = WORLD_HEIGHT,
+		.payload.chunk.sz = CHUNK_SIZE,
+		.payload.chunk.ids = ids,
+		.payload.chunk.metadata = metadata,
+		.payload.chunk.lighting_sky = lighting_sky,
+		.payload.chunk.lighting_torch = lighting_torch,
+	});
+}
+
 static void server_local_update(struct server_local* s) {
 	assert(s);
 
@@ -559,9 +596,15 @@ static void server_local_update(struct server_local* s) {
 	w_coord_t px = WCOORD_CHUNK_OFFSET(floor(s->player.x));
 	w_coord_t pz = WCOORD_CHUNK_OFFSET(floor(s->player.z));
 
-	server_world_random_tick(&s->world, &s->rand_src, s, px, pz,
-							 MAX_VIEW_DISTANCE - 2);
-	server_world_tick(&s->world, s);
+	server_world_random_tick(&s->world, s, px, pz, MAX_VIEW_DISTANCE - 2);
+	pressure_plate_step(s);
+	block_tick_run(s);
+
+	// chunks are written by the save thread, the rest is small enough
+	if(autosave_tick(&s->world)) {
+		server_local_save_level(s);
+		level_archive_flush(&s->level);
+	}
 
 	w_coord_t cx, cz;
 	if(server_world_furthest_chunk(&s->world, MAX_VIEW_DISTANCE, px, pz, &cx,
@@ -575,54 +618,61 @@ static void server_local_update(struct server_local* s) {
 		});
 	}
 
+	// chunks beyond the saved world, generated in the background
+	w_coord_t gx, gz;
+	struct server_chunk generated;
+	while(worldgen_receive(&gx, &gz, &generated)) {
+		struct server_chunk* sc
+			= server_world_add_chunk(&s->world, gx, gz, &generated);
+
+		if(sc)
+			server_local_send_chunk(gx, gz, sc);
+	}
+
 	// iterate over all chunks that should be loaded
 	bool c_nearest = false;
 	w_coord_t c_nearest_x, c_nearest_z;
 	w_coord_t c_nearest_dist2;
+	bool g_nearest = false;
+	w_coord_t g_nearest_x, g_nearest_z;
+	w_coord_t g_nearest_dist2;
 	for(w_coord_t z = pz - MAX_VIEW_DISTANCE; z <= pz + MAX_VIEW_DISTANCE;
 		z++) {
 		for(w_coord_t x = px - MAX_VIEW_DISTANCE; x <= px + MAX_VIEW_DISTANCE;
 			x++) {
 			w_coord_t d = CHUNK_DIST2(px, x, pz, z);
-			if(!server_world_is_chunk_loaded(&s->world, x, z)
-			   && (d < c_nearest_dist2 || !c_nearest)
-			   && server_world_disk_has_chunk(&s->world, x, z)) {
-				c_nearest_dist2 = d;
-				c_nearest_x = x;
-				c_nearest_z = z;
-				c_nearest = true;
+			if(server_world_is_chunk_loaded(&s->world, x, z)
+			   || autosave_pending(x, z)
+			   || ((c_nearest && d >= c_nearest_dist2)
+				   && (g_nearest && d >= g_nearest_dist2)))
+				continue;
+
+			if(server_world_disk_has_chunk(&s->world, x, z)) {
+				if(d < c_nearest_dist2 || !c_nearest) {
+					c_nearest_dist2 = d;
+					c_nearest_x = x;
+					c_nearest_z = z;
+					c_nearest = true;
+				}
+			} else if(s->world.dimension == WORLD_DIM_OVERWORLD
+					  && (d < g_nearest_dist2 || !g_nearest)
+					  && !worldgen_requested(x, z)) {
+				g_nearest_dist2 = d;
+				g_nearest_x = x;
+				g_nearest_z = z;
+				g_nearest = true;
 			}
 		}
 	}
 
+	if(g_nearest)
+		worldgen_request(s->world.seed, g_nearest_x, g_nearest_z);
+
 	// load just one chunk
 	struct server_chunk* sc;
 	if(c_nearest
 	   && server_world_load_chunk(&s->world, c_nearest_x, c_nearest_z, &sc)) {
-		size_t sz = CHUNK_SIZE * CHUNK_SIZE * WORLD_HEIGHT;
-		void* ids = malloc(sz);
-		void* metadata = malloc(sz / 2);
-		void* lighting_sky = malloc(sz / 2);
-		void* lighting_torch = malloc(sz / 2);
-
-		memcpy(ids, sc->ids, sz);
-		memcpy(metadata, sc->metadata, sz / 2);
-		memcpy(lighting_sky, sc->lighting_sky, sz / 2);
-		memcpy(lighting_torch, sc->lighting_torch, sz / 2);
-
-		clin_rpc_send(&(struct client_rpc) {
-			.type = CRPC_CHUNK,
-			.payload.chunk.x = c_nearest_x * CHUNK_SIZE,
-			.payload.chunk.y = 0,
-			.payload.chunk.z = c_nearest_z * CHUNK_SIZE,
-			.payload.chunk.sx = CHUNK_SIZE,
-			.payload.chunk.sy = WORLD_HEIGHT,
-			.payload.chunk.sz = CHUNK_SIZE,
-			.payload.chunk.ids = ids,
-			.payload.chunk.metadata = metadata,
-			.payload.chunk.lighting_sky = lighting_sky,
-			.payload.chunk.lighting_torch = lighting_torch,
-		});
+		server_local_send_chunk(c_nearest_x, c_nearest_z, sc);
 	} else if(!s->player.finished_loading) {
 		struct client_rpc pos;
 		pos.type = CRPC_PLAYER_POS;
@@ -715,8 +765,9 @@ void server_local_create(struct server_local* s) {
 					 INVENTORY_SIZE, 0, 0, 0);
 	s->player.active_inventory = &s->player.inventory;
 	dict_entity_init(s->entities);
-	memset(s->chest_pos, -1, MAX_CHESTS*3*sizeof(int));
-	memset(s->sign_pos, -1, MAX_SIGNS*3*sizeof(int));
+
+	worldgen_init();
+	autosave_init();
 
 	struct thread t;
 	thread_create(&t, server_local_thread, s, 8);
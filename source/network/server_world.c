@@ -21,10 +21,12 @@
 
 #include "../lighting.h"
 #include "../util.h"
+#include "autosave.h"
 #include "client_interface.h"
+#include "fluid.h"
+#include "redstone.h"
 #include "server_local.h"
 #include "server_world.h"
-#include "../daytime.h"
 
 #define EXPLOSION_MAX_RAYS 300
 #define EXPLOSION_STEP     0.5f
@@ -51,14 +53,121 @@ static void random_unit_vector(vec3 out) {
 
 
 
+#define RANDOM_TICKS_PER_SECTION 10
+
+static inline bool random_tickable(uint8_t type) {
+	return blocks[type] && blocks[type]->onRandomTick;
+}
+
+static void server_chunk_random_tick_init(struct server_chunk* sc, w_coord_t x,
+										  w_coord_t z) {
+	assert(sc);
+
+	memset(sc->random_tickable, 0, sizeof(sc->random_tickable));
+
+	for(size_t idx = 0; idx < CHUNK_SIZE * CHUNK_SIZE * WORLD_HEIGHT; idx++) {
+		if(random_tickable(sc->ids[idx]))
+			sc->random_tickable[(idx % WORLD_HEIGHT) / CHUNK_SIZE]++;
+	}
+
+	// xorshift must not be seeded with zero
+	sc->random_tick.seed = hash_u32(hash_u32(x) ^ z) | 1;
+}
+
+/* Scheduled ticks are not saved. A block with onWorldTick and non-zero
+ * metadata (lit TNT, pressed plate) was still waiting for one. */
+static void server_chunk_resume_ticks(struct server_world* w,
+									  struct server_chunk* sc, w_coord_t x,
+									  w_coord_t z) {
+	assert(w && sc);
+
+	for(size_t idx = 0; idx < CHUNK_SIZE * CHUNK_SIZE * WORLD_HEIGHT; idx++) {
+		uint8_t type = sc->ids[idx];
+
+		if(blocks[type] && blocks[type]->onWorldTick
+		   && nibble_read(sc->metadata, idx))
+			block_tick_schedule(
+				w, x * CHUNK_SIZE + idx / (CHUNK_SIZE * WORLD_HEIGHT),
+				idx % WORLD_HEIGHT,
+				z * CHUNK_SIZE + (idx / WORLD_HEIGHT) % CHUNK_SIZE, 1);
+	}
+}
+
+void server_chunk_storage(struct server_chunk* sc, uint8_t* storage) {
+	assert(sc && storage);
+
+	size_t blocks = CHUNK_SIZE * CHUNK_SIZE * WORLD_HEIGHT;
+	sc->ids = storage;
+	sc->metadata = sc->ids + blocks;
+	sc->lighting_sky = sc->metadata + blocks / 2;
+	sc->lighting_torch = sc->lighting_sky + blocks / 2;
+	sc->heightmap = sc->lighting_torch + blocks / 2;
+}
+
 void server_world_chunk_destroy(struct server_chunk* sc) {
 	assert(sc);
 
 	free(sc->ids);
-	free(sc->metadata);
-	free(sc->lighting_sky);
-	free(sc->lighting_torch);
-	free(sc->heightmap);
+
+	if(sc->tick_pending)
+		free(sc->tick_pending);
+
+	tile_entity_store_destroy(sc->tile_entities);
+}
+
+bool server_world_chunk_alloc(struct server_world* w,
+							  struct server_chunk* sc) {
+	assert(w && sc);
+
+	uint8_t* storage = (w->storage_pool_length > 0) ?
+		w->storage_pool[--w->storage_pool_length] :
+		malloc(SERVER_CHUNK_STORAGE);
+
+	if(!storage)
+		return false;
+
+	*sc = (struct server_chunk) {
+		.modified = false,
+		.tick_pending = NULL,
+		.tile_entities = NULL,
+	};
+
+	server_chunk_storage(sc, storage);
+	return true;
+}
+
+void server_world_chunk_release(struct server_world* w,
+								struct server_chunk* sc) {
+	assert(w && sc);
+
+	if(w->storage_pool_length >= CHUNK_STORAGE_POOL) {
+		server_world_chunk_destroy(sc);
+		return;
+	}
+
+	w->storage_pool[w->storage_pool_length++] = sc->ids;
+
+	if(sc->tick_pending)
+		free(sc->tick_pending);
+
+	tile_entity_store_destroy(sc->tile_entities);
+}
+
+static void server_world_disk_lock(struct server_world* w) {
+	void* token;
+	tchannel_receive(&w->disk_lock, &token, true);
+}
+
+static void server_world_disk_unlock(struct server_world* w) {
+	tchannel_send(&w->disk_lock, w, true);
+}
+
+static void server_world_mark_dirty(struct server_world* w,
+									struct server_chunk* sc, int64_t id) {
+	if(!sc->modified) {
+		sc->modified = true;
+		array_chunk_ids_push_back(w->dirty, id);
+	}
 }
 
 void server_world_create(struct server_world* w, string_t level_name,
@@ -69,7 +178,23 @@ void server_world_create(struct server_world* w, string_t level_name,
 	ilist_regions_init(w->loaded_regions_lru);
 	string_init_set(w->level_name, level_name);
 	w->dimension = dimension;
+	w->seed = 0;
 	w->loaded_regions_length = 0;
+	w->storage_pool_length = 0;
+	array_chunk_ids_init(w->dirty);
+	array_tile_entities_init(w->legacy_tile_entities);
+	chunk_nbt_init(&w->nbt);
+	tchannel_init(&w->disk_lock, 1);
+	server_world_disk_unlock(w);
+	w->compact_queued = false;
+	w->compacting = false;
+	tchannel_init(&w->compact_lock, 1);
+	tchannel_send(&w->compact_lock, w, true);
+	w->batch = NULL;
+	w->batch_length = 0;
+	w->batch_capacity = 0;
+	w->batching = false;
+	block_tick_init(&w->ticks);
 }
 
 void server_world_destroy(struct server_world* w) {
@@ -81,14 +206,49 @@ void server_world_destroy(struct server_world* w) {
 	while(!dict_server_chunks_end_p(it)) {
 		struct server_chunk* sc = &dict_server_chunks_ref(it)->value;
 		int64_t id = dict_server_chunks_ref(it)->key;
-		server_world_save_chunk_obj(w, false, S_CHUNK_X(id), S_CHUNK_Z(id), sc);
-		server_world_chunk_destroy(sc);
+
+		// most chunks were saved already, the rest is handed over as is
+		if(sc->modified) {
+			autosave_chunk(w, S_CHUNK_X(id), S_CHUNK_Z(id), sc, false);
+
+			if(sc->tick_pending)
+				free(sc->tick_pending);
+		} else {
+			server_world_chunk_destroy(sc);
+		}
 
 		dict_server_chunks_next(it);
 	}
 
+	// the save thread is done with any compaction it started
+	autosave_flush();
+
+	if(w->compact_queued)
+		region_archive_destroy(&w->compact_region);
+
 	dict_server_chunks_clear(w->chunks);
+	array_chunk_ids_clear(w->dirty);
+
+	array_tile_entities_it_t lit;
+	array_tile_entities_it(lit, w->legacy_tile_entities);
+
+	while(!array_tile_entities_end_p(lit)) {
+		free(*array_tile_entities_ref(lit));
+		array_tile_entities_next(lit);
+	}
+
+	array_tile_entities_clear(w->legacy_tile_entities);
+	tchannel_close(&w->disk_lock);
+	tchannel_close(&w->compact_lock);
 	string_clear(w->level_name);
+	block_tick_destroy(&w->ticks);
+	chunk_nbt_destroy(&w->nbt);
+
+	for(size_t k = 0; k < w->storage_pool_length; k++)
+		free(w->storage_pool[k]);
+
+	if(w->batch)
+		free(w->batch);
 }
 
 static bool server_chunk_get_block(void* user, c_coord_t x, w_coord_t y,
@@ -146,7 +306,8 @@ static void server_world_light_set_light(void* user, w_coord_t x, w_coord_t y,
 	size_t idx = S_CHUNK_IDX(x, y, z);
 	nibble_write(sc->lighting_sky, idx, light & 0xF);
 	nibble_write(sc->lighting_torch, idx, light >> 4);
-	sc->modified = true;
+	server_world_mark_dirty(
+		w, sc, S_CHUNK_ID(WCOORD_CHUNK_OFFSET(x), WCOORD_CHUNK_OFFSET(z)));
 }
 
 bool server_world_get_block(struct server_world* w, w_coord_t x, w_coord_t y,
@@ -183,9 +344,20 @@ bool server_world_set_block(struct server_local* s, w_coord_t x, w_coord_t y, w_
 	struct server_chunk* sc = dict_server_chunks_get(
 		w->chunks, S_CHUNK_ID(WCOORD_CHUNK_OFFSET(x), WCOORD_CHUNK_OFFSET(z)));
 
+	uint8_t previous = BLOCK_AIR;
+
 	if(sc) {
 		size_t idx = S_CHUNK_IDX(x, y, z);
-		sc->modified = true;
+		server_world_mark_dirty(
+			w, sc, S_CHUNK_ID(WCOORD_CHUNK_OFFSET(x), WCOORD_CHUNK_OFFSET(z)));
+		previous = sc->ids[idx];
+
+		if(random_tickable(sc->ids[idx]))
+			sc->random_tickable[y / CHUNK_SIZE]--;
+
+		if(random_tickable(blk.type))
+			sc->random_tickable[y / CHUNK_SIZE]++;
+
 		sc->ids[idx] = blk.type;
 		nibble_write(sc->metadata, idx, blk.metadata);
 
@@ -204,13 +376,32 @@ bool server_world_set_block(struct server_local* s, w_coord_t x, w_coord_t y, w_
 			w->dimension == WORLD_DIM_NETHER, server_world_light_get_block,
 			server_world_light_set_light, w);
 
-		clin_rpc_send(&(struct client_rpc) {
-			.type = CRPC_SET_BLOCK,
-			.payload.set_block.x = x,
-			.payload.set_block.y = y,
-			.payload.set_block.z = z,
-			.payload.set_block.block = blk,
-		});
+		if(w->batching) {
+			if(w->batch_length >= w->batch_capacity) {
+				w->batch_capacity = w->batch_capacity ? w->batch_capacity * 2 : 64;
+				w->batch = realloc(w->batch,
+								   w->batch_capacity * sizeof(*w->batch));
+				assert(w->batch);
+			}
+
+			w->batch[w->batch_length++] = (struct world_modification_entry) {
+				.x = x,
+				.y = y,
+				.z = z,
+				.blk = blk,
+			};
+		} else {
+			clin_rpc_send(&(struct client_rpc) {
+				.type = CRPC_SET_BLOCK,
+				.payload.set_block.x = x,
+				.payload.set_block.y = y,
+				.payload.set_block.z = z,
+				.payload.set_block.block = blk,
+			});
+		}
+
+		if(fluid_is(blk.type))
+			fluid_schedule(w, x, y, z, blk.type);
 	}
 
     static const int dx[6] = {  1, -1,  0,  0,  0,  0 };
@@ -226,6 +417,9 @@ bool server_world_set_block(struct server_local* s, w_coord_t x, w_coord_t y, w_
         if (!server_world_get_block(w, nx, ny, nz, &nb))
             continue;
 
+        if (fluid_is(nb.type))
+            fluid_schedule(w, nx, ny, nz, nb.type);
+
         const struct block* b = blocks[nb.type];
         if (b && b->onNeighbourBlockChange) {
             struct block_info info = {
@@ -239,9 +433,47 @@ bool server_world_set_block(struct server_local* s, w_coord_t x, w_coord_t y, w_
         }
     }
 
+	if(sc && (redstone_relevant(previous) || redstone_relevant(blk.type)))
+		redstone_update(s, x, y, z);
+
 	return sc;
 }
 
+void server_world_batch_begin(struct server_world* w) {
+	assert(w && !w->batching);
+	w->batching = true;
+	w->batch_length = 0;
+}
+
+void server_world_batch_end(struct server_world* w) {
+	assert(w && w->batching);
+	w->batching = false;
+
+	if(w->batch_length == 1) {
+		clin_rpc_send(&(struct client_rpc) {
+			.type = CRPC_SET_BLOCK,
+			.payload.set_block.x = w->batch->x,
+			.payload.set_block.y = w->batch->y,
+			.payload.set_block.z = w->batch->z,
+			.payload.set_block.block = w->batch->blk,
+		});
+	} else if(w->batch_length > 1) {
+		// freed by the client
+		size_t size = w->batch_length * sizeof(*w->batch);
+		struct world_modification_entry* list = malloc(size);
+		assert(list);
+		memcpy(list, w->batch, size);
+
+		clin_rpc_send(&(struct client_rpc) {
+			.type = CRPC_SET_BLOCKS,
+			.payload.set_blocks.list = list,
+			.payload.set_blocks.length = w->batch_length,
+		});
+	}
+
+	w->batch_length = 0;
+}
+
 bool server_world_furthest_chunk(struct server_world* w, w_coord_t dist,
 								 w_coord_t px, w_coord_t pz, w_coord_t* x,
 								 w_coord_t* z) {
@@ -275,38 +507,112 @@ bool server_world_is_chunk_loaded(struct server_world* w, w_coord_t x,
 	return dict_server_chunks_get(w->chunks, S_CHUNK_ID(x, z)) != NULL;
 }
 
+static bool tile_entity_matches_block(struct tile_entity* te, uint8_t type) {
+	switch(te->type) {
+		case TILE_ENTITY_CHEST:
+			return type == BLOCK_CHEST || type == BLOCK_IRON_CHEST;
+		case TILE_ENTITY_SIGN: return type == BLOCK_SIGN;
+		default: return false;
+	}
+}
+
+static void server_world_adopt_tile_entities(struct server_world* w,
+											 w_coord_t x, w_coord_t z,
+											 struct server_chunk* sc) {
+	size_t k = 0;
+	while(k < array_tile_entities_size(w->legacy_tile_entities)) {
+		struct tile_entity* te
+			= *array_tile_entities_get(w->legacy_tile_entities, k);
+
+		if(WCOORD_CHUNK_OFFSET(te->x) != x || WCOORD_CHUNK_OFFSET(te->z) != z) {
+			k++;
+			continue;
+		}
+
+		// chunk data is newer, unless it lacks the entity
+		if(!tile_entity_store_get(sc->tile_entities, te->x, te->y, te->z)
+		   && tile_entity_matches_block(
+			   te, sc->ids[S_CHUNK_IDX(te->x, te->y, te->z)])) {
+			tile_entity_store_add(&sc->tile_entities, te);
+			server_world_mark_dirty(w, sc, S_CHUNK_ID(x, z));
+		}
+
+		free(te);
+		array_tile_entities_erase(w->legacy_tile_entities, k);
+	}
+}
+
 bool server_world_load_chunk(struct server_world* w, w_coord_t x, w_coord_t z,
 							 struct server_chunk** sc) {
 	assert(w && sc);
 
-	if(server_world_is_chunk_loaded(w, x, z))
+	// the copy on disk is outdated until the save thread is done with it
+	if(server_world_is_chunk_loaded(w, x, z) || autosave_pending(x, z))
 		return false;
 
+	server_world_disk_lock(w);
+
 	ilist_regions_it_t it;
 	ilist_regions_it(it, w->loaded_regions_lru);
 
 	while(!ilist_regions_end_p(it)) {
 		struct region_archive* ra = ilist_regions_ref(it);
 
-		struct server_chunk tmp = (struct server_chunk) {.modified = false};
-
 		bool chunk_exists;
 		if(region_archive_contains(ra, x, z, &chunk_exists)) {
-			if(chunk_exists && region_archive_get_blocks(ra, x, z, &tmp)) {
-				dict_server_chunks_set_at(w->chunks, S_CHUNK_ID(x, z), tmp);
-				*sc = dict_server_chunks_get(w->chunks, S_CHUNK_ID(x, z));
-				return true;
-			} else {
+			struct server_chunk tmp;
+
+			if(!chunk_exists || !server_world_chunk_alloc(w, &tmp)) {
+				server_world_disk_unlock(w);
+				return false;
+			}
+
+			bool success = region_archive_get_blocks(ra, &w->nbt, x, z, &tmp);
+			server_world_disk_unlock(w);
+
+			if(!success) {
+				server_world_chunk_release(w, &tmp);
 				return false;
 			}
+
+			server_chunk_random_tick_init(&tmp, x, z);
+			dict_server_chunks_set_at(w->chunks, S_CHUNK_ID(x, z), tmp);
+			*sc = dict_server_chunks_get(w->chunks, S_CHUNK_ID(x, z));
+			server_world_adopt_tile_entities(w, x, z, *sc);
+			server_chunk_resume_ticks(w, *sc, x, z);
+			return true;
 		}
 
 		ilist_regions_next(it);
 	}
 
+	server_world_disk_unlock(w);
 	return false;
 }
 
+struct server_chunk* server_world_add_chunk(struct server_world* w,
+											w_coord_t x, w_coord_t z,
+											struct server_chunk* sc) {
+	assert(w && sc);
+
+	if(server_world_is_chunk_loaded(w, x, z)) {
+		server_world_chunk_destroy(sc);
+		return NULL;
+	}
+
+	server_chunk_random_tick_init(sc, x, z);
+	sc->modified = true;
+	dict_server_chunks_set_at(w->chunks, S_CHUNK_ID(x, z), *sc);
+
+	// written out with the next autosave pass
+	array_chunk_ids_push_back(w->dirty, S_CHUNK_ID(x, z));
+
+	struct server_chunk* res
+		= dict_server_chunks_get(w->chunks, S_CHUNK_ID(x, z));
+	server_world_adopt_tile_entities(w, x, z, res);
+	return res;
+}
+
 void server_world_save_chunk(struct server_world* w, bool erase, w_coord_t x,
 							 w_coord_t z) {
 	assert(w);
@@ -321,38 +627,146 @@ void server_world_save_chunk_obj(struct server_world* w, bool erase,
 								 struct server_chunk* c) {
 	assert(w && c);
 
-	if(c->modified) {
-		//  load region archive into cache
-		struct region_archive tmp;
-		struct region_archive* ra = server_world_chunk_region(w, x, z);
-
-		if(!ra) {
-			if(!region_archive_create_new(&tmp, w->level_name,
-										  CHUNK_REGION_COORD(x),
-										  CHUNK_REGION_COORD(z), w->dimension))
-				return;
-			ra = &tmp;
-		}
+	// an unloaded chunk gives its storage to the save thread, no copy needed
+	bool handed_over = c->modified && erase;
 
-		region_archive_set_blocks(ra, x, z, c);
-		c->modified = false;
-	}
+	if(c->modified)
+		autosave_chunk(w, x, z, c, !erase);
 
 	if(erase) {
-		server_world_chunk_destroy(c);
+		if(handed_over) {
+			if(c->tick_pending)
+				free(c->tick_pending);
+		} else {
+			server_world_chunk_release(w, c);
+		}
+
 		dict_server_chunks_erase(w->chunks, S_CHUNK_ID(x, z));
 	}
 }
 
+bool server_world_disk_write(struct server_world* w, w_coord_t x, w_coord_t z,
+							 uint8_t* nbt, size_t nbt_length) {
+	assert(w && nbt);
+
+	server_world_disk_lock(w);
+
+	//  load region archive into cache
+	struct region_archive tmp;
+	struct region_archive* ra = server_world_chunk_region(w, x, z);
+
+	if(!ra) {
+		if(!region_archive_create_new(&tmp, w->level_name,
+									  CHUNK_REGION_COORD(x),
+									  CHUNK_REGION_COORD(z), w->dimension)) {
+			server_world_disk_unlock(w);
+			return false;
+		}
+
+		ra = &tmp;
+	}
+
+	bool success = region_archive_write_chunk(ra, x, z, nbt, nbt_length);
+
+	if(ra == &tmp)
+		region_archive_destroy(&tmp);
+
+	server_world_disk_unlock(w);
+	return success;
+}
+
+// called by the save thread, the disk stays unlocked while the file is rewritten
+void server_world_disk_compact(struct server_world* w) {
+	assert(w);
+
+	server_world_disk_lock(w);
+
+	if(!w->compact_queued) {
+		server_world_disk_unlock(w);
+		return;
+	}
+
+	struct region_archive ra = w->compact_region;
+	w->compact_queued = false;
+	w->compacting = true;
+
+	void* token;
+	tchannel_receive(&w->compact_lock, &token, true);
+	server_world_disk_unlock(w);
+
+	region_archive_compact(&ra, NULL, NULL);
+	region_archive_destroy(&ra);
+	tchannel_send(&w->compact_lock, w, true);
+
+	server_world_disk_lock(w);
+	w->compacting = false;
+	server_world_disk_unlock(w);
+}
+
 bool server_world_disk_has_chunk(struct server_world* w, w_coord_t x,
 								 w_coord_t z) {
+	server_world_disk_lock(w);
 	struct region_archive* ra = server_world_chunk_region(w, x, z);
 	bool chunk_exists;
-	return ra ?
+	bool res = ra ?
 		(region_archive_contains(ra, x, z, &chunk_exists) && chunk_exists) :
 		false;
+	server_world_disk_unlock(w);
+	return res;
+}
+
+struct tile_entity* server_world_tile_entity(struct server_world* w,
+											 w_coord_t x, w_coord_t y,
+											 w_coord_t z, bool modify) {
+	assert(w);
+
+	int64_t id = S_CHUNK_ID(WCOORD_CHUNK_OFFSET(x), WCOORD_CHUNK_OFFSET(z));
+	struct server_chunk* sc = dict_server_chunks_get(w->chunks, id);
+
+	if(!sc)
+		return NULL;
+
+	struct tile_entity* te = tile_entity_store_get(sc->tile_entities, x, y, z);
+
+	if(te && modify)
+		server_world_mark_dirty(w, sc, id);
+
+	return te;
+}
+
+struct tile_entity* server_world_add_tile_entity(struct server_world* w,
+												 enum tile_entity_type type,
+												 w_coord_t x, w_coord_t y,
+												 w_coord_t z) {
+	assert(w);
+
+	int64_t id = S_CHUNK_ID(WCOORD_CHUNK_OFFSET(x), WCOORD_CHUNK_OFFSET(z));
+	struct server_chunk* sc = dict_server_chunks_get(w->chunks, id);
+
+	if(!sc || y < 0 || y >= WORLD_HEIGHT)
+		return NULL;
+
+	struct tile_entity te;
+	tile_entity_init(&te, type, x, y, z);
+	server_world_mark_dirty(w, sc, id);
+	return tile_entity_store_add(&sc->tile_entities, &te);
 }
 
+bool server_world_remove_tile_entity(struct server_world* w, w_coord_t x,
+									 w_coord_t y, w_coord_t z) {
+	assert(w);
+
+	int64_t id = S_CHUNK_ID(WCOORD_CHUNK_OFFSET(x), WCOORD_CHUNK_OFFSET(z));
+	struct server_chunk* sc = dict_server_chunks_get(w->chunks, id);
+
+	if(!sc || !tile_entity_store_remove(sc->tile_entities, x, y, z))
+		return false;
+
+	server_world_mark_dirty(w, sc, id);
+	return true;
+}
+
+// must only be called with the disk lock held
 struct region_archive* server_world_chunk_region(struct server_world* w,
 												 w_coord_t x, w_coord_t z) {
 	assert(w);
@@ -368,10 +782,28 @@ struct region_archive* server_world_chunk_region(struct server_world* w,
 		}
 	}
 
+	w_coord_t rx = CHUNK_REGION_COORD(x);
+	w_coord_t rz = CHUNK_REGION_COORD(z);
+	bool compact_match
+		= w->compact_region.x == rx && w->compact_region.z == rz;
+
 	struct region_archive ra;
-	if(!region_archive_create(&ra, w->level_name, CHUNK_REGION_COORD(x),
-							  CHUNK_REGION_COORD(z), w->dimension))
-		return NULL;
+	if(w->compact_queued && compact_match) {
+		// needed again before the save thread got to it, keep it as is
+		ra = w->compact_region;
+		w->compact_queued = false;
+	} else {
+		// the file is being rewritten, only this region has to wait for it
+		if(w->compacting && compact_match) {
+			void* token;
+			tchannel_receive(&w->compact_lock, &token, true);
+			tchannel_send(&w->compact_lock, w, true);
+			w->compacting = false;
+		}
+
+		if(!region_archive_create(&ra, w->level_name, rx, rz, w->dimension))
+			return NULL;
+	}
 
 	struct region_archive* lru;
 	if(ilist_regions_size(w->loaded_regions_lru) < MAX_REGIONS) {
@@ -379,7 +811,15 @@ struct region_archive* server_world_chunk_region(struct server_world* w,
 		lru = w->loaded_regions + (w->loaded_regions_length++);
 	} else {
 		lru = ilist_regions_pop_front(w->loaded_regions_lru);
-		region_archive_destroy(lru);
+
+		// all writes to this region are done, good time to defragment it
+		if(!w->compact_queued && !w->compacting
+		   && region_archive_dead_sectors(lru) >= REGION_COMPACT_MIN_DEAD) {
+			w->compact_region = *lru;
+			w->compact_queued = true;
+		} else {
+			region_archive_destroy(lru);
+		}
 	}
 
 	*lru = ra;
@@ -389,95 +829,9 @@ struct region_archive* server_world_chunk_region(struct server_world* w,
 }
 
 
-void server_world_tick(struct server_world* w, struct server_local* s) {
-    dict_server_chunks_it_t it;
-    dict_server_chunks_it(it, w->chunks);
-
-    while (!dict_server_chunks_end_p(it)) {
-        struct server_chunk* sc   = &dict_server_chunks_ref(it)->value;
-        w_coord_t        baseX    = S_CHUNK_X(dict_server_chunks_ref(it)->key) * CHUNK_SIZE;
-        w_coord_t        baseZ    = S_CHUNK_Z(dict_server_chunks_ref(it)->key) * CHUNK_SIZE;
-
-        for (int cx = 0; cx < CHUNK_SIZE; cx++) {
-            for (int cz = 0; cz < CHUNK_SIZE; cz++) {
-                for (int y = 0; y < WORLD_HEIGHT; y++) {
-                    struct block_data blk;
-                    if (!server_chunk_get_block(sc, cx, y, cz, &blk))
-                        continue;
-
-                    const struct block* b = blocks[blk.type];
-                    if (!b || !b->onWorldTick)
-                        continue;
-
-
-                    // determine if we need any neigbour info, only is needed for these types
-                    bool needNeighbours =
-                        (blk.type == BLOCK_REDSTONE_WIRE) ||
-                        (blk.type == BLOCK_REDSTONE_TORCH) ||
-						(blk.type == BLOCK_TNT) ||
-						(blk.type == BLOCK_WOOD_PRESSURE_PLATE) ||
-						(blk.type == BLOCK_STONE_PRESSURE_PLATE)||
-						(blk.type == BLOCK_DOOR_WOOD)||
-						(blk.type == BLOCK_DOOR_IRON) ||
-						(blk.type == BLOCK_RAIL) ||
-						(blk.type == BLOCK_POWERED_RAIL) ||
-						(blk.type == BLOCK_DETECTOR_RAIL)
-						;
-
-                    struct block_data neighbour_data[SIDE_MAX];
-                    struct block_data* neigh_ptr = NULL;
-                    if (needNeighbours) {
-
-						for (int side = 0; side < SIDE_MAX; ++side) {
-							int ox, oy, oz;
-							blocks_side_offset((enum side)side, &ox, &oy, &oz);
-
-							w_coord_t nx = baseX + cx + ox;
-							w_coord_t ny = y        + oy;
-							w_coord_t nz = baseZ + cz + oz;
-
-                            if (!server_world_get_block(&s->world,
-                                                        nx, ny, nz,
-                                                        &neighbour_data[side]))
-							{
-                                neighbour_data[side].type        = BLOCK_AIR;
-                                neighbour_data[side].metadata    = 0;
-                                neighbour_data[side].sky_light   = 0;
-                                neighbour_data[side].torch_light = 0;
-							}
-						}
-
-                        neigh_ptr = neighbour_data;
-
-                    }
-                    struct block_info info = {
-                        .block      = &blk,
-                        .neighbours = neigh_ptr,
-                        .x          = baseX + cx,
-                        .y          = y,
-                        .z          = baseZ + cz
-                    };
-
-                    b->onWorldTick(s, &info);
-						
-					float time = fmodf(daytime_get_time(), 24000.0f);
-					if (b->onDay && time >= 0.0f && time < 13000.0f)
-						b->onDay(s, &info);
-
-					if (b->onNight && time >= 13000.0f && time < 24000.0f)
-						b->onNight(s, &info);	
-                    }
-                }
-            }
-
-        dict_server_chunks_next(it);
-    }
-}
-
-void server_world_random_tick(struct server_world* w, struct random_gen* g,
-							  struct server_local* s, w_coord_t px,
-							  w_coord_t pz, w_coord_t dist) {
-	assert(w && g && s);
+void server_world_random_tick(struct server_world* w, struct server_local* s,
+							  w_coord_t px, w_coord_t pz, w_coord_t dist) {
+	assert(w && s);
 
 	dict_server_chunks_it_t it;
 	dict_server_chunks_it(it, w->chunks);
@@ -487,25 +841,31 @@ void server_world_random_tick(struct server_world* w, struct random_gen* g,
 		int64_t id = dict_server_chunks_ref(it)->key;
 
 		if(abs(S_CHUNK_X(id) - px) <= dist && abs(S_CHUNK_Z(id) - pz) <= dist) {
-			// 80 random ticks each chunk
-			for(int k = 0; k < 80; k++) {
-				c_coord_t cx = rand_gen_range(g, 0, CHUNK_SIZE);
-				c_coord_t cz = rand_gen_range(g, 0, CHUNK_SIZE);
-
-				w_coord_t x = S_CHUNK_X(id) * CHUNK_SIZE + cx;
-				w_coord_t y = rand_gen_range(g, 0, WORLD_HEIGHT);
-				w_coord_t z = S_CHUNK_Z(id) * CHUNK_SIZE + cz;
-
-				struct block_data blk;
-				if(server_chunk_get_block(sc, cx, y, cz, &blk)
-				   && blocks[blk.type] && blocks[blk.type]->onRandomTick) {
-					blocks[blk.type]->onRandomTick(
-						s,
-						&(struct block_info) {.block = &blk,
-											  .neighbours = NULL,
-											  .x = x,
-											  .y = y,
-											  .z = z});
+			struct random_gen* g = &sc->random_tick;
+
+			for(int section = 0; section < COLUMN_HEIGHT; section++) {
+				// sections without any tickable block can't do anything
+				if(!sc->random_tickable[section])
+					continue;
+
+				for(int k = 0; k < RANDOM_TICKS_PER_SECTION; k++) {
+					uint32_t r = rand_gen(g);
+					c_coord_t cx = r & 0x0F;
+					c_coord_t cz = (r >> 4) & 0x0F;
+					w_coord_t y = section * CHUNK_SIZE + ((r >> 8) & 0x0F);
+
+					struct block_data blk;
+					if(server_chunk_get_block(sc, cx, y, cz, &blk)
+					   && random_tickable(blk.type)) {
+						blocks[blk.type]->onRandomTick(
+							s,
+							&(struct block_info) {
+								.block = &blk,
+								.neighbours = NULL,
+								.x = S_CHUNK_X(id) * CHUNK_SIZE + cx,
+								.y = y,
+								.z = S_CHUNK_Z(id) * CHUNK_SIZE + cz});
+					}
 				}
 			}
 		}
@@ -20,11 +20,18 @@
 #ifndef SERVER_WORLD_H
 #define SERVER_WORLD_H
 
+#include <m-lib/m-array.h>
 #include <m-lib/m-dict.h>
 #include <stdbool.h>
 #include <stdint.h>
 
+#include "../lighting.h"
+#include "../platform/thread.h"
+#include "../util.h"
+#include "block_tick.h"
+#include "chunk_nbt.h"
 #include "region_archive.h"
+#include "tile_entity.h"
 
 struct server_chunk {
 	uint8_t* ids;
@@ -33,9 +40,22 @@ struct server_chunk {
 	uint8_t* lighting_torch;
 	uint8_t* heightmap;
 	bool modified;
+	// amount of blocks with onRandomTick in each 16^3 section
+	uint16_t random_tickable[COLUMN_HEIGHT];
+	// seeded from the chunk position, random ticks are reproducible
+	struct random_gen random_tick;
+	// bitset of block ticks scheduled in this chunk, allocated on demand
+	uint8_t* tick_pending;
+	// chests and signs, NULL if the chunk has none
+	struct tile_entity_store* tile_entities;
 };
 
+// all five arrays of a chunk share a single allocation, starting at ids
+#define SERVER_CHUNK_STORAGE                                                   \
+	(CHUNK_SIZE * CHUNK_SIZE * WORLD_HEIGHT / 2 * 5 + CHUNK_SIZE * CHUNK_SIZE)
+
 #define MAX_REGIONS 4
+#define CHUNK_STORAGE_POOL 8
 #define S_CHUNK_ID(x, z) (((int64_t)(z) << 32) | (((int64_t)(x) & 0xFFFFFFFF)))
 #define S_CHUNK_X(id) ((int32_t)((id) & 0xFFFFFFFF))
 #define S_CHUNK_Z(id) ((int32_t)((id) >> 32))
@@ -43,23 +63,55 @@ struct server_chunk {
 // key not!!! stored in multiples of CHUNK_SIZE
 DICT_DEF2(dict_server_chunks, int64_t, M_BASIC_OPLIST, struct server_chunk,
 		  M_POD_OPLIST)
+ARRAY_DEF(array_chunk_ids, int64_t, M_BASIC_OPLIST)
+ARRAY_DEF(array_tile_entities, struct tile_entity*, M_POD_OPLIST)
 
 struct server_world {
 	dict_server_chunks_t chunks;
 	enum world_dim dimension;
+	int64_t seed;
 	string_t level_name;
 	struct region_archive loaded_regions[MAX_REGIONS];
 	ilist_regions_t loaded_regions_lru;
 	size_t loaded_regions_length;
+	// held while region archives are accessed, shared with the save thread
+	struct thread_channel disk_lock;
+	// evicted region left for the save thread to compact, under disk_lock
+	struct region_archive compact_region;
+	bool compact_queued;
+	bool compacting;
+	// held by the save thread while it rewrites compact_region
+	struct thread_channel compact_lock;
+	struct chunk_nbt_stream nbt;
+	// storage of unloaded chunks, reused by the next chunk loaded
+	uint8_t* storage_pool[CHUNK_STORAGE_POOL];
+	size_t storage_pool_length;
+	// chunks modified since they were last saved, may contain stale entries
+	array_chunk_ids_t dirty;
+	// from chests.dat and signs.dat, moved into chunks once they are loaded
+	array_tile_entities_t legacy_tile_entities;
+	struct block_tick_sched ticks;
+	// block changes collected for a single client update
+	struct world_modification_entry* batch;
+	size_t batch_length;
+	size_t batch_capacity;
+	bool batching;
 };
 
 void server_world_create(struct server_world* w, string_t level_name,
 						 enum world_dim dimension);
 void server_world_destroy(struct server_world* w);
+void server_chunk_storage(struct server_chunk* sc, uint8_t* storage);
+void server_world_chunk_destroy(struct server_chunk* sc);
+bool server_world_chunk_alloc(struct server_world* w, struct server_chunk* sc);
+void server_world_chunk_release(struct server_world* w,
+								struct server_chunk* sc);
 
 bool server_world_get_block(struct server_world* w, w_coord_t x, w_coord_t y,
 							w_coord_t z, struct block_data* blk);
 bool server_world_set_block(struct server_local* s, w_coord_t x, w_coord_t y, w_coord_t z, struct block_data blk);
+void server_world_batch_begin(struct server_world* w);
+void server_world_batch_end(struct server_world* w);
 
 bool server_world_furthest_chunk(struct server_world* w, w_coord_t dist,
 								 w_coord_t px, w_coord_t pz, w_coord_t* x,
@@ -69,6 +121,9 @@ bool server_world_is_chunk_loaded(struct server_world* w, w_coord_t x,
 								  w_coord_t z);
 bool server_world_load_chunk(struct server_world* w, w_coord_t x, w_coord_t z,
 							 struct server_chunk** sc);
+struct server_chunk* server_world_add_chunk(struct server_world* w,
+											w_coord_t x, w_coord_t z,
+											struct server_chunk* sc);
 void server_world_save_chunk(struct server_world* w, bool erase, w_coord_t x,
 							 w_coord_t z);
 void server_world_save_chunk_obj(struct server_world* w, bool erase,
@@ -76,12 +131,22 @@ void server_world_save_chunk_obj(struct server_world* w, bool erase,
 								 struct server_chunk* c);
 struct region_archive* server_world_chunk_region(struct server_world* w,
 												 w_coord_t x, w_coord_t z);
+bool server_world_disk_write(struct server_world* w, w_coord_t x, w_coord_t z,
+							 uint8_t* nbt, size_t nbt_length);
+void server_world_disk_compact(struct server_world* w);
 bool server_world_disk_has_chunk(struct server_world* w, w_coord_t x,
 								 w_coord_t z);
-void server_world_tick(struct server_world* w, struct server_local* s);
-void server_world_random_tick(struct server_world* w, struct random_gen* g,
-							  struct server_local* s, w_coord_t px,
-							  w_coord_t pz, w_coord_t dist);
+struct tile_entity* server_world_tile_entity(struct server_world* w,
+											 w_coord_t x, w_coord_t y,
+											 w_coord_t z, bool modify);
+struct tile_entity* server_world_add_tile_entity(struct server_world* w,
+												 enum tile_entity_type type,
+												 w_coord_t x, w_coord_t y,
+												 w_coord_t z);
+bool server_world_remove_tile_entity(struct server_world* w, w_coord_t x,
+									 w_coord_t y, w_coord_t z);
+void server_world_random_tick(struct server_world* w, struct server_local* s,
+							  w_coord_t px, w_coord_t pz, w_coord_t dist);
 void server_world_explode(struct server_local *s, vec3 center, float power);
 
 bool server_world_find_empty_spot_nearby(const float pos[3], const struct server_world *world, float out_pos[3]);
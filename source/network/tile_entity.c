@@ -0,0 +1,137 @@
+/*
+	Copyright (c) 2023 ByteBit/xtreme8000
+
+	This file is part of CavEX.
+
+	CavEX is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	CavEX is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with CavEX.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "tile_entity.h"
+
+uint16_t tile_entity_key(w_coord_t x, w_coord_t y, w_coord_t z) {
+	assert(y >= 0 && y < WORLD_HEIGHT);
+	return y + (W2C_COORD(z) + W2C_COORD(x) * CHUNK_SIZE) * WORLD_HEIGHT;
+}
+
+void tile_entity_init(struct tile_entity* te, enum tile_entity_type type,
+					  w_coord_t x, w_coord_t y, w_coord_t z) {
+	assert(te);
+
+	te->type = type;
+	te->x = x;
+	te->y = y;
+	te->z = z;
+
+	switch(type) {
+		case TILE_ENTITY_CHEST:
+			memset(te->payload.items, 0, sizeof(te->payload.items));
+			break;
+		case TILE_ENTITY_SIGN:
+			memset(te->payload.text, ' ', sizeof(te->payload.text));
+			break;
+	}
+}
+
+struct tile_entity* tile_entity_store_get(struct tile_entity_store* store,
+										  w_coord_t x, w_coord_t y,
+										  w_coord_t z) {
+	if(!store || y < 0 || y >= WORLD_HEIGHT)
+		return NULL;
+
+	struct tile_entity** te
+		= dict_tile_entities_get(store->entries, tile_entity_key(x, y, z));
+	return te ? *te : NULL;
+}
+
+struct tile_entity* tile_entity_store_add(struct tile_entity_store** store,
+										  struct tile_entity* te) {
+	assert(store && te);
+
+	// most chunks have none, the store is only created once needed
+	if(!*store) {
+		*store = malloc(sizeof(struct tile_entity_store));
+
+		if(!*store)
+			return NULL;
+
+		dict_tile_entities_init((*store)->entries);
+	}
+
+	uint16_t key = tile_entity_key(te->x, te->y, te->z);
+	struct tile_entity** existing = dict_tile_entities_get((*store)->entries, key);
+
+	if(existing) {
+		**existing = *te;
+		return *existing;
+	}
+
+	struct tile_entity* res = malloc(sizeof(struct tile_entity));
+
+	if(!res)
+		return NULL;
+
+	*res = *te;
+	dict_tile_entities_set_at((*store)->entries, key, res);
+	return res;
+}
+
+bool tile_entity_store_remove(struct tile_entity_store* store, w_coord_t x,
+							  w_coord_t y, w_coord_t z) {
+	struct tile_entity* te = tile_entity_store_get(store, x, y, z);
+
+	if(!te)
+		return false;
+
+	dict_tile_entities_erase(store->entries, tile_entity_key(x, y, z));
+	free(te);
+	return true;
+}
+
+struct tile_entity_store*
+tile_entity_store_copy(struct tile_entity_store* store) {
+	if(!store)
+		return NULL;
+
+	struct tile_entity_store* res = NULL;
+
+	dict_tile_entities_it_t it;
+	dict_tile_entities_it(it, store->entries);
+
+	while(!dict_tile_entities_end_p(it)) {
+		tile_entity_store_add(&res, dict_tile_entities_ref(it)->value);
+		dict_tile_entities_next(it);
+	}
+
+	return res;
+}
+
+void tile_entity_store_destroy(struct tile_entity_store* store) {
+	if(!store)
+		return;
+
+	dict_tile_entities_it_t it;
+	dict_tile_entities_it(it, store->entries);
+
+	while(!dict_tile_entities_end_p(it)) {
+		free(dict_tile_entities_ref(it)->value);
+		dict_tile_entities_next(it);
+	}
+
+	dict_tile_entities_clear(store->entries);
+	free(store);
+}
@@ -0,0 +1,70 @@
+/*
+	Copyright (c) 2023 ByteBit/xtreme8000
+
+	This file is part of CavEX.
+
+	CavEX is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	CavEX is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with CavEX.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TILE_ENTITY_H
+#define TILE_ENTITY_H
+
+#include <m-lib/m-dict.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "../item/inventory.h"
+#include "../item/items.h"
+#include "../world.h"
+
+#define MAX_CHEST_SLOTS 54
+#define SIGN_LINES 4
+#define SIGN_LINE_LENGTH (SIGN_SIZE / SIGN_LINES)
+
+enum tile_entity_type {
+	TILE_ENTITY_CHEST,
+	TILE_ENTITY_SIGN,
+};
+
+struct tile_entity {
+	enum tile_entity_type type;
+	w_coord_t x, y, z;
+	union {
+		struct item_data items[MAX_CHEST_SLOTS];
+		char text[SIGN_SIZE];
+	} payload;
+};
+
+// key is the block index inside of its chunk
+DICT_DEF2(dict_tile_entities, uint16_t, M_BASIC_OPLIST, struct tile_entity*,
+		  M_POD_OPLIST)
+
+struct tile_entity_store {
+	dict_tile_entities_t entries;
+};
+
+uint16_t tile_entity_key(w_coord_t x, w_coord_t y, w_coord_t z);
+void tile_entity_init(struct tile_entity* te, enum tile_entity_type type,
+					  w_coord_t x, w_coord_t y, w_coord_t z);
+struct tile_entity* tile_entity_store_get(struct tile_entity_store* store,
+										  w_coord_t x, w_coord_t y,
+										  w_coord_t z);
+struct tile_entity* tile_entity_store_add(struct tile_entity_store** store,
+										  struct tile_entity* te);
+bool tile_entity_store_remove(struct tile_entity_store* store, w_coord_t x,
+							  w_coord_t y, w_coord_t z);
+struct tile_entity_store* tile_entity_store_copy(struct tile_entity_store* store);
+void tile_entity_store_destroy(struct tile_entity_store* store);
+
+#endif
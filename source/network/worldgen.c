@@ -0,0 +1,459 @@
+/*
+	Copyright (c) 2023 ByteBit/xtreme8000
+
+	This file is part of CavEX.
+
+	CavEX is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	CavEX is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with CavEX.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../block/blocks.h"
+#include "../platform/thread.h"
+#include "../util.h"
+#include "worldgen.h"
+
+#define SEA_LEVEL 63
+
+// noise is sampled on a coarse lattice and interpolated in between
+#define LATTICE_XZ 4
+#define LATTICE_Y 8
+#define LATTICE_W (CHUNK_SIZE / LATTICE_XZ + 1)
+#define LATTICE_H (WORLD_HEIGHT / LATTICE_Y + 1)
+
+#define GEN_IDX(x, y, z) ((y) + ((z) + (x) * CHUNK_SIZE) * WORLD_HEIGHT)
+
+struct noise {
+	uint8_t perm[512];
+};
+
+struct worldgen_job {
+	int64_t seed;
+	w_coord_t x, z;
+	uint32_t epoch;
+	struct server_chunk chunk;
+};
+
+static struct worldgen_job jobs[WORLDGEN_QLENGTH];
+static struct thread_channel jobs_empty;
+static struct thread_channel jobs_pending;
+static struct thread_channel jobs_done;
+
+// only touched by the server thread
+static struct {
+	w_coord_t x, z;
+	bool active;
+} requested[WORLDGEN_QLENGTH];
+static uint32_t epoch;
+
+static void noise_init(struct noise* n, uint32_t seed) {
+	struct random_gen g = {.seed = hash_u32(seed) | 1};
+
+	for(int k = 0; k < 256; k++)
+		n->perm[k] = k;
+
+	for(int k = 255; k > 0; k--) {
+		int j = rand_gen(&g) % (k + 1);
+		uint8_t tmp = n->perm[k];
+		n->perm[k] = n->perm[j];
+		n->perm[j] = tmp;
+	}
+
+	memcpy(n->perm + 256, n->perm, 256);
+}
+
+static inline float noise_fade(float t) {
+	return t * t * t * (t * (t * 6.0F - 15.0F) + 10.0F);
+}
+
+static inline float noise_grad(int hash, float x, float y, float z) {
+	int h = hash & 15;
+	float u = h < 8 ? x : y;
+	float v = h < 4 ? y : (h == 12 || h == 14 ? x : z);
+	return ((h & 1) ? -u : u) + ((h & 2) ? -v : v);
+}
+
+static float noise3(const struct noise* n, float x, float y, float z) {
+	float fx = floorf(x), fy = floorf(y), fz = floorf(z);
+	int X = (int)fx & 255, Y = (int)fy & 255, Z = (int)fz & 255;
+	x -= fx;
+	y -= fy;
+	z -= fz;
+
+	float u = noise_fade(x), v = noise_fade(y), w = noise_fade(z);
+	const uint8_t* p = n->perm;
+
+	int A = p[X] + Y, AA = p[A] + Z, AB = p[A + 1] + Z;
+	int B = p[X + 1] + Y, BA = p[B] + Z, BB = p[B + 1] + Z;
+
+	return glm_lerp(
+		glm_lerp(glm_lerp(noise_grad(p[AA], x, y, z),
+						  noise_grad(p[BA], x - 1, y, z), u),
+				 glm_lerp(noise_grad(p[AB], x, y - 1, z),
+						  noise_grad(p[BB], x - 1, y - 1, z), u),
+				 v),
+		glm_lerp(glm_lerp(noise_grad(p[AA + 1], x, y, z - 1),
+						  noise_grad(p[BA + 1], x - 1, y, z - 1), u),
+				 glm_lerp(noise_grad(p[AB + 1], x, y - 1, z - 1),
+						  noise_grad(p[BB + 1], x - 1, y - 1, z - 1), u),
+				 v),
+		w);
+}
+
+static float noise_fbm(const struct noise* n, float x, float y, float z,
+					   int octaves) {
+	float res = 0.0F;
+	float amplitude = 1.0F;
+
+	for(int k = 0; k < octaves; k++) {
+		res += noise3(n, x, y, z) * amplitude;
+		x *= 2.0F;
+		y *= 2.0F;
+		z *= 2.0F;
+		amplitude *= 0.5F;
+	}
+
+	return res;
+}
+
+static inline void gen_set(struct server_chunk* sc, int x, int y, int z,
+						   uint8_t type, uint8_t metadata) {
+	size_t idx = GEN_IDX(x, y, z);
+	sc->ids[idx] = type;
+	nibble_write(sc->metadata, idx, metadata);
+}
+
+static inline uint8_t gen_get(struct server_chunk* sc, int x, int y, int z) {
+	return sc->ids[GEN_IDX(x, y, z)];
+}
+
+static void gen_ore(struct server_chunk* sc, struct random_gen* g,
+					uint8_t type, int veins, int max_y, int size) {
+	for(int k = 0; k < veins; k++) {
+		int x = rand_gen_range(g, 0, CHUNK_SIZE);
+		int y = rand_gen_range(g, 1, max_y);
+		int z = rand_gen_range(g, 0, CHUNK_SIZE);
+
+		for(int i = 0; i < size; i++) {
+			if(x >= 0 && x < CHUNK_SIZE && z >= 0 && z < CHUNK_SIZE && y > 0
+			   && y < WORLD_HEIGHT && gen_get(sc, x, y, z) == BLOCK_STONE)
+				gen_set(sc, x, y, z, type, 0);
+
+			switch(rand_gen(g) % 6) {
+				case 0: x++; break;
+				case 1: x--; break;
+				case 2: y++; break;
+				case 3: y--; break;
+				case 4: z++; break;
+				default: z--; break;
+			}
+		}
+	}
+}
+
+static void gen_tree(struct server_chunk* sc, struct random_gen* g, int x,
+					 int y, int z) {
+	int height = rand_gen_range(g, 4, 7);
+
+	if(y + height + 2 >= WORLD_HEIGHT)
+		return;
+
+	for(int ly = y + height - 2; ly <= y + height + 1; ly++) {
+		int radius = (ly > y + height - 1) ? 1 : 2;
+
+		for(int lx = x - radius; lx <= x + radius; lx++) {
+			for(int lz = z - radius; lz <= z + radius; lz++) {
+				bool corner = abs(lx - x) == radius && abs(lz - z) == radius;
+
+				if((!corner || (rand_gen(g) & 1))
+				   && gen_get(sc, lx, ly, lz) == BLOCK_AIR)
+					gen_set(sc, lx, ly, lz, BLOCK_LEAVES, 0);
+			}
+		}
+	}
+
+	for(int ly = y; ly < y + height; ly++)
+		gen_set(sc, x, ly, z, BLOCK_LOG, 0);
+
+	gen_set(sc, x, y - 1, z, BLOCK_DIRT, 0);
+}
+
+static bool gen_blocks_light(uint8_t type) {
+	return blocks[type]
+		&& (!blocks[type]->can_see_through || blocks[type]->opacity > 0);
+}
+
+void worldgen_generate(int64_t seed, w_coord_t x, w_coord_t z,
+					   struct server_chunk* sc) {
+	assert(sc);
+
+	*sc = (struct server_chunk) {
+		.modified = true,
+		.tick_pending = NULL,
+		.tile_entities = NULL,
+	};
+
+	uint8_t* storage = calloc(SERVER_CHUNK_STORAGE, 1);
+	assert(storage);
+	server_chunk_storage(sc, storage);
+
+	uint32_t seed32 = (uint32_t)seed ^ (uint32_t)(seed >> 32);
+
+	struct noise terrain, detail, cave_a, cave_b;
+	noise_init(&terrain, seed32);
+	noise_init(&detail, seed32 + 1);
+	noise_init(&cave_a, seed32 + 2);
+	noise_init(&cave_b, seed32 + 3);
+
+	struct random_gen g
+		= {.seed = hash_u32(seed32 ^ hash_u32(x) ^ hash_u32(z * 31 + 7)) | 1};
+
+	w_coord_t bx = x * CHUNK_SIZE;
+	w_coord_t bz = z * CHUNK_SIZE;
+
+	// whole lattice first, in flat arrays, then only interpolation per block
+	float height_lattice[LATTICE_W * LATTICE_W];
+	float cave_lattice[LATTICE_W * LATTICE_W * LATTICE_H];
+
+	for(int k = 0; k < LATTICE_W * LATTICE_W; k++) {
+		float sx = (bx + (k / LATTICE_W) * LATTICE_XZ) / 256.0F;
+		float sz2 = (bz + (k % LATTICE_W) * LATTICE_XZ) / 256.0F;
+		height_lattice[k] = noise_fbm(&terrain, sx, 0.5F, sz2, 4) * 28.0F
+			+ noise_fbm(&detail, sx * 4.0F, 0.5F, sz2 * 4.0F, 2) * 4.0F;
+	}
+
+	for(int k = 0; k < LATTICE_W * LATTICE_W * LATTICE_H; k++) {
+		float sx = (bx + (k / (LATTICE_W * LATTICE_H)) * LATTICE_XZ) / 48.0F;
+		float sy = ((k % LATTICE_H) * LATTICE_Y) / 24.0F;
+		float sz2 = (bz + (k / LATTICE_H % LATTICE_W) * LATTICE_XZ) / 48.0F;
+		float a = noise3(&cave_a, sx, sy, sz2);
+		float b = noise3(&cave_b, sx, sy, sz2);
+		cave_lattice[k] = a * a + b * b;
+	}
+
+	uint8_t heights[CHUNK_SIZE * CHUNK_SIZE];
+
+	for(int cx = 0; cx < CHUNK_SIZE; cx++) {
+		for(int cz = 0; cz < CHUNK_SIZE; cz++) {
+			int lx = cx / LATTICE_XZ, lz = cz / LATTICE_XZ;
+			float tx = (float)(cx % LATTICE_XZ) / LATTICE_XZ;
+			float tz = (float)(cz % LATTICE_XZ) / LATTICE_XZ;
+
+			float h = glm_lerp(
+				glm_lerp(height_lattice[lx * LATTICE_W + lz],
+						 height_lattice[(lx + 1) * LATTICE_W + lz], tx),
+				glm_lerp(height_lattice[lx * LATTICE_W + lz + 1],
+						 height_lattice[(lx + 1) * LATTICE_W + lz + 1], tx),
+				tz);
+
+			int height = glm_clamp(SEA_LEVEL + 1 + h, 8, WORLD_HEIGHT - 16);
+			bool beach = height <= SEA_LEVEL + 1;
+			heights[cx * CHUNK_SIZE + cz] = height;
+
+			for(int y = 0; y < WORLD_HEIGHT; y++) {
+				uint8_t type = BLOCK_AIR;
+
+				if(y == 0 || (y < 5 && rand_gen_range(&g, 0, 5) >= y)) {
+					type = BLOCK_BEDROCK;
+				} else if(y < height - 3) {
+					type = BLOCK_STONE;
+				} else if(y < height) {
+					type = beach ? BLOCK_SAND : BLOCK_DIRT;
+				} else if(y == height) {
+					type = beach ?
+						(height < SEA_LEVEL - 2 ? BLOCK_GRAVEL : BLOCK_SAND) :
+						BLOCK_GRASS;
+				} else if(y <= SEA_LEVEL) {
+					type = BLOCK_WATER_STILL;
+				}
+
+				sc->ids[GEN_IDX(cx, y, cz)] = type;
+			}
+
+			// caves, except right below the sea floor
+			for(int y = 5; y < (beach ? height - 4 : height + 1); y++) {
+				int ly = y / LATTICE_Y;
+				float ty = (float)(y % LATTICE_Y) / LATTICE_Y;
+				const float* c = cave_lattice;
+				size_t i00 = (lx * LATTICE_W + lz) * LATTICE_H + ly;
+				size_t i10 = ((lx + 1) * LATTICE_W + lz) * LATTICE_H + ly;
+				size_t i01 = (lx * LATTICE_W + lz + 1) * LATTICE_H + ly;
+				size_t i11 = ((lx + 1) * LATTICE_W + lz + 1) * LATTICE_H + ly;
+
+				float d = glm_lerp(
+					glm_lerp(glm_lerp(c[i00], c[i10], tx),
+							 glm_lerp(c[i01], c[i11], tx), tz),
+					glm_lerp(glm_lerp(c[i00 + 1], c[i10 + 1], tx),
+							 glm_lerp(c[i01 + 1], c[i11 + 1], tx), tz),
+					ty);
+
+				if(d < 0.004F)
+					sc->ids[GEN_IDX(cx, y, cz)] = BLOCK_AIR;
+			}
+		}
+	}
+
+	gen_ore(sc, &g, BLOCK_COAL_ORE, 20, 128, 12);
+	gen_ore(sc, &g, BLOCK_IRON_ORE, 20, 64, 8);
+	gen_ore(sc, &g, BLOCK_GOLD_ORE, 2, 32, 8);
+	gen_ore(sc, &g, BLOCK_LAPIS_ORE, 1, 32, 6);
+	gen_ore(sc, &g, BLOCK_DIAMOND_ORE, 1, 16, 7);
+
+	float forest = noise3(&detail, bx / 128.0F, 8.5F, bz / 128.0F);
+	int trees = glm_clamp(forest * 12.0F, 0, 5);
+
+	// trees and plants stay inside the chunk, no neighbour has to exist
+	for(int k = 0; k < trees; k++) {
+		int cx = rand_gen_range(&g, 2, CHUNK_SIZE - 2);
+		int cz = rand_gen_range(&g, 2, CHUNK_SIZE - 2);
+		int height = heights[cx * CHUNK_SIZE + cz];
+
+		if(gen_get(sc, cx, height, cz) == BLOCK_GRASS)
+			gen_tree(sc, &g, cx, height + 1, cz);
+	}
+
+	for(int cx = 0; cx < CHUNK_SIZE; cx++) {
+		for(int cz = 0; cz < CHUNK_SIZE; cz++) {
+			int height = heights[cx * CHUNK_SIZE + cz];
+
+			if(gen_get(sc, cx, height, cz) != BLOCK_GRASS
+			   || gen_get(sc, cx, height + 1, cz) != BLOCK_AIR)
+				continue;
+
+			int r = rand_gen_range(&g, 0, 200);
+
+			if(r < 10)
+				gen_set(sc, cx, height + 1, cz, BLOCK_TALL_GRASS, 1);
+			else if(r == 10)
+				gen_set(sc, cx, height + 1, cz, BLOCK_FLOWER, 0);
+			else if(r == 11)
+				gen_set(sc, cx, height + 1, cz, BLOCK_ROSE, 0);
+		}
+	}
+
+	// heightmap and sky light straight down, spreading is left to the client
+	for(int cx = 0; cx < CHUNK_SIZE; cx++) {
+		for(int cz = 0; cz < CHUNK_SIZE; cz++) {
+			int light = 15;
+			uint8_t* hm = sc->heightmap + cx + cz * CHUNK_SIZE;
+			*hm = 0;
+
+			for(int y = WORLD_HEIGHT - 1; y >= 0; y--) {
+				uint8_t type = gen_get(sc, cx, y, cz);
+
+				if(!*hm && gen_blocks_light(type))
+					*hm = y + 1;
+
+				if(blocks[type] && !blocks[type]->can_see_through)
+					light = 0;
+				else if(blocks[type])
+					light = glm_max(light - blocks[type]->opacity, 0);
+
+				nibble_write(sc->lighting_sky, GEN_IDX(cx, y, cz), light);
+			}
+		}
+	}
+}
+
+static void* worldgen_thread(void* user) {
+	while(1) {
+		struct worldgen_job* job;
+		tchannel_receive(&jobs_pending, (void**)&job, true);
+		worldgen_generate(job->seed, job->x, job->z, &job->chunk);
+		tchannel_send(&jobs_done, job, true);
+	}
+
+	return NULL;
+}
+
+void worldgen_init() {
+	tchannel_init(&jobs_empty, WORLDGEN_QLENGTH);
+	tchannel_init(&jobs_pending, WORLDGEN_QLENGTH);
+	tchannel_init(&jobs_done, WORLDGEN_QLENGTH);
+
+	for(int k = 0; k < WORLDGEN_QLENGTH; k++) {
+		requested[k].active = false;
+		tchannel_send(&jobs_empty, jobs + k, true);
+	}
+
+	epoch = 0;
+
+	for(int k = 0; k < WORLDGEN_THREADS; k++) {
+		struct thread t;
+		thread_create(&t, worldgen_thread, NULL, 2);
+	}
+}
+
+void worldgen_reset() {
+	epoch++;
+
+	for(int k = 0; k < WORLDGEN_QLENGTH; k++)
+		requested[k].active = false;
+}
+
+bool worldgen_requested(w_coord_t x, w_coord_t z) {
+	for(int k = 0; k < WORLDGEN_QLENGTH; k++) {
+		if(requested[k].active && requested[k].x == x && requested[k].z == z)
+			return true;
+	}
+
+	return false;
+}
+
+bool worldgen_request(int64_t seed, w_coord_t x, w_coord_t z) {
+	struct worldgen_job* job;
+
+	if(worldgen_requested(x, z)
+	   || !tchannel_receive(&jobs_empty, (void**)&job, false))
+		return false;
+
+	job->seed = seed;
+	job->x = x;
+	job->z = z;
+	job->epoch = epoch;
+
+	size_t slot = job - jobs;
+	requested[slot].x = x;
+	requested[slot].z = z;
+	requested[slot].active = true;
+
+	tchannel_send(&jobs_pending, job, true);
+	return true;
+}
+
+bool worldgen_receive(w_coord_t* x, w_coord_t* z, struct server_chunk* sc) {
+	assert(x && z && sc);
+
+	struct worldgen_job* job;
+
+	while(tchannel_receive(&jobs_done, (void**)&job, false)) {
+		if(job->epoch == epoch) {
+			requested[job - jobs].active = false;
+			*x = job->x;
+			*z = job->z;
+			*sc = job->chunk;
+			tchannel_send(&jobs_empty, job, true);
+			return true;
+		}
+
+		// results still in flight belong to the previous world
+		server_world_chunk_destroy(&job->chunk);
+		tchannel_send(&jobs_empty, job, true);
+	}
+
+	return false;
+}
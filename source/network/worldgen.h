@@ -0,0 +1,40 @@
+/*
+	Copyright (c) 2023 ByteBit/xtreme8000
+
+	This file is part of CavEX.
+
+	CavEX is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	CavEX is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with CavEX.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef WORLDGEN_H
+#define WORLDGEN_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "../world.h"
+#include "server_world.h"
+
+#define WORLDGEN_THREADS 2
+#define WORLDGEN_QLENGTH 8
+
+void worldgen_init(void);
+void worldgen_reset(void);
+bool worldgen_requested(w_coord_t x, w_coord_t z);
+bool worldgen_request(int64_t seed, w_coord_t x, w_coord_t z);
+bool worldgen_receive(w_coord_t* x, w_coord_t* z, struct server_chunk* sc);
+void worldgen_generate(int64_t seed, w_coord_t x, w_coord_t z,
+					   struct server_chunk* sc);
+
+#endif
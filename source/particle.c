@@ -38,6 +38,11 @@ static vec3 s_cameraPos;
 static const float SPAWN_CULL_RADIUS = 64.0f;
 static const float SPAWN_CULL_RADIUS2 = SPAWN_CULL_RADIUS * SPAWN_CULL_RADIUS;
 
+// ambient emitters, spawn calls per tick
+#define EMITTER_BUDGET 48
+#define EMITTER_RADIUS 32.0f
+#define EMITTER_RADIUS2 (EMITTER_RADIUS * EMITTER_RADIUS)
+
 static const uint8_t redstone_colors[16][3] = {
     {111,   0,  0},  // 0
     {120,   3,  0},  // 1
@@ -661,6 +666,111 @@ void particle_generate_torch(vec3 pos) {
     }
 }
 
+void particle_generate_portal(vec3 center) {
+    uint8_t frame     = (uint8_t)(rnd() * 8.0f);
+    uint8_t tex_smoke = tex_atlas_lookup_particle(TEXAT_PARTICLE_SMOKE_0 + frame);
+
+    vec3 pos = {
+        center[0] + (rnd() - 0.5f) * 0.8f,
+        center[1] + (rnd() - 0.5f) * 0.8f,
+        center[2] + (rnd() - 0.5f) * 0.8f
+    };
+
+    vec3 vel = {
+        (rnd() - 0.5f) * 0.02f,
+        (rnd() - 0.5f) * 0.02f,
+        (rnd() - 0.5f) * 0.02f
+    };
+
+    float brightness = 0.6f + rnd() * 0.4f;
+
+    particle_add(
+        pos, vel,
+        tex_smoke,
+        0.08f + rnd() * 0.04f,    // size
+        20.0f + rnd() * 20.0f,    // lifetime in ticks
+        false,                    // no gravity
+        (uint8_t)(200 * brightness),
+        (uint8_t)(80 * brightness),
+        (uint8_t)(255 * brightness),
+        true,
+        TEXTURE_ATLAS_PARTICLES
+    );
+}
+
+static bool emitter_in_range(struct chunk* c, struct chunk_emitter* e) {
+    vec3 pos = {c->x + e->x + 0.5f, c->y + e->y + 0.5f, c->z + e->z + 0.5f};
+    return glm_vec3_distance2(pos, s_cameraPos) <= EMITTER_RADIUS2;
+}
+
+static bool emitter_chunk_in_range(struct chunk* c) {
+    vec3 center = {
+        c->x + CHUNK_SIZE / 2,
+        c->y + CHUNK_SIZE / 2,
+        c->z + CHUNK_SIZE / 2
+    };
+
+    // radius of the chunk bounding sphere
+    float r = EMITTER_RADIUS + CHUNK_SIZE * 0.87f;
+    return glm_vec3_distance2(center, s_cameraPos) <= r * r;
+}
+
+void particle_update_emitters(struct world* w) {
+    assert(w);
+
+    // chunks that were visible in the last frame
+    size_t candidates = 0;
+    ilist_chunks_it_t it;
+
+    for(ilist_chunks_it(it, w->render); !ilist_chunks_end_p(it);
+        ilist_chunks_next(it)) {
+        struct chunk* c = ilist_chunks_ref(it);
+
+        if(!c->emitters_count || !emitter_chunk_in_range(c))
+            continue;
+
+        for(size_t k = 0; k < c->emitters_count; k++) {
+            if(emitter_in_range(c, c->emitters + k))
+                candidates++;
+        }
+    }
+
+    if(!candidates)
+        return;
+
+    // thin out evenly if there are more emitters than the budget allows
+    float chance = candidates > EMITTER_BUDGET ?
+        (float)EMITTER_BUDGET / (float)candidates : 1.0f;
+
+    for(ilist_chunks_it(it, w->render); !ilist_chunks_end_p(it);
+        ilist_chunks_next(it)) {
+        struct chunk* c = ilist_chunks_ref(it);
+
+        if(!c->emitters_count || !emitter_chunk_in_range(c))
+            continue;
+
+        for(size_t k = 0; k < c->emitters_count; k++) {
+            struct chunk_emitter* e = c->emitters + k;
+
+            if(!emitter_in_range(c, e) || (chance < 1.0f && rnd() >= chance))
+                continue;
+
+            struct block* b = blocks[e->block.type];
+
+            if(b && b->onDisplayTick) {
+                struct block_data blk = e->block;
+                b->onDisplayTick(&(struct block_info) {
+                    .block = &blk,
+                    .neighbours = NULL,
+                    .x = c->x + e->x,
+                    .y = c->y + e->y,
+                    .z = c->z + e->z,
+                });
+            }
+        }
+    }
+}
+
 void particle_render(mat4 view, vec3 camera, float delta) {
     gfx_matrix_modelview(view);
     gfx_lighting(false);
@@ -71,4 +71,6 @@ void particle_generate_smoke(vec3 center, float intensity);
 void particle_generate_torch(vec3 pos);
 void particle_generate_redstone_torch(vec3 center);
 void particle_generate_redstone_wire(vec3 center, uint8_t power);
+void particle_generate_portal(vec3 center);
+void particle_update_emitters(struct world* w);
 #endif
@@ -39,6 +39,10 @@ void displaylist_init(struct displaylist* l, size_t vertices,
 void displaylist_destroy(struct displaylist* l);
 void displaylist_reset(struct displaylist* l);
 void displaylist_finalize(struct displaylist* l, uint16_t vtxcnt);
+void displaylist_finalize_from(struct displaylist* l,
+							   struct displaylist* scratch, uint16_t vtxcnt);
+size_t displaylist_upload(struct displaylist* l);
+size_t displaylist_size(struct displaylist* l);
 void displaylist_render(struct displaylist* l);
 void displaylist_render_immediate(struct displaylist* l, uint16_t vtxcnt);
 
@@ -49,9 +49,12 @@ void gfx_setup(void);
 void gfx_update_light(float daytime, const float* light_lookup);
 float gfx_lookup_light(uint8_t light);
 void gfx_finish(bool vsync);
+void gfx_flush(void);
 void gfx_flip_buffers(float* gpu_wait, float* vsync_wait);
 void gfx_bind_texture(struct tex_gfx* tex);
 void gfx_clear_buffers(uint8_t r, uint8_t g, uint8_t b);
+// drops everything drawn since the last gfx_finish
+void gfx_discard_framebuffer(void);
 int gfx_width(void);
 int gfx_height(void);
 
@@ -73,6 +76,9 @@ void gfx_depth_range(float near, float far);
 void gfx_depth_func(enum depth_func func);
 void gfx_texture(bool enable);
 void gfx_lighting(bool enable);
+// replaces vertex and light lookup colors, e.g. to fade a static displaylist
+void gfx_constant_color(bool enable, uint8_t r, uint8_t g, uint8_t b,
+						uint8_t a);
 void gfx_cull_func(enum cull_func func);
 void gfx_scissor(bool enable, uint32_t x, uint32_t y, uint32_t width,
 				 uint32_t height);
@@ -83,4 +89,13 @@ void gfx_draw_quads(size_t vertex_count, const int16_t* vertices,
 void gfx_draw_quads_flt(size_t vertex_count, const float* vertices,
 						const uint8_t* colors, const float* texcoords);
 
+// hardware occlusion queries, results become available a frame or so later
+bool gfx_occlusion_available(void);
+uint32_t gfx_occlusion_create(void);
+void gfx_occlusion_destroy(uint32_t query);
+// counts the samples of a box drawn with the current state and modelview
+void gfx_occlusion_box(uint32_t query, vec3 min, vec3 max);
+// false while the result is still pending, never blocks
+bool gfx_occlusion_result(uint32_t query, bool* visible);
+
 #endif
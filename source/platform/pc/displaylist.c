@@ -23,6 +23,7 @@
 #include <string.h>
 
 #include "../displaylist.h"
+#include "../gfx.h"
 
 #define MEM_U8(b, i) (*((uint8_t*)(b) + (i)))
 #define MEM_U16(b, i) (*(uint16_t*)((uint8_t*)(b) + (i)))
@@ -60,6 +61,19 @@ void displaylist_finalize(struct displaylist* l, uint16_t vtxcnt) {
 	l->index = vtxcnt;
 }
 
+// exact-size copy of scratch, which stays usable for the next mesh
+void displaylist_finalize_from(struct displaylist* l,
+							   struct displaylist* scratch, uint16_t vtxcnt) {
+	assert(l && scratch && !scratch->finished && scratch->data);
+
+	l->length = scratch->index;
+	l->data = malloc(l->length);
+	assert(l->data);
+	memcpy(l->data, scratch->data, l->length);
+	l->index = vtxcnt;
+	l->finished = false;
+}
+
 void displaylist_pos(struct displaylist* l, int16_t x, int16_t y, int16_t z) {
 	assert(l && !l->finished);
 
@@ -97,17 +111,39 @@ void displaylist_texcoord(struct displaylist* l, uint8_t s, uint8_t t) {
 	l->index += 4;
 }
 
-void displaylist_render(struct displaylist* l) {
+// returns the number of bytes sent to the gpu
+size_t displaylist_upload(struct displaylist* l) {
 	assert(l);
 
-	if(!l->finished) {
-		l->finished = true;
+	if(l->finished)
+		return 0;
 
-		glGenBuffers(1, &l->vbo);
-		glBindBuffer(GL_ARRAY_BUFFER, l->vbo);
-		glBufferData(GL_ARRAY_BUFFER, l->index * 22, l->data, GL_STATIC_DRAW);
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
-	}
+	l->finished = true;
+
+	glGenBuffers(1, &l->vbo);
+	glBindBuffer(GL_ARRAY_BUFFER, l->vbo);
+	glBufferData(GL_ARRAY_BUFFER, l->index * 22, l->data, GL_STATIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	// the vbo is the only copy needed from now on
+	free(l->data);
+	l->data = NULL;
+
+	return l->index * 22;
+}
+
+// bytes held in vram once uploaded, or in ram before
+size_t displaylist_size(struct displaylist* l) {
+	assert(l);
+	return l->finished ? l->index * 22 : (l->data ? l->length : 0);
+}
+
+void displaylist_render(struct displaylist* l) {
+	assert(l);
+	gfx_flush();
+
+	if(!l->finished)
+		displaylist_upload(l);
 
 	glEnableVertexAttribArray(0);
 	glEnableVertexAttribArray(3);
@@ -130,6 +166,8 @@ void displaylist_render(struct displaylist* l) {
 
 void displaylist_render_immediate(struct displaylist* l, uint16_t vtxcnt) {
 	assert(l && l->data && !l->finished);
+	gfx_flush();
+
 	glEnableVertexAttribArray(0);
 	glEnableVertexAttribArray(3);
 	glEnableVertexAttribArray(2);
@@ -107,6 +107,40 @@ static void scroll_callback(GLFWwindow* window, double xoffset,
 
 static GLuint shader_prog;
 
+/* quads drawn with gfx_draw_quads are collected here and only submitted once
+ * any render state changes, so that e.g. consecutive GUI text and sprites end
+ * up in a single draw call */
+#define QUAD_BATCH_SIZE 8192
+
+static struct {
+	int16_t vertices[QUAD_BATCH_SIZE * 3];
+	uint8_t colors[QUAD_BATCH_SIZE * 4];
+	float texcoords[QUAD_BATCH_SIZE * 2];
+	size_t count;
+} quad_batch;
+
+void gfx_flush() {
+	if(quad_batch.count == 0)
+		return;
+
+	glEnableVertexAttribArray(0);
+	glEnableVertexAttribArray(1);
+	glEnableVertexAttribArray(2);
+
+	glVertexAttribPointer(0, 3, GL_SHORT, GL_FALSE, 0, quad_batch.vertices);
+	glVertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, GL_TRUE, 0,
+						  quad_batch.colors);
+	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 0, quad_batch.texcoords);
+
+	glDrawArrays(GL_QUADS, 0, quad_batch.count);
+
+	glDisableVertexAttribArray(0);
+	glDisableVertexAttribArray(1);
+	glDisableVertexAttribArray(2);
+
+	quad_batch.count = 0;
+}
+
 void gfx_setup() {
 	glfwInit();
 
@@ -180,6 +214,7 @@ static float colors[256];
 void gfx_update_light(float daytime, const float* light_lookup) {
 	assert(daytime > -GLM_FLT_EPSILON && daytime < 1.0F + GLM_FLT_EPSILON
 		   && light_lookup);
+	gfx_flush();
 
 	for(int sky = 0; sky < 16; sky++) {
 		for(int torch = 0; torch < 16; torch++) {
@@ -199,7 +234,14 @@ void gfx_clear_buffers(uint8_t r, uint8_t g, uint8_t b) {
 	glClearColor(r / 255.0F, g / 255.0F, b / 255.0F, 1.0F);
 }
 
+void gfx_discard_framebuffer() {
+	gfx_write_buffers(true, true, true);
+	glClear(GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT);
+}
+
 void gfx_finish(bool vsync) {
+	gfx_flush();
+
 	glfwSwapBuffers(window);
 	gfx_write_buffers(true, true, true);
 	glClear(GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT);
@@ -212,11 +254,14 @@ void gfx_flip_buffers(float* gpu_wait, float* vsync_wait) {
 }
 
 void gfx_bind_texture(struct tex_gfx* tex) {
+	gfx_flush();
+
 	tex_gfx_bind(tex, 0);
 }
 
 void gfx_copy_framebuffer(uint8_t* dest, size_t* width, size_t* height) {
 	assert(width && height);
+	gfx_flush();
 
 	*width = gfx_width();
 	*height = gfx_height();
@@ -263,17 +308,23 @@ void gfx_mode_gui() {
 
 void gfx_matrix_projection(mat4 proj, bool is_perspective) {
 	assert(proj);
+	gfx_flush();
+
 	glUniformMatrix4fv(glGetUniformLocation(shader_prog, "proj"), 1, GL_FALSE,
 					   (float*)proj);
 }
 
 void gfx_matrix_modelview(mat4 mv) {
 	assert(mv);
+	gfx_flush();
+
 	glUniformMatrix4fv(glGetUniformLocation(shader_prog, "mv"), 1, GL_FALSE,
 					   (float*)mv);
 }
 
 void gfx_matrix_texture(bool enable, mat4 tex) {
+	gfx_flush();
+
 	if(enable) {
 		assert(tex);
 		glUniformMatrix4fv(glGetUniformLocation(shader_prog, "texm"), 1,
@@ -285,22 +336,29 @@ void gfx_matrix_texture(bool enable, mat4 tex) {
 }
 
 void gfx_fog_color(uint8_t r, uint8_t g, uint8_t b) {
+	gfx_flush();
+
 	glUniform3f(glGetUniformLocation(shader_prog, "fog_color"), r / 255.0F,
 				g / 255.0F, b / 255.0F);
 }
 
 void gfx_fog_pos(float dx, float dz, float distance) {
 	assert(distance > 0);
+	gfx_flush();
 
 	glUniform2f(glGetUniformLocation(shader_prog, "fog_delta"), dx, dz);
 	glUniform1f(glGetUniformLocation(shader_prog, "fog_distance"), distance);
 }
 
 void gfx_fog(bool enable) {
+	gfx_flush();
+
 	glUniform1i(glGetUniformLocation(shader_prog, "enable_fog"), enable);
 }
 
 void gfx_blending(enum gfx_blend mode) {
+	gfx_flush();
+
 	switch(mode) {
 		case MODE_BLEND:
 			glDisable(GL_COLOR_LOGIC_OP);
@@ -330,10 +388,14 @@ void gfx_blending(enum gfx_blend mode) {
 }
 
 void gfx_alpha_test(bool enable) {
+	gfx_flush();
+
 	glUniform1i(glGetUniformLocation(shader_prog, "enable_alpha"), enable);
 }
 
 void gfx_write_buffers(bool color, bool depth, bool depth_test) {
+	gfx_flush();
+
 	glColorMask(color, color, color, color);
 	glDepthMask(depth);
 
@@ -345,10 +407,14 @@ void gfx_write_buffers(bool color, bool depth, bool depth_test) {
 }
 
 void gfx_depth_range(float near, float far) {
+	gfx_flush();
+
 	glDepthRange(near, far);
 }
 
 void gfx_depth_func(enum depth_func func) {
+	gfx_flush();
+
 	switch(func) {
 		case MODE_LEQUAL: glDepthFunc(GL_LEQUAL); break;
 		case MODE_EQUAL: glDepthFunc(GL_EQUAL); break;
@@ -356,14 +422,32 @@ void gfx_depth_func(enum depth_func func) {
 }
 
 void gfx_texture(bool enable) {
+	gfx_flush();
+
 	glUniform1i(glGetUniformLocation(shader_prog, "enable_texture"), enable);
 }
 
 void gfx_lighting(bool enable) {
+	gfx_flush();
+
 	glUniform1i(glGetUniformLocation(shader_prog, "enable_lighting"), enable);
 }
 
+void gfx_constant_color(bool enable, uint8_t r, uint8_t g, uint8_t b,
+						uint8_t a) {
+	gfx_flush();
+
+	glUniform1i(glGetUniformLocation(shader_prog, "enable_constant_color"),
+				enable);
+
+	if(enable)
+		glUniform4f(glGetUniformLocation(shader_prog, "constant_color"),
+					r / 255.0F, g / 255.0F, b / 255.0F, a / 255.0F);
+}
+
 void gfx_cull_func(enum cull_func func) {
+	gfx_flush();
+
 	if(func != MODE_NONE) {
 		glEnable(GL_CULL_FACE);
 	} else {
@@ -379,6 +463,8 @@ void gfx_cull_func(enum cull_func func) {
 
 void gfx_scissor(bool enable, uint32_t x, uint32_t y, uint32_t width,
 				 uint32_t height) {
+	gfx_flush();
+
 	if(enable) {
 		glEnable(GL_SCISSOR_TEST);
 		glScissor(x, y, width, height);
@@ -390,6 +476,8 @@ void gfx_scissor(bool enable, uint32_t x, uint32_t y, uint32_t width,
 void gfx_draw_lines(size_t vertex_count, const int16_t* vertices,
 					const uint8_t* colors) {
 	assert(vertices && colors);
+	gfx_flush();
+
 	glLineWidth(2.0F);
 
 	assert(vertex_count < 256);
@@ -412,32 +500,36 @@ void gfx_draw_lines(size_t vertex_count, const int16_t* vertices,
 
 void gfx_draw_quads(size_t vertex_count, const int16_t* vertices,
 					const uint8_t* colors, const uint16_t* texcoords) {
-	assert(vertices && colors && texcoords);
+	assert(vertices && colors && texcoords && vertex_count % 4 == 0);
 
-	assert(vertex_count < 256);
+	while(vertex_count > 0) {
+		if(quad_batch.count == QUAD_BATCH_SIZE)
+			gfx_flush();
 
-	float tmp[vertex_count * 3];
-	for(size_t k = 0; k < vertex_count * 3; k++)
-		tmp[k] = texcoords[k] / 256.0F;
-
-	glEnableVertexAttribArray(0);
-	glEnableVertexAttribArray(1);
-	glEnableVertexAttribArray(2);
+		size_t n = vertex_count;
+		if(n > QUAD_BATCH_SIZE - quad_batch.count)
+			n = QUAD_BATCH_SIZE - quad_batch.count;
 
-	glVertexAttribPointer(0, 3, GL_SHORT, GL_FALSE, 0, vertices);
-	glVertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, GL_TRUE, 0, colors);
-	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 0, tmp);
+		memcpy(quad_batch.vertices + quad_batch.count * 3, vertices,
+			   n * 3 * sizeof(int16_t));
+		memcpy(quad_batch.colors + quad_batch.count * 4, colors, n * 4);
 
-	glDrawArrays(GL_QUADS, 0, vertex_count);
+		for(size_t k = 0; k < n * 2; k++)
+			quad_batch.texcoords[quad_batch.count * 2 + k]
+				= texcoords[k] / 256.0F;
 
-	glDisableVertexAttribArray(0);
-	glDisableVertexAttribArray(1);
-	glDisableVertexAttribArray(2);
+		quad_batch.count += n;
+		vertex_count -= n;
+		vertices += n * 3;
+		colors += n * 4;
+		texcoords += n * 2;
+	}
 }
 
 void gfx_draw_quads_flt(size_t vertex_count, const float* vertices,
 						const uint8_t* colors, const float* texcoords) {
 	assert(vertices && colors && texcoords);
+	gfx_flush();
 
 	glEnableVertexAttribArray(0);
 	glEnableVertexAttribArray(1);
@@ -453,3 +545,56 @@ void gfx_draw_quads_flt(size_t vertex_count, const float* vertices,
 	glDisableVertexAttribArray(1);
 	glDisableVertexAttribArray(2);
 }
+
+bool gfx_occlusion_available() {
+	return GLEW_VERSION_1_5;
+}
+
+uint32_t gfx_occlusion_create() {
+	GLuint query;
+	glGenQueries(1, &query);
+	return query;
+}
+
+void gfx_occlusion_destroy(uint32_t query) {
+	GLuint id = query;
+	glDeleteQueries(1, &id);
+}
+
+void gfx_occlusion_box(uint32_t query, vec3 min, vec3 max) {
+	assert(min && max);
+	gfx_flush();
+
+	float vertices[] = {
+		min[0], min[1], min[2], max[0], min[1], min[2], max[0], min[1], max[2],
+		min[0], min[1], max[2], min[0], max[1], min[2], max[0], max[1], min[2],
+		max[0], max[1], max[2], min[0], max[1], max[2], min[0], min[1], min[2],
+		min[0], max[1], min[2], min[0], max[1], max[2], min[0], min[1], max[2],
+		max[0], min[1], min[2], max[0], max[1], min[2], max[0], max[1], max[2],
+		max[0], min[1], max[2], min[0], min[1], min[2], max[0], min[1], min[2],
+		max[0], max[1], min[2], min[0], max[1], min[2], min[0], min[1], max[2],
+		max[0], min[1], max[2], max[0], max[1], max[2], min[0], max[1], max[2],
+	};
+
+	glBeginQuery(GL_SAMPLES_PASSED, query);
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, vertices);
+	glDrawArrays(GL_QUADS, 0, 24);
+	glDisableVertexAttribArray(0);
+	glEndQuery(GL_SAMPLES_PASSED);
+}
+
+bool gfx_occlusion_result(uint32_t query, bool* visible) {
+	assert(visible);
+
+	GLuint available;
+	glGetQueryObjectuiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+
+	if(!available)
+		return false;
+
+	GLuint samples;
+	glGetQueryObjectuiv(query, GL_QUERY_RESULT, &samples);
+	*visible = samples > 0;
+	return true;
+}
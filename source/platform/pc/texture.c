@@ -18,8 +18,10 @@
 */
 
 #include <GL/glew.h>
+#include <stdlib.h>
 #include <string.h>
 
+#include "../gfx.h"
 #include "../texture.h"
 
 void tex_init_pre() { }
@@ -33,6 +35,7 @@ void tex_gfx_load(struct tex_gfx* tex, void* img, size_t width, size_t height,
 	tex->width = width;
 	tex->height = height;
 
+	gfx_flush();
 	glGenTextures(1, &tex->id);
 
 	glBindTexture(GL_TEXTURE_2D, tex->id);
@@ -47,8 +50,22 @@ void tex_gfx_load(struct tex_gfx* tex, void* img, size_t width, size_t height,
 	glBindTexture(GL_TEXTURE_2D, 0);
 }
 
+void tex_gfx_update(struct tex_gfx* tex, void* img) {
+	assert(tex && img);
+
+	free(tex->data);
+	tex->data = img;
+
+	gfx_flush();
+	glBindTexture(GL_TEXTURE_2D, tex->id);
+	glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, tex->width, tex->height, GL_RGBA,
+					GL_UNSIGNED_BYTE, img);
+	glBindTexture(GL_TEXTURE_2D, 0);
+}
+
 void tex_gfx_wrap_mode(struct tex_gfx* tex, bool repeat) {
 	assert(tex);
+	gfx_flush();
 
 	glBindTexture(GL_TEXTURE_2D, tex->id);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S,
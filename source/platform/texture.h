@@ -97,6 +97,7 @@ uint8_t* tex_read(const char* filename, size_t* width, size_t* height);
 
 void tex_gfx_load(struct tex_gfx* tex, void* img, size_t width, size_t height,
 				  enum tex_format type, bool linear);
+void tex_gfx_update(struct tex_gfx* tex, void* img);
 void tex_gfx_load_file(struct tex_gfx* tex, const char* filename,
 					   enum tex_format type, bool linear);
 void tex_gfx_bind(struct tex_gfx* tex, int slot);
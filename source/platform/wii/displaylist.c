@@ -70,6 +70,22 @@ void displaylist_finalize(struct displaylist* l, uint16_t vtxcnt) {
 	l->finished = true;
 }
 
+// exact-size copy of scratch, which stays usable for the next mesh
+void displaylist_finalize_from(struct displaylist* l,
+							   struct displaylist* scratch, uint16_t vtxcnt) {
+	assert(l && scratch && !scratch->finished && scratch->data);
+
+	l->length = (scratch->index + DISPLAYLIST_CLL - 1) / DISPLAYLIST_CLL
+		* DISPLAYLIST_CLL;
+	l->data = malloc(l->length + DISPLAYLIST_CLL);
+	assert(l->data);
+	memcpy(l->data, scratch->data, scratch->index);
+	l->index = scratch->index;
+	l->finished = false;
+
+	displaylist_finalize(l, vtxcnt);
+}
+
 void displaylist_pos(struct displaylist* l, int16_t x, int16_t y, int16_t z) {
 	assert(l && !l->finished);
 
@@ -104,6 +120,17 @@ void displaylist_texcoord(struct displaylist* l, uint8_t s, uint8_t t) {
 	MEM_U8(l->data, l->index++) = t;
 }
 
+// gx reads finished lists straight from main memory, nothing to upload
+size_t displaylist_upload(struct displaylist* l) {
+	assert(l);
+	return 0;
+}
+
+size_t displaylist_size(struct displaylist* l) {
+	assert(l);
+	return l->data ? l->length + DISPLAYLIST_CLL : 0;
+}
+
 void displaylist_render(struct displaylist* l) {
 	assert(l);
 
@@ -224,6 +224,16 @@ void gfx_clear_buffers(uint8_t r, uint8_t g, uint8_t b) {
 	GX_SetCopyClear((GXColor) {r, g, b, 255}, GX_MAX_Z24);
 }
 
+void gfx_discard_framebuffer() {
+	assert(frame);
+
+	// frame is overwritten by gfx_finish anyway
+	GX_SetZMode(GX_TRUE, GX_LEQUAL, GX_TRUE);
+	GX_SetColorUpdate(GX_TRUE);
+	GX_CopyDisp(frame, GX_TRUE);
+	GX_PixModeSync();
+}
+
 void gfx_finish(bool vsync) {
 	assert(frame);
 
@@ -239,6 +249,8 @@ void gfx_finish(bool vsync) {
 	}
 }
 
+void gfx_flush() { }
+
 void gfx_flip_buffers(float* gpu_wait, float* vsync_wait) {
 	assert(frame);
 
@@ -460,6 +472,17 @@ void gfx_lighting(bool enable) {
 	GX_SetVtxDesc(GX_VA_CLR0, enable ? GX_INDEX8 : GX_DIRECT);
 }
 
+void gfx_constant_color(bool enable, uint8_t r, uint8_t g, uint8_t b,
+						uint8_t a) {
+	// vertex colors are still read, but the channel takes the material register
+	if(enable)
+		GX_SetChanMatColor(GX_COLOR0A0, (GXColor) {r, g, b, a});
+
+	GX_SetChanCtrl(GX_COLOR0A0, GX_DISABLE, GX_SRC_REG,
+				   enable ? GX_SRC_REG : GX_SRC_VTX, GX_LIGHTNULL, GX_DF_NONE,
+				   GX_AF_NONE);
+}
+
 void gfx_cull_func(enum cull_func func) {
 	switch(func) {
 		case MODE_NONE: GX_SetCullMode(GX_CULL_NONE); break;
@@ -527,3 +550,22 @@ void gfx_draw_quads_flt(size_t vertex_count, const float* vertices,
 
 	GX_End();
 }
+
+// GX only has a global pixel counter that would stall, so everything is visible
+bool gfx_occlusion_available() {
+	return false;
+}
+
+uint32_t gfx_occlusion_create() {
+	return 0;
+}
+
+void gfx_occlusion_destroy(uint32_t query) { }
+
+void gfx_occlusion_box(uint32_t query, vec3 min, vec3 max) { }
+
+bool gfx_occlusion_result(uint32_t query, bool* visible) {
+	assert(visible);
+	*visible = true;
+	return true;
+}
@@ -211,36 +211,34 @@ static void* tex_conv_ia4(uint8_t* image, size_t width, size_t height) {
 	return output;
 }
 
-void tex_gfx_load(struct tex_gfx* tex, void* img, size_t width, size_t height,
-				  enum tex_format type, bool linear) {
-	assert(tex && img && width > 0 && height > 0);
-
-	void* output = NULL;
-	uint8_t fmt;
-
+static void* tex_conv(uint8_t* image, size_t width, size_t height,
+					  enum tex_format type, uint8_t* fmt) {
 	switch(type) {
 		case TEX_FMT_RGBA32:
-			output = tex_conv_rgba32(img, width, height);
-			fmt = GX_TF_RGBA8;
-			break;
+			*fmt = GX_TF_RGBA8;
+			return tex_conv_rgba32(image, width, height);
 		case TEX_FMT_RGBA16:
-			output = tex_conv_rgba16(img, width, height);
-			fmt = GX_TF_RGB5A3;
-			break;
+			*fmt = GX_TF_RGB5A3;
+			return tex_conv_rgba16(image, width, height);
 		case TEX_FMT_RGB16:
-			output = tex_conv_rgb16(img, width, height);
-			fmt = GX_TF_RGB565;
-			break;
+			*fmt = GX_TF_RGB565;
+			return tex_conv_rgb16(image, width, height);
 		case TEX_FMT_I8:
-			output = tex_conv_i8(img, width, height);
-			fmt = GX_TF_I8;
-			break;
+			*fmt = GX_TF_I8;
+			return tex_conv_i8(image, width, height);
 		case TEX_FMT_IA4:
-			output = tex_conv_ia4(img, width, height);
-			fmt = GX_TF_IA4;
-			break;
-		default: return;
+			*fmt = GX_TF_IA4;
+			return tex_conv_ia4(image, width, height);
+		default: return NULL;
 	}
+}
+
+void tex_gfx_load(struct tex_gfx* tex, void* img, size_t width, size_t height,
+				  enum tex_format type, bool linear) {
+	assert(tex && img && width > 0 && height > 0);
+
+	uint8_t fmt;
+	void* output = tex_conv(img, width, height, type, &fmt);
 
 	if(output) {
 		tex->fmt = type;
@@ -259,6 +257,23 @@ void tex_gfx_load(struct tex_gfx* tex, void* img, size_t width, size_t height,
 	free(img);
 }
 
+void tex_gfx_update(struct tex_gfx* tex, void* img) {
+	assert(tex && img && tex->data);
+
+	uint8_t fmt;
+	void* output = tex_conv(img, tex->width, tex->height, tex->fmt, &fmt);
+
+	if(output) {
+		free(tex->data);
+		tex->data = output;
+
+		GX_InitTexObjData(&tex->obj, output);
+		GX_InvalidateTexAll();
+	}
+
+	free(img);
+}
+
 void tex_gfx_wrap_mode(struct tex_gfx* tex, bool repeat) {
 	assert(tex);
 	GX_InitTexObjWrapMode(&tex->obj, repeat ? GX_REPEAT : GX_CLAMP,
@@ -0,0 +1,136 @@
+/*
+	Copyright (c) 2023 ByteBit/xtreme8000
+
+	This file is part of CavEX.
+
+	CavEX is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	CavEX is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with CavEX.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "lodepng/lodepng.h"
+#include "platform/gfx.h"
+#include "platform/thread.h"
+#include "screenshot.h"
+
+#define SCREENSHOT_QLENGTH 4
+
+struct screenshot_job {
+	uint8_t* image;
+	size_t width, height;
+	char name[64];
+};
+
+static struct screenshot_job jobs[SCREENSHOT_QLENGTH];
+static struct thread_channel jobs_empty;
+static struct thread_channel jobs_pending;
+
+static size_t burst_remaining;
+static size_t burst_length;
+static long burst_time;
+
+static void* screenshot_thread(void* user) {
+	while(1) {
+		struct screenshot_job* job;
+		tchannel_receive(&jobs_pending, (void**)&job, true);
+
+		lodepng_encode32_file(job->name, job->image, job->width, job->height);
+		free(job->image);
+		job->image = NULL;
+
+		tchannel_send(&jobs_empty, job, true);
+	}
+
+	return NULL;
+}
+
+void screenshot_init() {
+	tchannel_init(&jobs_empty, SCREENSHOT_QLENGTH);
+	tchannel_init(&jobs_pending, SCREENSHOT_QLENGTH);
+
+	for(int k = 0; k < SCREENSHOT_QLENGTH; k++)
+		tchannel_send(&jobs_empty, jobs + k, true);
+
+	burst_remaining = 0;
+	burst_length = 0;
+
+	struct thread t;
+	thread_create(&t, screenshot_thread, NULL, 2);
+}
+
+void screenshot_request(int frames) {
+	if(burst_remaining > 0)
+		return;
+
+	if(frames < 1)
+		frames = 1;
+
+	burst_remaining = frames;
+	burst_length = frames;
+	burst_time = time(NULL);
+}
+
+void screenshot_capture() {
+	if(!burst_remaining)
+		return;
+
+	size_t index = burst_length - burst_remaining;
+	burst_remaining--;
+
+	/* The frame is never stalled for the encoder. Once it falls behind the
+	 * burst ends, the remaining frames would not be consecutive anyway. */
+	struct screenshot_job* job;
+	if(!tchannel_receive(&jobs_empty, (void**)&job, false)) {
+		burst_remaining = 0;
+		return;
+	}
+
+	gfx_copy_framebuffer(NULL, &job->width, &job->height);
+	job->image = malloc(job->width * job->height * 4);
+
+	// out of memory, end the burst as well
+	if(!job->image) {
+		burst_remaining = 0;
+		tchannel_send(&jobs_empty, job, true);
+		return;
+	}
+
+	gfx_copy_framebuffer(job->image, &job->width, &job->height);
+
+	if(burst_length > 1) {
+		snprintf(job->name, sizeof(job->name), "%ld_%03zu.png", burst_time,
+				 index);
+	} else {
+		snprintf(job->name, sizeof(job->name), "%ld.png", burst_time);
+	}
+
+	tchannel_send(&jobs_pending, job, true);
+}
+
+void screenshot_flush() {
+	struct screenshot_job* job;
+
+	// every job is back once all pending images are written
+	for(int k = 0; k < SCREENSHOT_QLENGTH; k++)
+		tchannel_receive(&jobs_empty, (void**)&job, true);
+
+	for(int k = 0; k < SCREENSHOT_QLENGTH; k++)
+		tchannel_send(&jobs_empty, jobs + k, true);
+
+	burst_remaining = 0;
+}
@@ -18,7 +18,9 @@
 */
 
 #include <assert.h>
+#include <stdlib.h>
 
+#include "far_terrain.h"
 #include "game/game_state.h"
 #include "lighting.h"
 #include "platform/gfx.h"
@@ -41,6 +43,9 @@ void world_unload_section(struct world* w, w_coord_t x, w_coord_t z) {
 		= dict_wsection_get(w->sections, SECTION_TO_ID(x, z));
 
 	if(s) {
+		far_terrain_record(w, x, z);
+		far_terrain_section(x, z, false);
+
 		for(size_t k = 0; k < COLUMN_HEIGHT; k++) {
 			struct chunk* c = s->column[k];
 			if(c) {
@@ -72,6 +77,7 @@ void world_unload_all(struct world* w) {
 
 	stack_clear(&w->lighting_updates);
 	dict_wsection_reset(w->sections);
+	far_terrain_reset();
 	w->world_chunk_cache = NULL;
 }
 
@@ -158,6 +164,11 @@ void world_create(struct world* w) {
 				 sizeof(struct world_modification_entry));
 	w->world_chunk_cache = NULL;
 	w->anim_timer = time_get();
+	w->mesh_bytes = 0;
+	w->eviction = NULL;
+	w->eviction_capacity = 0;
+	w->frame = 0;
+	w->chunks_occluded = 0;
 }
 
 void world_destroy(struct world* w) {
@@ -166,6 +177,7 @@ void world_destroy(struct world* w) {
 	world_unload_all(w);
 	stack_destroy(&w->lighting_updates);
 	dict_wsection_clear(w->sections);
+	free(w->eviction);
 }
 
 size_t world_loaded_chunks(struct world* w) {
@@ -255,6 +267,7 @@ void world_set_block(struct world* w, w_coord_t x, w_coord_t y, w_coord_t z,
 				assert(s);
 				memset(s->heightmap, 0, sizeof(s->heightmap));
 				memset(s->column, 0, sizeof(s->column));
+				far_terrain_section(cx, cz, true);
 			}
 
 			assert(s->column[cy] == NULL);
@@ -482,7 +495,9 @@ size_t world_build_chunks(struct world* w, size_t tokens) {
 	while(tokens > 0 && !dict_wsection_end_p(it2)) {
 		struct world_section* s = &dict_wsection_ref(it2)->value;
 		for(size_t k = 0; k < COLUMN_HEIGHT; k++) {
-			if(s->column[k] && chunk_check_built(s->column[k]))
+			// evicted meshes only come back through the render list
+			if(s->column[k] && !s->column[k]->mesh_evicted
+			   && chunk_check_built(s->column[k]))
 				tokens--;
 		}
 
@@ -492,6 +507,115 @@ size_t world_build_chunks(struct world* w, size_t tokens) {
 	return tokens;
 }
 
+struct mesh_eviction {
+	struct chunk* chunk;
+	float distance;
+};
+
+// max-heap on distance, the farthest chunk is at the root
+static void mesh_eviction_sift(struct mesh_eviction* heap, size_t length,
+							   size_t k) {
+	while(1) {
+		size_t largest = k;
+		size_t l = k * 2 + 1, r = k * 2 + 2;
+
+		if(l < length && heap[l].distance > heap[largest].distance)
+			largest = l;
+
+		if(r < length && heap[r].distance > heap[largest].distance)
+			largest = r;
+
+		if(largest == k)
+			return;
+
+		struct mesh_eviction tmp = heap[k];
+		heap[k] = heap[largest];
+		heap[largest] = tmp;
+		k = largest;
+	}
+}
+
+/* Drops the meshes of the farthest chunks until mesh_bytes is below budget.
+ * Must be called after world_render_completed(), chunks about to be drawn
+ * (the render list) are never evicted. */
+void world_evict_meshes(struct world* w, struct camera* c, size_t budget) {
+	assert(w && c);
+
+	if(w->mesh_bytes <= budget)
+		return;
+
+	dict_wsection_it_t it2;
+	dict_wsection_it(it2, w->sections);
+
+	while(!dict_wsection_end_p(it2)) {
+		struct world_section* s = &dict_wsection_ref(it2)->value;
+		for(size_t k = 0; k < COLUMN_HEIGHT; k++) {
+			if(s->column[k])
+				s->column[k]->tmp_data.visited = false;
+		}
+
+		dict_wsection_next(it2);
+	}
+
+	ilist_chunks_it_t it;
+	ilist_chunks_it(it, w->render);
+
+	while(!ilist_chunks_end_p(it)) {
+		ilist_chunks_ref(it)->tmp_data.visited = true;
+		ilist_chunks_next(it);
+	}
+
+	size_t capacity = dict_wsection_size(w->sections) * COLUMN_HEIGHT;
+
+	if(w->eviction_capacity < capacity) {
+		struct mesh_eviction* tmp
+			= realloc(w->eviction, capacity * sizeof(struct mesh_eviction));
+
+		if(!tmp)
+			return;
+
+		w->eviction = tmp;
+		w->eviction_capacity = capacity;
+	}
+
+	size_t length = 0;
+	struct mesh_eviction* candidates = w->eviction;
+
+	dict_wsection_it(it2, w->sections);
+
+	while(!dict_wsection_end_p(it2)) {
+		struct world_section* s = &dict_wsection_ref(it2)->value;
+		for(size_t k = 0; k < COLUMN_HEIGHT; k++) {
+			struct chunk* ch = s->column[k];
+
+			if(ch && ch->mesh_bytes > 0 && !ch->tmp_data.visited)
+				candidates[length++] = (struct mesh_eviction) {
+					.chunk = ch,
+					.distance = glm_vec3_distance2(
+						(vec3) {ch->x + CHUNK_SIZE / 2, ch->y + CHUNK_SIZE / 2,
+								ch->z + CHUNK_SIZE / 2},
+						(vec3) {c->x, c->y, c->z}),
+				};
+		}
+
+		dict_wsection_next(it2);
+	}
+
+	// some headroom, so that not every new mesh triggers another pass
+	size_t target = budget / 8 * 7;
+
+	/* Only as many chunks as needed are taken off the heap, usually a few
+	 * out of all candidates. */
+	for(size_t k = length / 2; k > 0; k--)
+		mesh_eviction_sift(candidates, length, k - 1);
+
+	while(length > 0 && w->mesh_bytes > target) {
+		chunk_evict_mesh(candidates[0].chunk);
+		candidates[0] = candidates[--length];
+		mesh_eviction_sift(candidates, length, 0);
+	}
+}
+
 void world_render_completed(struct world* w, bool new_render) {
 	assert(w);
 
@@ -518,6 +642,66 @@ void world_render_completed(struct world* w, bool new_render) {
 	}
 }
 
+static bool world_occlusion_inside(struct chunk* c, struct camera* cam) {
+	// box would be clipped by the near plane, one block of margin
+	return cam->x > c->x - 1 && cam->x < c->x + CHUNK_SIZE + 1
+		&& cam->y > c->y - 1 && cam->y < c->y + CHUNK_SIZE + 1
+		&& cam->z > c->z - 1 && cam->z < c->z + CHUNK_SIZE + 1;
+}
+
+// picks up last frame's query, never waits for the gpu
+static void world_occlusion_poll(struct world* w, struct chunk* c,
+								 struct camera* cam) {
+	// results from before the chunk left the view are stale
+	bool continuous = c->occlusion.frame + 1 == w->frame;
+	c->occlusion.frame = w->frame;
+
+	if(!continuous)
+		c->occlusion.occluded = false;
+
+	bool visible;
+	if(c->occlusion.pending
+	   && gfx_occlusion_result(c->occlusion.query, &visible)) {
+		c->occlusion.pending = false;
+
+		if(continuous)
+			c->occlusion.occluded = !visible;
+	}
+
+	if(world_occlusion_inside(c, cam))
+		c->occlusion.occluded = false;
+}
+
+// tests bounding boxes against the depth of everything drawn so far
+static void world_occlusion_query(struct world* w, struct camera* cam) {
+	gfx_write_buffers(false, false, true);
+	gfx_alpha_test(false);
+	gfx_cull_func(MODE_NONE);
+
+	ilist_chunks_it_t it;
+	ilist_chunks_it(it, w->render);
+
+	while(!ilist_chunks_end_p(it)) {
+		struct chunk* c = ilist_chunks_ref(it);
+
+		if(!c->occlusion.pending && !world_occlusion_inside(c, cam)) {
+			if(!c->occlusion.query)
+				c->occlusion.query = gfx_occlusion_create();
+
+			gfx_matrix_modelview(c->model_view);
+			gfx_occlusion_box(c->occlusion.query, (vec3) {0, 0, 0},
+							  (vec3) {CHUNK_SIZE, CHUNK_SIZE, CHUNK_SIZE});
+			c->occlusion.pending = true;
+		}
+
+		ilist_chunks_next(it);
+	}
+
+	gfx_cull_func(MODE_BACK);
+	gfx_alpha_test(true);
+	gfx_write_buffers(true, true, true);
+}
+
 size_t world_render(struct world* w, struct camera* c, bool pass) {
 	assert(w && c);
 
@@ -532,13 +716,37 @@ size_t world_render(struct world* w, struct camera* c, bool pass) {
 		gfx_blending(MODE_OFF);
 		gfx_alpha_test(true);
 
+		bool occlusion
+			= gstate.config.occlusion_culling && gfx_occlusion_available();
+		w->frame++;
+		w->chunks_occluded = 0;
+
 		ilist_chunks_it(it, w->render);
 
 		while(!ilist_chunks_end_p(it)) {
-			chunk_render(ilist_chunks_ref(it), false, c->x, c->y, c->z);
-			in_view++;
+			struct chunk* chunk = ilist_chunks_ref(it);
+
+			if(occlusion) {
+				world_occlusion_poll(w, chunk, c);
+			} else {
+				chunk->occlusion.occluded = false;
+			}
+
+			if(!chunk->occlusion.occluded) {
+				chunk_render(chunk, false, c->x, c->y, c->z);
+				in_view++;
+			} else {
+				w->chunks_occluded++;
+			}
+
 			ilist_chunks_next(it);
 		}
+
+		if(occlusion)
+			world_occlusion_query(w, c);
+
+		// still before the translucent pass, water is blended over it
+		far_terrain_render(c);
 	} else {
 		gfx_alpha_test(false);
 		gfx_blending(MODE_BLEND);
@@ -559,7 +767,8 @@ size_t world_render(struct world* w, struct camera* c, bool pass) {
 
 			ilist_chunks_it(it, w->render);
 			while(!ilist_chunks_end_p(it)) {
-				chunk_render(ilist_chunks_ref(it), true, c->x, c->y, c->z);
+				if(!ilist_chunks_ref(it)->occlusion.occluded)
+					chunk_render(ilist_chunks_ref(it), true, c->x, c->y, c->z);
 				ilist_chunks_next(it);
 			}
 		}
@@ -43,6 +43,13 @@ enum world_dim {
 
 #define COLUMN_HEIGHT ((WORLD_HEIGHT + CHUNK_SIZE - 1) / CHUNK_SIZE)
 
+// default for "mesher.mesh_budget_kb", all chunk meshes together
+#ifdef PLATFORM_WII
+#define WORLD_MESH_BUDGET_KB (24 * 1024)
+#else
+#define WORLD_MESH_BUDGET_KB (256 * 1024)
+#endif
+
 struct world_section {
 	uint8_t heightmap[CHUNK_SIZE * CHUNK_SIZE];
 	struct chunk* column[COLUMN_HEIGHT];
@@ -62,6 +69,13 @@ struct world {
 	ptime_t anim_timer;
 	struct stack lighting_updates;
 	enum world_dim dimension;
+	size_t mesh_bytes;
+	// candidates of world_evict_meshes(), kept between calls
+	struct mesh_eviction* eviction;
+	size_t eviction_capacity;
+	// counts calls of world_render() for the opaque pass
+	uint32_t frame;
+	size_t chunks_occluded;
 };
 
 void world_create(struct world* w);
@@ -71,6 +85,7 @@ void world_unload_all(struct world* w);
 w_coord_t world_get_height(struct world* w, w_coord_t x, w_coord_t z);
 void world_copy_heightmap(struct world* w, struct chunk* c, uint8_t* heightmap);
 size_t world_build_chunks(struct world* w, size_t tokens);
+void world_evict_meshes(struct world* w, struct camera* c, size_t budget);
 void world_render_completed(struct world* w, bool new_render);
 struct chunk* world_find_chunk_neighbour(struct world* w, struct chunk* c,
 										 enum side s);